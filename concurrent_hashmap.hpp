@@ -0,0 +1,1182 @@
+#ifndef CONCURRENT_HASHMAP_HPP
+#define CONCURRENT_HASHMAP_HPP
+
+#include "hashmap.hpp"
+#include "utils/spinlock.hpp"
+#include "utils/qsbr.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief ConcurrentHashMap 的同步模式
+ */
+namespace concurrent_mode {
+    struct striped {};      // 默认：读写都取得桶所在条带的锁
+    struct read_mostly {};  // 读者不加锁，写者复制并发布新桶，旧桶经 QSBR 回收
+}
+
+namespace _concurrent {
+
+/**
+ * @brief ConcurrentHashMap 各模式共用的部分：类型、哈希、条带锁和元素计数
+ */
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+class map_base {
+public:
+    using base_map                = HashMap<Key, Value, Hash, KeyEqual, Allocator>;
+
+    // 类型定义
+    using key_type                = Key;                            // 键
+    using mapped_type             = Value;                          // 值类型
+    using value_type              = std::pair<const Key, Value>;    // STL标准键值对
+    using size_type               = unsigned long long;             // 大小
+    using allocator_type          = Allocator;                      // 分配器
+    using hasher                  = Hash;                           // 哈希器
+    using key_equal               = KeyEqual;                       // 键相等比较器
+
+    template <typename K>
+    using key_arg                 = typename base_map::template key_arg<K>;
+
+protected:
+    template <typename U>
+    using rebind_alloc            = typename base_map::template rebind_alloc<U>;
+    using stored_pair             = typename base_map::stored_pair;
+    template <typename K>
+    using key_probe               = typename base_map::template key_probe<K>;
+    using pair_less               = typename base_map::pair_less;
+    using pair_equal              = typename base_map::pair_equal;
+
+    struct alignas(64) stripe {
+      utils::spinlock             lock;               // 保护 keyhash 落在本条带内的所有桶
+      std::atomic<size_type>      count{0};           // 本条带内的元素数量，只在持有锁时修改
+    };
+
+                                                      // 条带锁的数量，2的幂
+    static constexpr size_type    STRIPE_COUNT = 64;
+                                                      // 负载因子阈值，固定为 hashmap_storage::growth_policy 的默认值
+    static constexpr double       LOAD_FACTOR_THRESHOLD = 0.75;
+                                                      // 箱子数量达到此值后，扩展改为迁入一个更大的箱子；也是 boxes 数组的长度
+    static constexpr size_type    MAX_BOX_COUNT = 4;
+
+    Allocator                     allocator;          // 内存分配器
+    mutable stripe                stripes[STRIPE_COUNT];
+    hasher                        hash_function_;     // 哈希器
+    key_equal                     key_eq_;            // 键相等比较器
+
+    map_base(const hasher& hash, const key_equal& equal, const Allocator& alloc)
+        : allocator(alloc), hash_function_(hash), key_eq_(equal) {}
+
+    /**
+     * @brief 计算键的32位哈希值，与 HashMap 相同
+     */
+    template <typename K>
+    uint32_t hash_key(const K& key) const {
+        auto hash = this->hash_function_(key);
+        if constexpr (utils::is_avalanching<hasher>::value && sizeof(hash) <= sizeof(uint32_t)) {
+            return static_cast<uint32_t>(hash);
+        } else {
+            return utils::XXHash32::hash_raw(&hash, sizeof(hash));
+        }
+    }
+
+    static size_type bucket_of(uint32_t hash, size_type capacity) {
+        return utils::XXHash32::map_linear(hash, 0, static_cast<uint32_t>(capacity - 1));
+    }
+
+    /**
+     * @brief 哈希值所在的条带，等于 keyhash 的高位
+     */
+    stripe& stripe_of(uint32_t hash) const {
+        return this->stripes[bucket_of(hash, STRIPE_COUNT)];
+    }
+
+    /**
+     * @brief 能以负载因子容纳 estimated_size 个元素的桶数，2的幂且不小于 STRIPE_COUNT
+     */
+    static size_type capacity_for(size_type estimated_size) {
+        size_type required = static_cast<size_type>(estimated_size / LOAD_FACTOR_THRESHOLD) + 1;
+        size_type capacity = STRIPE_COUNT;
+        while (capacity < required) capacity <<= 1;
+        return capacity;
+    }
+
+    /**
+     * @brief 按顺序取得/释放全部条带锁
+     */
+    void lock_all() const {
+        for (size_type i = 0; i < STRIPE_COUNT; ++i) this->stripes[i].lock.lock();
+    }
+
+    void unlock_all() const {
+        for (size_type i = STRIPE_COUNT; i-- > 0; ) this->stripes[i].lock.unlock();
+    }
+
+    struct all_stripes_guard {
+      const map_base& map;
+      explicit all_stripes_guard(const map_base& map) : map(map) { map.lock_all(); }
+      ~all_stripes_guard() { map.unlock_all(); }
+    };
+
+    size_type unlocked_size() const {
+        size_type total = 0;
+        for (size_type i = 0; i < STRIPE_COUNT; ++i) total += this->stripes[i].count.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    void reset_counts() {
+        for (size_type i = 0; i < STRIPE_COUNT; ++i) this->stripes[i].count.store(0, std::memory_order_relaxed);
+    }
+
+public:
+    /**
+     * @brief 元素数量。有其他线程同时修改时只是某一时刻附近的近似值
+     */
+    size_type size() const {
+        return unlocked_size();
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    hasher hash_function() const { return hash_function_; }
+    key_equal key_eq() const { return key_eq_; }
+    allocator_type get_allocator() const { return allocator; }
+};
+
+} // namespace _concurrent
+
+/**
+ * @brief 线程安全的 HashMap，按桶条带加锁
+ *
+ * 与 HashMap 使用相同的箱/桶结构：若干个桶数相同的箱子，键在每个箱子中都落在 box[keyhash]，
+ * 桶为内联元素 / 小有序数组 / 红黑树，桶内元素保存完整的32位哈希值。
+ *
+ * 同步方式：
+ * - 条带锁：STRIPE_COUNT 个自旋锁，各占一条缓存行。桶数总是 STRIPE_COUNT 的2的幂倍，
+ *   线性映射下 keyhash 的高位就是条带号，所有箱子中的 box[keyhash] 都由同一把条带锁保护；
+ *   桶数加倍时一个桶下标的元素只会落到同一条带内，因此条带号只由哈希值决定，不随扩容变化。
+ * - 追加箱子：持有条带锁的插入发现最后一个箱子达到负载因子阈值时，在 box_mutex 下追加同样大小的箱子，
+ *   已有箱子和其他条带不受影响。
+ * - 扩容：箱子数量达到 MAX_BOX_COUNT 后，由触发的线程按顺序取得全部条带锁，
+ *   把所有元素（使用存储的哈希值）迁入一个桶数更大的箱子。
+ *
+ * 增长策略固定为 hashmap_storage::growth_policy 的默认值（负载因子 0.75、最多 4 个箱子、合并时桶数加倍），
+ * 不提供 set_growth_policy / max_load_factor(double)：箱子数组的长度在编译期确定，
+ * 运行时修改策略还需要与正在追加箱子或扩容的线程同步。
+ *
+ * 所有操作都在锁内完成，不返回迭代器或元素引用；读取值通过复制，修改值通过 compute。
+ * 读远多于写时可以使用 concurrent_mode::read_mostly，查找不加锁。
+ *
+ * @tparam Key 键类型
+ * @tparam Value 值类型
+ * @tparam Hash 哈希函数对象类型
+ * @tparam KeyEqual 键相等比较函数对象类型，相等的键须有相同的哈希值
+ * @tparam Allocator 内存分配器类型
+ * @tparam Mode 同步模式，concurrent_mode::striped 或 concurrent_mode::read_mostly
+ */
+template <typename Key, typename Value,
+          typename Hash = utils::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>,
+          typename Allocator = std::allocator<std::pair<const Key, Value>>,
+          typename Mode = concurrent_mode::striped>
+class ConcurrentHashMap : public _concurrent::map_base<Key, Value, Hash, KeyEqual, Allocator> {
+private:
+    using base_type               = _concurrent::map_base<Key, Value, Hash, KeyEqual, Allocator>;
+
+public:
+    using typename base_type::key_type;
+    using typename base_type::mapped_type;
+    using typename base_type::size_type;
+    using typename base_type::hasher;
+    using typename base_type::key_equal;
+    template <typename K>
+    using key_arg                 = typename base_type::template key_arg<K>;
+
+private:
+    template <typename U>
+    using rebind_alloc            = typename base_type::template rebind_alloc<U>;
+    using typename base_type::stored_pair;
+    template <typename K>
+    using key_probe               = typename base_type::template key_probe<K>;
+    using typename base_type::pair_less;
+    using typename base_type::pair_equal;
+    using typename base_type::stripe;
+    using typename base_type::all_stripes_guard;
+    using bucket_type             = typename base_type::base_map::bucket_type;
+    using box_type                = typename base_type::base_map::box_type;
+
+    using base_type::STRIPE_COUNT;
+    using base_type::LOAD_FACTOR_THRESHOLD;
+    using base_type::MAX_BOX_COUNT;
+    using base_type::allocator;
+    using base_type::key_eq_;
+    using base_type::hash_key;
+    using base_type::bucket_of;
+    using base_type::stripe_of;
+    using base_type::capacity_for;
+    using base_type::unlocked_size;
+
+    struct box_manager {
+      box_type                    box;                // 箱
+      std::atomic<size_type>      used_bucket_count;  // 非空桶的数量，各条带并发更新
+
+      box_manager(size_type capacity, const key_equal& key_eq, const Allocator& alloc)
+        : box(rebind_alloc<bucket_type>(alloc)), used_bucket_count(0) {
+        this->box.reserve(capacity);
+        for (size_type i = 0; i < capacity; ++i)
+          this->box.emplace_back(pair_less(), pair_equal{key_eq}, rebind_alloc<stored_pair>(alloc));
+      }
+    };
+
+    using box_allocator           = rebind_alloc<box_manager>;
+    using box_traits              = std::allocator_traits<box_allocator>;
+
+private:
+    box_manager*                  boxes[MAX_BOX_COUNT] = {};  // 箱子，只在持有全部条带锁时替换
+    std::atomic<size_type>        box_count{0};       // 已追加的箱子数量
+    size_type                     box_capacity;       // 每个箱子的桶数，只在持有全部条带锁时修改
+    std::mutex                    box_mutex;          // 串行化追加箱子
+
+private:    // 内部函数
+    box_manager* create_box(size_type capacity) {
+        box_allocator alloc(allocator);
+        box_manager* box = box_traits::allocate(alloc, 1);
+        try {
+            box_traits::construct(alloc, box, capacity, key_eq_, allocator);
+        } catch (...) {
+            box_traits::deallocate(alloc, box, 1);
+            throw;
+        }
+        return box;
+    }
+
+    void destroy_box(box_manager* box) {
+        box_allocator alloc(allocator);
+        box_traits::destroy(alloc, box);
+        box_traits::deallocate(alloc, box, 1);
+    }
+
+    void destroy_boxes() {
+        size_type count = box_count.load(std::memory_order_relaxed);
+        for (size_type i = 0; i < count; ++i) {
+            destroy_box(boxes[i]);
+            boxes[i] = nullptr;
+        }
+        box_count.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 在所有箱子的 box[keyhash] 中查找键。须持有 keyhash 所在条带的锁
+     */
+    template <typename K>
+    stored_pair* find_node(size_type keyhash, const key_probe<K>& probe) const {
+        size_type count = box_count.load(std::memory_order_acquire);
+        for (size_type i = 0; i < count; ++i) {
+            if (auto* found = boxes[i]->box[keyhash].find(probe)) return found;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief 放入第一个 box[keyhash] 为空的箱子，都非空时放入最后一个箱子。须持有条带锁，且键不存在
+     *
+     * @param last_full 输出，是否放入了最后一个箱子且它达到了负载因子阈值
+     * @param args 直接在桶中构造元素(stored_pair)的参数
+     */
+    template <typename K, typename... Args>
+    stored_pair* place_new(size_type keyhash, const key_probe<K>& probe, bool& last_full, Args&&... args) {
+        size_type count = box_count.load(std::memory_order_acquire);
+        size_type target = count - 1;
+        for (size_type i = 0; i + 1 < count; ++i) {
+            if (boxes[i]->box[keyhash].size() == 0) {
+                target = i;
+                break;
+            }
+        }
+
+        box_manager& box_mgr = *boxes[target];
+        bucket_type& bucket = box_mgr.box[keyhash];
+        bool was_empty = bucket.size() == 0;
+        stored_pair* inserted = bucket.emplace_unique(probe, std::forward<Args>(args)...);
+        size_type used = box_mgr.used_bucket_count.load(std::memory_order_relaxed);
+        if (was_empty) used = box_mgr.used_bucket_count.fetch_add(1, std::memory_order_relaxed) + 1;
+        last_full = target == count - 1 && used >= box_capacity * LOAD_FACTOR_THRESHOLD;
+        return inserted;
+    }
+
+    /**
+     * @brief 最后一个箱子达到阈值后的处理。须持有条带锁
+     *
+     * 箱子数量未达上限时在 box_mutex 下追加一个同样大小的箱子；
+     * 否则需要扩容，返回当前桶数，由调用者释放条带锁后调用 resize。
+     *
+     * @return 需要扩容时返回观察到的桶数，否则返回0
+     */
+    size_type grow(size_type seen_box_count) {
+        if (seen_box_count >= MAX_BOX_COUNT) return box_capacity;
+        std::lock_guard<std::mutex> guard(box_mutex);
+        // 其他条带可能已经追加过
+        if (box_count.load(std::memory_order_relaxed) == seen_box_count) {
+            boxes[seen_box_count] = create_box(box_capacity);
+            box_count.store(seen_box_count + 1, std::memory_order_release);
+        }
+        return 0;
+    }
+
+    /**
+     * @brief 取得全部条带锁，把所有元素迁入一个桶数更大的箱子
+     *
+     * @param seen_capacity 触发扩容时的桶数，已被其他线程扩容时什么也不做
+     */
+    void resize(size_type seen_capacity) {
+        all_stripes_guard guard(*this);
+        if (box_capacity != seen_capacity) return;
+
+        size_type old_count = box_count.load(std::memory_order_relaxed);
+        box_manager* old_boxes[MAX_BOX_COUNT];
+        for (size_type i = 0; i < old_count; ++i) old_boxes[i] = boxes[i];
+
+        size_type capacity = capacity_for(unlocked_size() * 2);
+        box_capacity = capacity > seen_capacity * 2 ? capacity : seen_capacity * 2;
+        boxes[0] = create_box(box_capacity);
+        box_count.store(1, std::memory_order_relaxed);
+
+        for (size_type i = 0; i < old_count; ++i) {
+            for (bucket_type& bucket : old_boxes[i]->box) {
+                for (auto it = bucket.begin(); it != bucket.end(); ++it) {
+                    // 使用存储的哈希值，不重新计算
+                    stored_pair& moving = *it;
+                    bool last_full = false;
+                    place_new(bucket_of(moving.hash, box_capacity), key_probe<Key>{moving.first, moving.hash},
+                              last_full, std::move(moving));
+                    size_type count = box_count.load(std::memory_order_relaxed);
+                    if (last_full && count < MAX_BOX_COUNT) {
+                        boxes[count] = create_box(box_capacity);
+                        box_count.store(count + 1, std::memory_order_relaxed);
+                    }
+                }
+            }
+            destroy_box(old_boxes[i]);
+        }
+    }
+
+    /**
+     * @brief 键不存在时用 args 构造新元素放入，存在时以其值调用 on_existing
+     *
+     * @param args 构造新元素中键值对的参数(不含哈希值)，只在插入时转发
+     * @return true表示发生了插入
+     */
+    template <typename K, typename OnExisting, typename... Args>
+    bool upsert(K&& key, OnExisting&& on_existing, Args&&... args) {
+        uint32_t hash = hash_key(key);
+        size_type resize_from = 0;
+        {
+            stripe& s = stripe_of(hash);
+            std::lock_guard<utils::spinlock> lock(s.lock);
+            size_type keyhash = bucket_of(hash, box_capacity);
+            key_probe<std::remove_reference_t<K>> probe{key, hash};
+            if (auto* existing = find_node(keyhash, probe)) {
+                on_existing(existing->second);
+                return false;
+            }
+            bool last_full = false;
+            size_type seen_box_count = box_count.load(std::memory_order_acquire);
+            place_new(keyhash, probe, last_full, hash, std::forward<Args>(args)...);
+            s.count.fetch_add(1, std::memory_order_relaxed);
+            if (last_full) resize_from = grow(seen_box_count);
+        }
+        if (resize_from) resize(resize_from);
+        return true;
+    }
+
+public:     // 公共函数
+    /**
+     * @brief 构造函数
+     *
+     * @param estimated_size 预计的元素数量
+     */
+    explicit ConcurrentHashMap(size_type estimated_size = 0, const hasher& hash = hasher(),
+                               const key_equal& equal = key_equal(), const Allocator& alloc = Allocator())
+        : base_type(hash, equal, alloc), box_capacity(capacity_for(estimated_size)) {
+        boxes[0] = create_box(box_capacity);
+        box_count.store(1, std::memory_order_relaxed);
+    }
+
+    ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+    ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+
+    ~ConcurrentHashMap() {
+        destroy_boxes();
+    }
+
+    /**
+     * @brief 查找键，找到时把值复制到 value
+     *
+     * @return true表示找到了键
+     */
+    template <typename K = key_type>
+    bool find(const key_arg<K>& key, mapped_type& value) const {
+        uint32_t hash = hash_key(key);
+        std::lock_guard<utils::spinlock> lock(stripe_of(hash).lock);
+        if (auto* found = find_node(bucket_of(hash, box_capacity), key_probe<key_arg<K>>{key, hash})) {
+            value = found->second;
+            return true;
+        }
+        return false;
+    }
+
+    template <typename K = key_type>
+    bool contains(const key_arg<K>& key) const {
+        uint32_t hash = hash_key(key);
+        std::lock_guard<utils::spinlock> lock(stripe_of(hash).lock);
+        return find_node(bucket_of(hash, box_capacity), key_probe<key_arg<K>>{key, hash}) != nullptr;
+    }
+
+    /**
+     * @brief 键不存在时插入，已存在时不修改
+     *
+     * 与 HashMap::insert 不同，不会覆盖已有的值；需要覆盖时使用 insert_or_assign。
+     *
+     * @return true表示发生了插入
+     */
+    bool insert(const Key& key, const Value& value) {
+        return upsert(key, [](mapped_type&) {}, key, value);
+    }
+
+    bool insert(Key&& key, Value&& value) {
+        return upsert(key, [](mapped_type&) {}, std::move(key), std::move(value));
+    }
+
+    /**
+     * @brief 键不存在时用 args 就地构造值并插入，已存在时不构造
+     *
+     * @return true表示发生了插入
+     */
+    template <typename... Args>
+    bool try_emplace(const Key& key, Args&&... args) {
+        return upsert(key, [](mapped_type&) {}, std::piecewise_construct, std::forward_as_tuple(key),
+                      std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    /**
+     * @brief 键存在时把 value 赋给它的值，否则插入
+     *
+     * @return true表示发生了插入
+     */
+    template <typename M>
+    bool insert_or_assign(const Key& key, M&& value) {
+        // 两个分支只会执行其中一个，value 至多被转发一次
+        return upsert(key, [&](mapped_type& existing) { existing = std::forward<M>(value); },
+                      key, std::forward<M>(value));
+    }
+
+    /**
+     * @brief 在条带锁内原子地读取-修改-写回键的值
+     *
+     * 键存在时以其值调用 f；不存在时以值初始化的临时值调用 f。
+     * f 的签名为 bool(mapped_type&)：返回 true 保留（不存在时插入）修改后的值，返回 false 删除该键（不存在时不插入）。
+     * f 在锁内执行，不能再访问本表。
+     *
+     * @return 调用后键是否存在
+     */
+    template <typename F>
+    bool compute(const Key& key, F&& f) {
+        uint32_t hash = hash_key(key);
+        size_type resize_from = 0;
+        {
+            stripe& s = stripe_of(hash);
+            std::lock_guard<utils::spinlock> lock(s.lock);
+            size_type keyhash = bucket_of(hash, box_capacity);
+            key_probe<Key> probe{key, hash};
+            if (auto* existing = find_node(keyhash, probe)) {
+                if (f(existing->second)) return true;
+                erase_locked(keyhash, probe);
+                s.count.fetch_sub(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            mapped_type value{};
+            if (!f(value)) return false;
+            bool last_full = false;
+            size_type seen_box_count = box_count.load(std::memory_order_acquire);
+            place_new(keyhash, probe, last_full, hash, key, std::move(value));
+            s.count.fetch_add(1, std::memory_order_relaxed);
+            if (last_full) resize_from = grow(seen_box_count);
+        }
+        if (resize_from) resize(resize_from);
+        return true;
+    }
+
+    /**
+     * @brief 删除键
+     *
+     * @return true表示找到并删除了键
+     */
+    template <typename K = key_type>
+    bool erase(const key_arg<K>& key) {
+        uint32_t hash = hash_key(key);
+        stripe& s = stripe_of(hash);
+        std::lock_guard<utils::spinlock> lock(s.lock);
+        if (!erase_locked(bucket_of(hash, box_capacity), key_probe<key_arg<K>>{key, hash})) return false;
+        s.count.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief 取得全部条带锁后清空，保留当前桶数
+     */
+    void clear() {
+        all_stripes_guard guard(*this);
+        destroy_boxes();
+        boxes[0] = create_box(box_capacity);
+        box_count.store(1, std::memory_order_release);
+        this->reset_counts();
+    }
+
+    /**
+     * @brief 每个箱子的桶数
+     */
+    size_type bucket_count() const {
+        all_stripes_guard guard(*this);
+        return box_capacity;
+    }
+
+private:
+    /**
+     * @brief 在所有箱子的 box[keyhash] 中删除键。须持有条带锁，不修改条带计数
+     */
+    template <typename K>
+    bool erase_locked(size_type keyhash, const key_probe<K>& probe) {
+        size_type count = box_count.load(std::memory_order_acquire);
+        for (size_type i = 0; i < count; ++i) {
+            bucket_type& bucket = boxes[i]->box[keyhash];
+            if (bucket.remove(probe)) {
+                if (bucket.size() == 0) boxes[i]->used_bucket_count.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+/**
+ * @brief 读多写少的 ConcurrentHashMap：查找不加锁、不写共享内存
+ *
+ * 箱/桶结构与条带锁和默认模式相同，区别在于桶的内容不可变：
+ * - 桶是一个按 pair_less 排序的不可变数组(snapshot)，以原子指针发布，空桶为空指针。
+ *   写者持有条带锁，复制出修改后的新数组，以 release 存储替换桶指针，旧数组交给 QSBR 域延迟回收。
+ * - 箱子列表只会追加：追加箱子时先写入箱子指针，再以 release 存储增加 box_count。
+ * - 扩容在全部条带锁下把所有元素复制到一张新表，发布新表后旧表整体延迟回收。
+ * - 查找以 acquire 依次读取表、box_count 和桶指针，在有序数组中二分查找，并把值复制出来。
+ *
+ * 读取须在已注册的读者下进行：每个调用 find / contains 的线程先用 register_reader() 取得句柄，
+ * 并在两次查找之间(如每个请求、每轮循环之后)调用 quiescent()，否则旧数组无法回收。
+ * 写者之间仍按条带互斥，每次写入复制一个桶并在 QSBR 域的互斥锁下登记旧数组，因此只适合读远多于写的负载。
+ * 元素会被复制，键和值都须可复制构造。
+ */
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+class ConcurrentHashMap<Key, Value, Hash, KeyEqual, Allocator, concurrent_mode::read_mostly>
+    : public _concurrent::map_base<Key, Value, Hash, KeyEqual, Allocator> {
+private:
+    using base_type               = _concurrent::map_base<Key, Value, Hash, KeyEqual, Allocator>;
+
+public:
+    using typename base_type::key_type;
+    using typename base_type::mapped_type;
+    using typename base_type::size_type;
+    using typename base_type::hasher;
+    using typename base_type::key_equal;
+    template <typename K>
+    using key_arg                 = typename base_type::template key_arg<K>;
+    using reader                  = utils::qsbr_domain::reader;     // 读者句柄
+
+private:
+    template <typename U>
+    using rebind_alloc            = typename base_type::template rebind_alloc<U>;
+    using typename base_type::stored_pair;
+    template <typename K>
+    using key_probe               = typename base_type::template key_probe<K>;
+    using typename base_type::pair_less;
+    using typename base_type::pair_equal;
+    using typename base_type::stripe;
+    using typename base_type::all_stripes_guard;
+
+    using base_type::STRIPE_COUNT;
+    using base_type::LOAD_FACTOR_THRESHOLD;
+    using base_type::MAX_BOX_COUNT;
+    using base_type::allocator;
+    using base_type::key_eq_;
+    using base_type::hash_key;
+    using base_type::bucket_of;
+    using base_type::stripe_of;
+    using base_type::capacity_for;
+    using base_type::unlocked_size;
+
+    static constexpr size_type    NONE = ~static_cast<size_type>(0);
+    static constexpr size_t       CELL_ALIGN = alignof(stored_pair) > alignof(size_type) ? alignof(stored_pair) : alignof(size_type);
+
+    struct alignas(CELL_ALIGN) cell {                 // 桶数组的分配单位
+      unsigned char               bytes[CELL_ALIGN];
+    };
+
+    struct snapshot {                                 // 不可变的桶: 头部之后紧跟 count 个有序元素
+      size_type                   count;
+
+      stored_pair* items() { return reinterpret_cast<stored_pair*>(reinterpret_cast<cell*>(this) + HEADER_CELLS); }
+      const stored_pair* items() const { return reinterpret_cast<const stored_pair*>(reinterpret_cast<const cell*>(this) + HEADER_CELLS); }
+    };
+
+    static constexpr size_type    HEADER_CELLS = (sizeof(snapshot) + sizeof(cell) - 1) / sizeof(cell);
+
+    using bucket_type             = std::atomic<snapshot*>;
+
+    struct box_manager {
+      bucket_type*                box;                // 桶数组，桶数由所在的表决定
+      std::atomic<size_type>      used_bucket_count;  // 非空桶的数量，各条带并发更新
+    };
+
+    struct table {                                    // 一次扩容后的全部箱子，扩容时整体替换
+      size_type                   capacity;           // 每个箱子的桶数
+      std::atomic<size_type>      box_count;          // 已发布的箱子数量，只增不减
+      box_manager*                boxes[MAX_BOX_COUNT];
+    };
+
+    using cell_allocator          = rebind_alloc<cell>;
+    using cell_traits             = std::allocator_traits<cell_allocator>;
+    using pair_allocator          = rebind_alloc<stored_pair>;
+    using pair_traits             = std::allocator_traits<pair_allocator>;
+    using bucket_allocator        = rebind_alloc<bucket_type>;
+    using bucket_traits           = std::allocator_traits<bucket_allocator>;
+    using box_allocator           = rebind_alloc<box_manager>;
+    using box_traits              = std::allocator_traits<box_allocator>;
+    using table_allocator         = rebind_alloc<table>;
+    using table_traits            = std::allocator_traits<table_allocator>;
+
+private:
+    std::atomic<table*>           current{nullptr};   // 当前的表，只在持有全部条带锁时替换
+    std::mutex                    box_mutex;          // 串行化追加箱子
+    mutable utils::qsbr_domain    domain;             // 回收被替换的桶和表
+
+private:    // 内部函数
+    static size_type snapshot_cells(size_type count) {
+        return HEADER_CELLS + (count * sizeof(stored_pair) + sizeof(cell) - 1) / sizeof(cell);
+    }
+
+    snapshot* allocate_snapshot(size_type count) {
+        cell_allocator cell_alloc(allocator);
+        snapshot* s = reinterpret_cast<snapshot*>(cell_traits::allocate(cell_alloc, snapshot_cells(count)));
+        ::new (static_cast<void*>(s)) snapshot{count};
+        return s;
+    }
+
+    /**
+     * @brief 析构前 built 个元素并释放可容纳 count 个元素的数组，用于构造中途失败
+     */
+    void discard_snapshot(snapshot* s, size_type built, size_type count) {
+        pair_allocator pair_alloc(allocator);
+        for (size_type i = 0; i < built; ++i) pair_traits::destroy(pair_alloc, s->items() + i);
+        cell_allocator cell_alloc(allocator);
+        cell_traits::deallocate(cell_alloc, reinterpret_cast<cell*>(s), snapshot_cells(count));
+    }
+
+    void destroy_snapshot(snapshot* s) {
+        discard_snapshot(s, s->count, s->count);
+    }
+
+    /**
+     * @brief 复制 old 的元素到新数组，跳过下标 skip，并在下标 insert_at 处用 args 构造新元素
+     *
+     * skip 与 insert_at 可以为 NONE，不插入时 args 为空；两者相等时表示替换该元素。
+     *
+     * @return 新数组，没有元素时返回空指针
+     */
+    template <typename... Args>
+    snapshot* rebuild(const snapshot* old, size_type skip, size_type insert_at, Args&&... args) {
+        size_type old_count = old ? old->count : 0;
+        size_type count = old_count - (skip != NONE) + (insert_at != NONE);
+        if (count == 0) return nullptr;
+
+        snapshot* s = allocate_snapshot(count);
+        pair_allocator pair_alloc(allocator);
+        stored_pair* out = s->items();
+        size_type built = 0;
+        try {
+            for (size_type i = 0; i <= old_count; ++i) {
+                if constexpr (sizeof...(Args) > 0) {
+                    if (i == insert_at) {
+                        pair_traits::construct(pair_alloc, out + built, std::forward<Args>(args)...);
+                        ++built;
+                    }
+                }
+                if (i < old_count && i != skip) {
+                    pair_traits::construct(pair_alloc, out + built, old->items()[i]);
+                    ++built;
+                }
+            }
+        } catch (...) {
+            discard_snapshot(s, built, count);
+            throw;
+        }
+        return s;
+    }
+
+    box_manager* create_box(size_type capacity) {
+        bucket_allocator bucket_alloc(allocator);
+        bucket_type* buckets = bucket_traits::allocate(bucket_alloc, capacity);
+        for (size_type i = 0; i < capacity; ++i) bucket_traits::construct(bucket_alloc, buckets + i, nullptr);
+        box_allocator alloc(allocator);
+        box_manager* box;
+        try {
+            box = box_traits::allocate(alloc, 1);
+        } catch (...) {
+            bucket_traits::deallocate(bucket_alloc, buckets, capacity);
+            throw;
+        }
+        box->box = buckets;
+        ::new (static_cast<void*>(&box->used_bucket_count)) std::atomic<size_type>(0);
+        return box;
+    }
+
+    void destroy_box(box_manager* box, size_type capacity) {
+        for (size_type i = 0; i < capacity; ++i) {
+            if (snapshot* s = box->box[i].load(std::memory_order_relaxed)) destroy_snapshot(s);
+        }
+        bucket_allocator bucket_alloc(allocator);
+        bucket_traits::deallocate(bucket_alloc, box->box, capacity);
+        box_allocator alloc(allocator);
+        box_traits::deallocate(alloc, box, 1);
+    }
+
+    table* create_table(size_type capacity) {
+        table_allocator alloc(allocator);
+        table* t = table_traits::allocate(alloc, 1);
+        t->capacity = capacity;
+        ::new (static_cast<void*>(&t->box_count)) std::atomic<size_type>(0);
+        try {
+            t->boxes[0] = create_box(capacity);
+        } catch (...) {
+            table_traits::deallocate(alloc, t, 1);
+            throw;
+        }
+        t->box_count.store(1, std::memory_order_relaxed);
+        return t;
+    }
+
+    void destroy_table(table* t) {
+        size_type count = t->box_count.load(std::memory_order_relaxed);
+        for (size_type i = 0; i < count; ++i) destroy_box(t->boxes[i], t->capacity);
+        table_allocator alloc(allocator);
+        table_traits::deallocate(alloc, t, 1);
+    }
+
+    static void reclaim_snapshot(void* context, void* object) {
+        static_cast<ConcurrentHashMap*>(context)->destroy_snapshot(static_cast<snapshot*>(object));
+    }
+
+    static void reclaim_table(void* context, void* object) {
+        static_cast<ConcurrentHashMap*>(context)->destroy_table(static_cast<table*>(object));
+    }
+
+    /**
+     * @brief 以 release 存储发布新的桶，旧桶交给 QSBR 域。须持有条带锁
+     */
+    void publish(box_manager& box_mgr, size_type keyhash, snapshot* old, snapshot* replacement) {
+        box_mgr.box[keyhash].store(replacement, std::memory_order_release);
+        if (!old && replacement) box_mgr.used_bucket_count.fetch_add(1, std::memory_order_relaxed);
+        if (old && !replacement) box_mgr.used_bucket_count.fetch_sub(1, std::memory_order_relaxed);
+        if (old) domain.retire(old, &ConcurrentHashMap::reclaim_snapshot, this);
+    }
+
+    /**
+     * @brief 在有序数组中查找键
+     *
+     * pair_less 下与键等价的元素可能有多个（哈希值相同的不同键），从第一个不小于键的位置起逐个比较这一段。
+     *
+     * @return 键所在的下标，不存在时返回 NONE；insert_at 输出插入位置
+     */
+    template <typename K>
+    size_type search(const snapshot* s, const key_probe<K>& probe, size_type& insert_at) const {
+        if (!s) {
+            insert_at = 0;
+            return NONE;
+        }
+        const stored_pair* first = s->items();
+        const stored_pair* last = first + s->count;
+        const stored_pair* it = std::lower_bound(first, last, probe, pair_less());
+        insert_at = static_cast<size_type>(it - first);
+        pair_equal equal{key_eq_};
+        for (; it != last && !pair_less()(probe, *it); ++it) {
+            if (equal(*it, probe)) return static_cast<size_type>(it - first);
+        }
+        return NONE;
+    }
+
+    /**
+     * @brief 不加锁地查找键，须在已注册的读者下调用
+     */
+    template <typename K>
+    const stored_pair* find_node(const key_probe<K>& probe) const {
+        const table* t = current.load(std::memory_order_acquire);
+        size_type keyhash = bucket_of(probe.hash, t->capacity);
+        size_type count = t->box_count.load(std::memory_order_acquire);
+        size_type insert_at;
+        for (size_type i = 0; i < count; ++i) {
+            const snapshot* s = t->boxes[i]->box[keyhash].load(std::memory_order_acquire);
+            size_type index = search(s, probe, insert_at);
+            if (index != NONE) return s->items() + index;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief 在所有箱子的 box[keyhash] 中定位键。须持有条带锁
+     *
+     * @param box 输出，键所在的箱子；键不存在时为 NONE
+     * @return 键在桶中的下标，不存在时返回 NONE
+     */
+    template <typename K>
+    size_type locate(const table* t, size_type keyhash, const key_probe<K>& probe, size_type& box) const {
+        size_type count = t->box_count.load(std::memory_order_acquire);
+        size_type insert_at;
+        for (size_type i = 0; i < count; ++i) {
+            size_type index = search(t->boxes[i]->box[keyhash].load(std::memory_order_relaxed), probe, insert_at);
+            if (index != NONE) {
+                box = i;
+                return index;
+            }
+        }
+        box = NONE;
+        return NONE;
+    }
+
+    /**
+     * @brief 放入第一个 box[keyhash] 为空的箱子，都非空时放入最后一个箱子。须持有条带锁，且键不存在
+     *
+     * @return 是否放入了最后一个箱子且它达到了负载因子阈值
+     */
+    template <typename K, typename... Args>
+    bool place_new(table* t, size_type keyhash, const key_probe<K>& probe, Args&&... args) {
+        size_type count = t->box_count.load(std::memory_order_acquire);
+        size_type target = count - 1;
+        for (size_type i = 0; i + 1 < count; ++i) {
+            if (!t->boxes[i]->box[keyhash].load(std::memory_order_relaxed)) {
+                target = i;
+                break;
+            }
+        }
+
+        box_manager& box_mgr = *t->boxes[target];
+        snapshot* old = box_mgr.box[keyhash].load(std::memory_order_relaxed);
+        size_type insert_at;
+        search(old, probe, insert_at);
+        publish(box_mgr, keyhash, old, rebuild(old, NONE, insert_at, std::forward<Args>(args)...));
+        return target == count - 1 &&
+               box_mgr.used_bucket_count.load(std::memory_order_relaxed) >= t->capacity * LOAD_FACTOR_THRESHOLD;
+    }
+
+    /**
+     * @brief 最后一个箱子达到阈值后的处理。须持有条带锁
+     *
+     * @return 需要扩容时返回观察到的桶数，否则返回0
+     */
+    size_type grow(table* t, size_type seen_box_count) {
+        if (seen_box_count >= MAX_BOX_COUNT) return t->capacity;
+        std::lock_guard<std::mutex> guard(box_mutex);
+        if (t->box_count.load(std::memory_order_relaxed) == seen_box_count) {
+            t->boxes[seen_box_count] = create_box(t->capacity);
+            t->box_count.store(seen_box_count + 1, std::memory_order_release);
+        }
+        return 0;
+    }
+
+    /**
+     * @brief 取得全部条带锁，把所有元素复制到一张桶数更大的新表并发布
+     *
+     * 线性映射下 keyhash 随哈希值单调，按 pair_less 排序后同一个桶的元素连续，逐段构造新桶即可。
+     *
+     * @param seen_capacity 触发扩容时的桶数，已被其他线程扩容时什么也不做
+     */
+    void resize(size_type seen_capacity) {
+        all_stripes_guard guard(*this);
+        table* old = current.load(std::memory_order_relaxed);
+        if (old->capacity != seen_capacity) return;
+
+        std::vector<const stored_pair*> all;
+        all.reserve(unlocked_size());
+        size_type old_count = old->box_count.load(std::memory_order_relaxed);
+        for (size_type i = 0; i < old_count; ++i) {
+            for (size_type b = 0; b < old->capacity; ++b) {
+                const snapshot* s = old->boxes[i]->box[b].load(std::memory_order_relaxed);
+                if (!s) continue;
+                for (size_type j = 0; j < s->count; ++j) all.push_back(s->items() + j);
+            }
+        }
+        std::sort(all.begin(), all.end(), [](const stored_pair* a, const stored_pair* b) { return pair_less()(*a, *b); });
+
+        size_type capacity = capacity_for(all.size() * 2);
+        table* t = create_table(capacity > seen_capacity * 2 ? capacity : seen_capacity * 2);
+        try {
+            box_manager& box_mgr = *t->boxes[0];
+            size_type used = 0;
+            for (size_type begin = 0; begin < all.size(); ) {
+                size_type keyhash = bucket_of(all[begin]->hash, t->capacity);
+                size_type end = begin + 1;
+                while (end < all.size() && bucket_of(all[end]->hash, t->capacity) == keyhash) ++end;
+
+                snapshot* s = allocate_snapshot(end - begin);
+                pair_allocator pair_alloc(allocator);
+                size_type built = 0;
+                try {
+                    for (; built < end - begin; ++built) pair_traits::construct(pair_alloc, s->items() + built, *all[begin + built]);
+                } catch (...) {
+                    discard_snapshot(s, built, end - begin);
+                    throw;
+                }
+                box_mgr.box[keyhash].store(s, std::memory_order_relaxed);
+                ++used;
+                begin = end;
+            }
+            box_mgr.used_bucket_count.store(used, std::memory_order_relaxed);
+        } catch (...) {
+            destroy_table(t);
+            throw;
+        }
+
+        current.store(t, std::memory_order_release);
+        domain.retire(old, &ConcurrentHashMap::reclaim_table, this);
+    }
+
+    /**
+     * @brief 键不存在时用 args 构造新元素放入；存在且 assign 为 true 时用 args 构造的元素替换它
+     *
+     * @param hash 键的哈希值，由调用者计算一次，同时用于构造新元素
+     * @param args 构造新元素(stored_pair)的参数
+     * @return true表示发生了插入
+     */
+    template <typename K, typename... Args>
+    bool upsert(const K& key, uint32_t hash, bool assign, Args&&... args) {
+        size_type resize_from = 0;
+        {
+            stripe& s = stripe_of(hash);
+            std::lock_guard<utils::spinlock> lock(s.lock);
+            table* t = current.load(std::memory_order_relaxed);
+            size_type keyhash = bucket_of(hash, t->capacity);
+            key_probe<K> probe{key, hash};
+            size_type box;
+            size_type index = locate(t, keyhash, probe, box);
+            if (index != NONE) {
+                if (assign) {
+                    box_manager& box_mgr = *t->boxes[box];
+                    snapshot* old = box_mgr.box[keyhash].load(std::memory_order_relaxed);
+                    publish(box_mgr, keyhash, old, rebuild(old, index, index, std::forward<Args>(args)...));
+                }
+                return false;
+            }
+            size_type seen_box_count = t->box_count.load(std::memory_order_acquire);
+            bool last_full = place_new(t, keyhash, probe, std::forward<Args>(args)...);
+            s.count.fetch_add(1, std::memory_order_relaxed);
+            if (last_full) resize_from = grow(t, seen_box_count);
+        }
+        if (resize_from) resize(resize_from);
+        return true;
+    }
+
+public:     // 公共函数
+    /**
+     * @brief 构造函数
+     *
+     * @param estimated_size 预计的元素数量
+     */
+    explicit ConcurrentHashMap(size_type estimated_size = 0, const hasher& hash = hasher(),
+                               const key_equal& equal = key_equal(), const Allocator& alloc = Allocator())
+        : base_type(hash, equal, alloc) {
+        current.store(create_table(capacity_for(estimated_size)), std::memory_order_relaxed);
+    }
+
+    ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+    ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+
+    /**
+     * @brief 析构函数，此时不能再有读者
+     */
+    ~ConcurrentHashMap() {
+        domain.drain();
+        destroy_table(current.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief 把当前线程注册为读者
+     *
+     * 句柄只能由注册它的线程使用，在两次查找之间调用 quiescent()；长时间不查找时可以 offline()。
+     */
+    reader register_reader() const {
+        return domain.register_reader();
+    }
+
+    /**
+     * @brief 立即尝试回收所有读者都已不再使用的旧桶和旧表
+     */
+    void reclaim() {
+        domain.reclaim();
+    }
+
+    /**
+     * @brief 查找键，找到时把值复制到 value。不加锁，须在已注册的读者下调用
+     *
+     * @return true表示找到了键
+     */
+    template <typename K = key_type>
+    bool find(const key_arg<K>& key, mapped_type& value) const {
+        if (const stored_pair* found = find_node(key_probe<key_arg<K>>{key, hash_key(key)})) {
+            value = found->second;
+            return true;
+        }
+        return false;
+    }
+
+    template <typename K = key_type>
+    bool contains(const key_arg<K>& key) const {
+        return find_node(key_probe<key_arg<K>>{key, hash_key(key)}) != nullptr;
+    }
+
+    /**
+     * @brief 键不存在时插入，已存在时不修改
+     *
+     * @return true表示发生了插入
+     */
+    bool insert(const Key& key, const Value& value) {
+        uint32_t hash = hash_key(key);
+        return upsert(key, hash, false, hash, key, value);
+    }
+
+    /**
+     * @brief 键不存在时用 args 构造值并插入，已存在时不构造
+     *
+     * @return true表示发生了插入
+     */
+    template <typename... Args>
+    bool try_emplace(const Key& key, Args&&... args) {
+        uint32_t hash = hash_key(key);
+        return upsert(key, hash, false, hash, std::piecewise_construct, std::forward_as_tuple(key),
+                      std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    /**
+     * @brief 键存在时以新值替换，否则插入
+     *
+     * @return true表示发生了插入
+     */
+    template <typename M>
+    bool insert_or_assign(const Key& key, M&& value) {
+        uint32_t hash = hash_key(key);
+        return upsert(key, hash, true, hash, key, std::forward<M>(value));
+    }
+
+    /**
+     * @brief 在条带锁内原子地读取-修改-写回键的值
+     *
+     * 与默认模式相同：f 的签名为 bool(mapped_type&)，作用于值的副本，
+     * 返回 true 发布修改后的值（不存在时插入），返回 false 删除该键（不存在时不插入）。
+     *
+     * @return 调用后键是否存在
+     */
+    template <typename F>
+    bool compute(const Key& key, F&& f) {
+        uint32_t hash = hash_key(key);
+        size_type resize_from = 0;
+        {
+            stripe& s = stripe_of(hash);
+            std::lock_guard<utils::spinlock> lock(s.lock);
+            table* t = current.load(std::memory_order_relaxed);
+            size_type keyhash = bucket_of(hash, t->capacity);
+            key_probe<Key> probe{key, hash};
+            size_type box;
+            size_type index = locate(t, keyhash, probe, box);
+            if (index != NONE) {
+                box_manager& box_mgr = *t->boxes[box];
+                snapshot* old = box_mgr.box[keyhash].load(std::memory_order_relaxed);
+                mapped_type value = old->items()[index].second;
+                if (f(value)) {
+                    publish(box_mgr, keyhash, old, rebuild(old, index, index, hash, key, std::move(value)));
+                    return true;
+                }
+                publish(box_mgr, keyhash, old, rebuild(old, index, NONE));
+                s.count.fetch_sub(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            mapped_type value{};
+            if (!f(value)) return false;
+            size_type seen_box_count = t->box_count.load(std::memory_order_acquire);
+            bool last_full = place_new(t, keyhash, probe, hash, key, std::move(value));
+            s.count.fetch_add(1, std::memory_order_relaxed);
+            if (last_full) resize_from = grow(t, seen_box_count);
+        }
+        if (resize_from) resize(resize_from);
+        return true;
+    }
+
+    /**
+     * @brief 删除键
+     *
+     * @return true表示找到并删除了键
+     */
+    template <typename K = key_type>
+    bool erase(const key_arg<K>& key) {
+        uint32_t hash = hash_key(key);
+        stripe& s = stripe_of(hash);
+        std::lock_guard<utils::spinlock> lock(s.lock);
+        table* t = current.load(std::memory_order_relaxed);
+        size_type keyhash = bucket_of(hash, t->capacity);
+        size_type box;
+        size_type index = locate(t, keyhash, key_probe<key_arg<K>>{key, hash}, box);
+        if (index == NONE) return false;
+        box_manager& box_mgr = *t->boxes[box];
+        snapshot* old = box_mgr.box[keyhash].load(std::memory_order_relaxed);
+        publish(box_mgr, keyhash, old, rebuild(old, index, NONE));
+        s.count.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief 取得全部条带锁后发布一张空表，保留当前桶数
+     */
+    void clear() {
+        all_stripes_guard guard(*this);
+        table* old = current.load(std::memory_order_relaxed);
+        current.store(create_table(old->capacity), std::memory_order_release);
+        this->reset_counts();
+        domain.retire(old, &ConcurrentHashMap::reclaim_table, this);
+    }
+
+    /**
+     * @brief 每个箱子的桶数
+     */
+    size_type bucket_count() const {
+        return current.load(std::memory_order_acquire)->capacity;
+    }
+
+    /**
+     * @brief 尚未回收的旧桶和旧表数量
+     */
+    size_type pending_reclaim() const {
+        return domain.pending();
+    }
+};
+
+/**
+ * @brief 读多写少模式的 ConcurrentHashMap
+ */
+template <typename Key, typename Value,
+          typename Hash = utils::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>,
+          typename Allocator = std::allocator<std::pair<const Key, Value>>>
+using ReadMostlyHashMap = ConcurrentHashMap<Key, Value, Hash, KeyEqual, Allocator, concurrent_mode::read_mostly>;
+
+#endif // CONCURRENT_HASHMAP_HPP
@@ -4,34 +4,73 @@
 #include "utils/__def.hpp"
 #include "utils/__errs.hpp" 
 #include "utils/xxhash32.hpp"
-#include "utils/rbtree.hpp"
+#include "utils/hash.hpp"
+#include "utils/bucket.hpp"
 #include "utils/bitmap.hpp"
+#include "utils/flat_table.hpp"
+#include "utils/thread_pool.hpp"
+#include "utils/memory_report.hpp"
+#include "utils/map_stats.hpp"
 #include "utils/__iterator.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <utility>
+#include <tuple>
 #include <stdexcept>
 #include <initializer_list>
 #include <limits>
 #include <iostream>
 #include <list>
+#include <iterator>
+#include <type_traits>
+
+/**
+ * @brief HashMap 的存储引擎
+ */
+namespace hashmap_storage {
+    struct box {};      // 默认：多个箱子，桶为内联元素 / 小有序数组 / 红黑树
+    struct flat {};     // 开放寻址平坦表，SIMD 控制字节，见 utils::flat_table
+
+    /**
+     * @brief 默认引擎的增长策略
+     * 
+     * 所有主箱共用同一个桶下标和跨箱占用目录，因此同时存在的主箱桶数相同；
+     * 增长先追加同样大小的主箱，主箱数量达到上限后渐进式合并到一个按 growth_factor 倍增的主箱，
+     * 除合并进行中追加的主箱外，主箱数量不超过 max_box_count，桶数按几何级数增长。
+     */
+    struct growth_policy {
+        double             max_load_factor = 0.75;  // 最后一个主箱的非空桶占比超过此值时扩展，取值 (0, 1]
+        unsigned long long max_box_count = 4;       // 主箱数量上限，达到后扩展改为合并到一个更大的箱子，至少为1
+        unsigned long long growth_factor = 2;       // 合并后的主箱桶数至少是原来的多少倍，不小于2的2的幂
+    };
+}
 
 /**
  * @brief 具有动态桶扩展和红黑树桶的HashMap实现
  * 
  * 主要特性：
  * - 使用32位XXHash算法进行哈希计算，线性映射确保分布均匀
- * - 动态桶数组，负载因子超过0.75时自动扩展
- * - 红黑树作为内部桶结构，保证最坏情况下的O(log n)查找性能
+ * - 动态桶数组，负载因子超过阈值（默认0.75）时自动扩展，增长策略可在运行时配置
+ * - 自适应桶：单个元素内联存放，少量元素使用有序数组，超过阈值后转为红黑树，保证最坏情况下的O(log n)查找性能
  * - 支持完整的STL兼容接口
  * - 基于位图优化的迭代器实现，提高遍历效率
  * 
  * @tparam Key 键类型
  * @tparam Value 值类型  
+ * @tparam Hash 哈希函数对象类型，默认为基于XXHash32、按内容哈希字符串/pair/tuple的utils::hash
+ * @tparam KeyEqual 键相等比较函数对象类型，相等的键须有相同的哈希值；不要求 Key::operator<
  * @tparam Allocator 内存分配器类型，默认为std::allocator
+ * @tparam Storage 存储引擎，hashmap_storage::box（默认）或 hashmap_storage::flat
  */
-template <typename Key, typename Value, typename Allocator = std::allocator<std::pair<const Key, Value>>>
+template <typename Key, typename Value,
+          typename Hash = utils::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>,
+          typename Allocator = std::allocator<std::pair<const Key, Value>>,
+          typename Storage = hashmap_storage::box>
 class HashMap {
 public:
     // 类型定义
@@ -41,53 +80,220 @@ public:
     using pair_type               = std::pair<Key, Value>;          // 内部使用的键值对
     using const_pair_type         = std::pair<const Key, Value>;    // 键值对
 
-    using bucket_type             = utils::rbtree<pair_type>;       // 桶
-    using box_type                = std::vector<bucket_type>;       // 箱
-    using box_map_type            = utils::bitmap<>;                // 箱的位图
+    struct stored_pair : pair_type {                                // 桶内元素: 键值对及其完整的32位哈希值
+        uint32_t hash;
+
+        template <typename... Args>
+        explicit stored_pair(uint32_t hash, Args&&... args) : pair_type(std::forward<Args>(args)...), hash(hash) {}
+    };
+    template <typename K>
+    struct key_probe {                                              // 桶内查找的目标: 键及其哈希值
+        const K& key;
+        uint32_t hash;
+    };
+
+    struct pair_less {                                              // 桶内只按哈希值排序，哈希值相同的一段由 pair_equal 逐个比较
+        bool operator()(const stored_pair& a, const stored_pair& b) const {
+            return a.hash < b.hash;
+        }
+        template <typename K>
+        bool operator()(const stored_pair& a, const key_probe<K>& b) const {
+            return a.hash < b.hash;
+        }
+        template <typename K>
+        bool operator()(const key_probe<K>& a, const stored_pair& b) const {
+            return a.hash < b.hash;
+        }
+    };
+    struct pair_equal : private utils::ebo_storage<KeyEqual, 0> {   // 哈希值相等时才用 KeyEqual 比较键; 空的 KeyEqual 不占空间
+        explicit pair_equal(const KeyEqual& key_eq = KeyEqual()) : utils::ebo_storage<KeyEqual, 0>(key_eq) {}
+        bool operator()(const stored_pair& a, const stored_pair& b) const {
+            return a.hash == b.hash && this->get()(a.first, b.first);
+        }
+        template <typename K>
+        bool operator()(const stored_pair& a, const key_probe<K>& b) const {
+            return a.hash == b.hash && this->get()(a.first, b.key);
+        }
+    };
 
     using size_type               = unsigned long long;             // 大小
     using allocator_type          = Allocator;                      // 分配器
+    template <typename U>
+    using rebind_alloc            = typename std::allocator_traits<Allocator>::template rebind_alloc<U>;
+
+    using bucket_type             = utils::adaptive_bucket<stored_pair, pair_less, pair_equal,
+                                                           rebind_alloc<stored_pair>>;  // 桶
+    using box_type                = std::vector<bucket_type, rebind_alloc<bucket_type>>;  // 箱
+    using box_map_type            = utils::bitmap<rebind_alloc<uint64_t>>;            // 箱的位图
+
+    using hasher_type             = Hash;                           // 哈希器
+    using key_equal_type          = KeyEqual;                       // 键相等比较器
+    using hasher                  = Hash;                           // STL兼容的哈希器类型名
+    using key_equal               = KeyEqual;                       // STL兼容的相等比较器类型名
 
-    using hasher_type             = utils::XXHash32;                // 哈希器
+    // 哈希器和键相等比较器都声明了 is_transparent 时，查找接受任何可与 Key 比较的类型(例如 std::string 键的 std::string_view)
+    template <typename K>
+    using key_arg                 = typename utils::key_arg_impl<utils::is_transparent<Hash>::value &&
+                                                                 utils::is_transparent<KeyEqual>::value>::template type<K, Key>;
 
 private:
     struct box_manager {
       box_type                    box;                // 箱
       box_map_type                box_map;            // 箱的位图
       size_type                   used_bucket_count;  // 非空桶的数量
+      size_type                   capacity;           // 箱内桶的数量
 
-      box_manager(size_type capacity) {
-        this->box.resize(capacity);
-        // 为每个桶配置比较器和相等器
-        for (auto& bucket : this->box) {
-            bucket = bucket_type(
-                [](const pair_type& a, const pair_type& b) -> bool { 
-                    return a.first < b.first; 
-                },
-                [](const pair_type& a, const pair_type& b) -> bool { 
-                    return a.first == b.first; 
-                }
-            );
-        }
+      box_manager(size_type capacity, const key_equal_type& key_eq, const Allocator& alloc)
+        : box(rebind_alloc<bucket_type>(alloc)),
+          box_map(rebind_alloc<uint64_t>(alloc)), capacity(capacity) {
+        // 逐个移动构造空桶，不要求元素可拷贝(只能移动的值)
+        this->box.reserve(capacity);
+        for (size_type i = 0; i < capacity; ++i) this->box.emplace_back(make_bucket(key_eq, alloc));
         this->box_map.init(capacity);
         this->used_bucket_count = 0;
       }
     };
 
+    /**
+     * @brief 跨箱占用目录
+     * 
+     * 所有箱子共用同一个 keyhash，因此可以为每个桶下标维护一个掩码：
+     * 第 i 位为 1 表示 box_index[i]->box[keyhash] 非空。
+     * 查找、插入、删除只访问掩码中置位的箱子，未命中时只需读一次目录，
+     * 而不必逐箱探测位于不同缓存行的位图。
+     * 
+     * 每个桶的掩码宽度 width 是不小于箱子数量的2的幂（至少8位），按桶连续存放。
+     */
+    struct box_directory {
+      static constexpr size_type  npos = static_cast<size_type>(-1);
+
+      std::vector<uint64_t>       words;              // 掩码存储
+      size_type                   width = 8;          // 每桶掩码的位数
+      size_type                   capacity = 0;       // 桶的数量
+
+      void init(size_type capacity, size_type box_count) {
+        this->capacity = capacity;
+        this->width = 8;
+        while (this->width < box_count) this->width <<= 1;
+        this->words.assign((capacity * this->width + 63) / 64, 0);
+      }
+
+      void reset() {
+        std::fill(this->words.begin(), this->words.end(), 0);
+      }
+
+      /**
+       * @brief bucket 的掩码所在字的地址，用于预取
+       */
+      const uint64_t* word_of(size_type bucket) const {
+        return this->words.data() + ((bucket * this->width) >> 6);
+      }
+
+      bool get(size_type bucket, size_type box) const {
+        size_type bit = bucket * this->width + box;
+        return (this->words[bit >> 6] >> (bit & 63)) & 1;
+      }
+
+      void set(size_type bucket, size_type box, bool value) {
+        size_type bit = bucket * this->width + box;
+        if (value) this->words[bit >> 6] |= uint64_t(1) << (bit & 63);
+        else this->words[bit >> 6] &= ~(uint64_t(1) << (bit & 63));
+      }
+
+      /**
+       * @brief 查找 bucket 的掩码中下标在 [from, limit) 内的第一个置位(clear 为 true 时找清零位)的箱子
+       * 
+       * @return 箱子下标，没有则返回 npos
+       */
+      size_type next(size_type bucket, size_type from, size_type limit, bool clear = false) const {
+        size_type begin = bucket * this->width;
+        size_type end = begin + (limit < this->width ? limit : this->width);
+        for (size_type bit = begin + from; bit < end; ) {
+          uint64_t word = this->words[bit >> 6];
+          if (clear) word = ~word;
+          word >>= (bit & 63);
+          size_type word_end = (bit | 63) + 1;
+          if (word_end > end) word &= (uint64_t(1) << (end - bit)) - 1;
+          if (word) return bit - begin + utils::ctz64(word);
+          bit = word_end;
+        }
+        return npos;
+      }
+
+      /**
+       * @brief bucket 的掩码中下标小于 limit 的置位数
+       */
+      size_type count(size_type bucket, size_type limit) const {
+        size_type n = 0;
+        for (size_type i = this->next(bucket, 0, limit); i != npos; i = this->next(bucket, i + 1, limit)) n++;
+        return n;
+      }
+
+      /**
+       * @brief 箱子数量超过掩码宽度时，加倍宽度并重新排布所有掩码
+       */
+      void reserve_boxes(size_type box_count) {
+        if (box_count <= this->width) return;
+        box_directory wider;
+        wider.init(this->capacity, box_count);
+        for (size_type bucket = 0; bucket < this->capacity; ++bucket)
+          for (size_type i = this->next(bucket, 0, this->width); i != npos; i = this->next(bucket, i + 1, this->width))
+            wider.set(bucket, i, true);
+        *this = std::move(wider);
+      }
+    };
+
+    /**
+     * @brief 渐进式合并状态
+     * 
+     * 箱子数量达到增长策略的 max_box_count 后需要扩展时，不再追加同样大小的箱子，
+     * 而是新建一个桶数更大的主箱，原有箱子整体转为旧箱（仍留在 box_list 尾部，主箱在前）。
+     * 之后每次插入/删除迁移 MIGRATE_STEP 个旧桶下标，旧桶下标在 [0, cursor) 内的元素都已迁入主箱，
+     * 全部迁移完毕后释放旧箱。迁移期间查找会同时检查主箱和尚未迁移的旧桶。
+     */
+    using box_list_type           = std::list<box_manager, rebind_alloc<box_manager>>;
+
+    struct migration_state {
+      std::vector<box_manager*>   box_index;          // 旧箱子的随机访问索引
+      box_directory               box_dir;            // 旧箱子的占用目录
+      size_type                   box_capacity = 0;   // 旧箱子的桶数
+      size_type                   cursor = 0;         // 下一个待迁移的旧桶下标
+      typename box_list_type::iterator first;         // box_list 中第一个旧箱子
+    };
+
 private:
-    std::list<box_manager>        box_list;           // 箱链表
-    size_type                     box_capacity;       // 每箱容纳多少桶
+    Allocator                     allocator;          // 内存分配器，重绑定后用于箱、位图、桶内数组和红黑树节点
+    box_list_type                 box_list;           // 箱链表
+    std::vector<box_manager*>     box_index;          // 主箱的随机访问索引，与box_list顺序一致
+    box_directory                 box_dir;            // 主箱的跨箱占用目录
+    migration_state               migration;          // 渐进式合并状态
+    size_type                     box_capacity;       // 每个主箱容纳多少桶
     size_type                     size_;              // 总的键值对数量
+    bool                          auto_shrink_ = false; // 删除元素后是否按需自动收缩
+    hashmap_storage::growth_policy policy_;           // 增长策略
 
-    hasher_type                   hasher;             // 哈希器
+    hasher_type                   hash_function_;     // 哈希器
+    key_equal_type                key_eq_;            // 键相等比较器
 
-                                                      // 负载因子阈值
-    static constexpr double       LOAD_FACTOR_THRESHOLD = 0.75; 
-
-    
-    Allocator allocator;                              // 内存分配器
+                                                      // 每次插入/删除迁移的旧桶下标数量
+    static constexpr size_type    MIGRATE_STEP = 8;
+                                                      // 批量操作每一轮先哈希并预取的键数
+    static constexpr size_type    BATCH_CHUNK = 32;
+                                                      // 并行操作每个任务至少处理的桶下标数，64的倍数
+    static constexpr size_type    PARALLEL_GRAIN = 4096;
+                                                      // compact 时非空桶占比低于此值的主箱被清空并释放
+    static constexpr double       COMPACT_THRESHOLD = 0.125;
+                                                      // 开启自动收缩后，元素数量低于主箱总桶数的此比例时删除会触发 shrink_to_fit
+    static constexpr double       AUTO_SHRINK_LOAD = 0.125;
 
 private:    // 内部函数
+    /**
+     * @brief 创建一个空桶，桶内按哈希值排序，按 KeyEqual 判断键相等
+     */
+    static bucket_type make_bucket(const key_equal_type& key_eq, const Allocator& alloc) {
+        return bucket_type(pair_less(), pair_equal{key_eq}, rebind_alloc<stored_pair>(alloc));
+    }
+
     /**
      * @brief 根据预估数据规模计算箱大小
      * 
@@ -97,8 +303,8 @@ private:    // 内部函数
     size_type calculate_initial_box_capacity(size_type estimated_size) const {
         if (estimated_size <= 16) return 16;  // 默认最小大小
         
-        // 基于负载因子计算: box_capacity = estimated_size / 0.75
-        size_type required_capacity = static_cast<size_type>(estimated_size / LOAD_FACTOR_THRESHOLD) + 1;
+        // 基于负载因子计算: box_capacity = estimated_size / max_load_factor
+        size_type required_capacity = static_cast<size_type>(estimated_size / policy_.max_load_factor) + 1;
         
         // 向上取整到下一个2的幂，以获得更好的哈希分布
         size_type box_capacity = 1;
@@ -113,46 +319,730 @@ private:    // 内部函数
      * @param key 要计算索引的键
      * @return 对应的桶索引
      */
-    size_type get_bucket_index(const key_type& key) const {
-        return this->hasher.hash_linear(&key, sizeof(key_type), 0, this->box_capacity - 1);
-    }    /**
-     * @brief 根据负载因子检查是否需要扩展最后一个箱子
+    template <typename K>
+    size_type get_bucket_index(const K& key) const {
+        return bucket_of(hash_key(key), this->box_capacity);
+    }
+
+    /**
+     * @brief 计算键的32位哈希值
+     * 
+     * 哈希器的输出未声明为已充分混合时（例如 std::hash），再用 XXHash32 混合一次，
+     * 保证线性映射使用的高位分布均匀。
+     */
+    template <typename K>
+    uint32_t hash_key(const K& key) const {
+        auto hash = this->hash_function_(key);
+        if constexpr (utils::is_avalanching<hasher_type>::value && sizeof(hash) <= sizeof(uint32_t)) {
+            return static_cast<uint32_t>(hash);
+        } else {
+            return utils::XXHash32::hash_raw(&hash, sizeof(hash));
+        }
+    }
+
+    /**
+     * @brief 将哈希值线性映射到桶数为 capacity 的箱子中的桶索引
+     */
+    static size_type bucket_of(uint32_t hash, size_type capacity) {
+        return utils::XXHash32::map_linear(hash, 0, static_cast<uint32_t>(capacity - 1));
+    }
+
+    /**
+     * @brief 根据负载因子检查是否需要扩展最后一个主箱
+     * 
+     * 非空桶占比超过负载因子时扩展；所有桶都已非空时也扩展，否则负载因子为1时永远不会扩展。
      * 
      * @return true表示需要扩展，false表示不需要
      */
     bool should_expand() const {
-        if (box_list.empty()) return false;
-        const auto& last_box = box_list.back();
-        return static_cast<double>(last_box.used_bucket_count) / box_capacity > LOAD_FACTOR_THRESHOLD;
-    }    /**
-     * @brief 扩展箱子 - 添加新的箱子到链表末尾
+        if (box_index.empty()) return false;
+        const auto& last_box = *box_index.back();
+        return last_box.used_bucket_count >= box_capacity ||
+               static_cast<double>(last_box.used_bucket_count) / box_capacity > policy_.max_load_factor;
+    }
+
+    /**
+     * @brief 扩展箱子 - 在主箱末尾（旧箱之前）添加新的箱子
      * 
      */
     void expand_box() {
-        box_list.emplace_back(box_capacity);
+        auto pos = migrating() ? migration.first : box_list.end();
+        box_index.push_back(&*box_list.emplace(pos, box_capacity, key_eq_, allocator));
+        box_dir.reserve_boxes(box_index.size());
+    }
+
+    /**
+     * @brief 最后一个主箱达到负载因子阈值时扩展，主箱数量已达上限时改为开始渐进式合并
+     */
+    void grow_if_needed() {
+        if (!should_expand()) return;
+        if (!migrating() && box_index.size() >= policy_.max_box_count) start_migration();
+        else expand_box();
+    }
+
+    /**
+     * @brief 丢弃所有箱子并重建为一个空箱子
+     */
+    void init_boxes() {
+        migration = migration_state();
+        box_list.clear();
+        box_index.clear();
+        box_dir.init(box_capacity, 1);
+        expand_box();
+    }
+
+    /**
+     * @brief 是否正在进行渐进式合并
+     */
+    bool migrating() const {
+        return !migration.box_index.empty();
+    }
+
+    /**
+     * @brief 开始渐进式合并
+     * 
+     * 当前所有主箱转为旧箱，新建一个能容纳 growth_factor 倍当前元素数量、桶数至少为原来 growth_factor 倍的主箱。
+     * 此处不移动任何元素，已有元素的指针保持有效。
+     */
+    void start_migration() {
+        migration.box_index = std::move(box_index);
+        migration.box_dir = std::move(box_dir);
+        migration.box_capacity = box_capacity;
+        migration.cursor = 0;
+        migration.first = box_list.begin();
+
+        size_type capacity = calculate_initial_box_capacity(size_ * policy_.growth_factor);
+        box_capacity = std::max(capacity, box_capacity * policy_.growth_factor);
+        box_index.clear();
+        box_dir.init(box_capacity, 1);
+        expand_box();
+    }
+
+    /**
+     * @brief 把至多 steps 个旧桶下标中的所有元素迁移到主箱
+     * 
+     * 已迁移的旧桶立即清空并在位图和目录中清除，旧箱在合并完成时一并释放。
+     */
+    void migrate_step(size_type steps = MIGRATE_STEP) {
+        if (!migrating()) return;
+        size_type old_count = migration.box_index.size();
+        for (; steps > 0 && migration.cursor < migration.box_capacity; --steps, ++migration.cursor) {
+            size_type old_keyhash = migration.cursor;
+            for (size_type i = migration.box_dir.next(old_keyhash, 0, old_count); i != box_directory::npos;
+                 i = migration.box_dir.next(old_keyhash, i + 1, old_count)) {
+                box_manager& old_box = *migration.box_index[i];
+                bucket_type& bucket = old_box.box[old_keyhash];
+                for (auto it = bucket.begin(); it != bucket.end(); ++it) {
+                    // 使用存储的哈希值，不重新计算
+                    stored_pair& moving = *it;
+                    place_new(bucket_of(moving.hash, box_capacity), key_probe<Key>{moving.first, moving.hash},
+                              std::move(moving));
+                }
+                bucket.clear();
+                old_box.box_map.set(old_keyhash, false);
+                migration.box_dir.set(old_keyhash, i, false);
+                old_box.used_bucket_count--;
+            }
+        }
+        if (migration.cursor == migration.box_capacity) {
+            // 合并完成，释放所有旧箱
+            box_list.erase(migration.first, box_list.end());
+            migration = migration_state();
+        }
+    }
+
+    /**
+     * @brief 一次迁移完所有尚未迁移的旧桶
+     */
+    void finish_migration() {
+        while (migrating()) migrate_step(migration.box_capacity);
+    }
+
+    /**
+     * @brief 清空并释放稀疏的主箱
+     *
+     * 非空桶最多的主箱以及非空桶占比不低于 COMPACT_THRESHOLD 的主箱保留。
+     * 被释放的箱子中，每个非空桶整体移入第一个该桶为空的保留箱；都不为空时逐个元素并入非空桶最多的主箱。
+     * 元素按存储的哈希值就地移动，不重新计算哈希，也不触发扩展。最后按保留的箱子重建占用目录。
+     * 调用前须已完成渐进式合并。
+     */
+    void drain_sparse_boxes() {
+        if (box_index.size() <= 1) return;
+        size_type anchor = 0;
+        for (size_type i = 1; i < box_index.size(); i++) {
+            if (box_index[i]->used_bucket_count > box_index[anchor]->used_bucket_count) anchor = i;
+        }
+        std::vector<box_manager*> kept;
+        std::vector<box_manager*> drained;
+        for (size_type i = 0; i < box_index.size(); i++) {
+            bool sparse = box_index[i]->used_bucket_count < box_capacity * COMPACT_THRESHOLD;
+            (i == anchor || !sparse ? kept : drained).push_back(box_index[i]);
+        }
+        if (drained.empty()) return;
+
+        box_manager& densest = *box_index[anchor];
+        for (box_manager* from : drained) {
+            for (size_type b = from->box_map.find_next_set(0); b != box_map_type::npos;
+                 b = from->box_map.find_next_set(b + 1)) {
+                bucket_type& bucket = from->box[b];
+                auto target = std::find_if(kept.begin(), kept.end(), [&](box_manager* to) { return !to->box_map.get(b); });
+                if (target != kept.end()) {
+                    (*target)->box[b] = std::move(bucket);
+                    (*target)->box_map.set(b, true);
+                    (*target)->used_bucket_count++;
+                } else {
+                    for (auto it = bucket.begin(); it != bucket.end(); ++it) {
+                        stored_pair& moving = *it;
+                        densest.box[b].emplace_unique(key_probe<Key>{moving.first, moving.hash}, std::move(moving));
+                    }
+                }
+                bucket.clear();
+            }
+        }
+        box_list.remove_if([&](const box_manager& box_mgr) {
+            return std::find(drained.begin(), drained.end(), &box_mgr) != drained.end();
+        });
+
+        box_index = std::move(kept);
+        box_dir.init(box_capacity, box_index.size());
+        for (size_type i = 0; i < box_index.size(); i++) {
+            const box_map_type& map = box_index[i]->box_map;
+            for (size_type b = map.find_next_set(0); b != box_map_type::npos; b = map.find_next_set(b + 1)) {
+                box_dir.set(b, i, true);
+            }
+        }
+    }
+
+    /**
+     * @brief 把所有元素移入一张只有一个桶数为 capacity 的主箱的新表，再替换本表
+     * 
+     * 使用存储的哈希值放入新箱，不重新计算哈希也不比较键；一个箱子放不下时按插入规则追加箱子。
+     * 空表直接重建箱子。
+     */
+    void rebuild(size_type capacity) {
+        if (size_ == 0) {
+            box_capacity = capacity;
+            init_boxes();
+            return;
+        }
+        HashMap rebuilt(0, hash_function_, key_eq_, allocator);
+        rebuilt.box_capacity = capacity;
+        rebuilt.init_boxes();
+        rebuilt.auto_shrink_ = auto_shrink_;
+        rebuilt.policy_ = policy_;
+        rebuilt.transfer_elements<true>(*this);
+        *this = std::move(rebuilt);
+    }
+
+    /**
+     * @brief 即将插入 n 个元素前预留空间
+     * 
+     * 只在 n 不少于当前元素数量时预留：重建的开销与 n 同阶，小范围插入仍按追加箱子的方式增长。
+     */
+    void reserve_for_insert(size_type n) {
+        if (n > 0 && n >= size_) reserve(size_ + n);
+    }
+
+    /**
+     * @brief 开启自动收缩且元素数量低于主箱总桶数的 AUTO_SHRINK_LOAD 时收缩
+     *
+     * 收缩后桶数约为元素数量的 4/3 到 8/3 倍，元素数量须再减少一个数量级才会再次触发，均摊开销为常数。
+     */
+    void shrink_if_sparse() {
+        if (!auto_shrink_ || box_capacity <= calculate_initial_box_capacity(0)) return;
+        if (size_ < box_capacity * box_index.size() * AUTO_SHRINK_LOAD) shrink_to_fit();
+    }
+
+    /**
+     * @brief 在一组共用桶下标的箱子中查找键，只访问目录中置位的箱子
+     */
+    template <typename K>
+    pair_type* find_in_boxes(const std::vector<box_manager*>& index, const box_directory& dir,
+                             size_type keyhash, const key_probe<K>& key) {
+        size_type box_count = index.size();
+        for (size_type i = dir.next(keyhash, 0, box_count); i != box_directory::npos;
+             i = dir.next(keyhash, i + 1, box_count)) {
+            if (auto* found = find_in_bucket(index[i]->box[keyhash], key)) {
+                return found;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief 查找键所在的元素，迁移期间同时检查尚未迁移的旧桶
+     * 
+     * @param key 要查找的键
+     * @param hash 键的32位哈希值
+     * @return 找到的键值对指针，如果未找到则返回nullptr
+     */
+    template <typename K>
+    pair_type* find_node(const K& key, uint32_t hash) {
+        key_probe<K> probe{key, hash};
+        if (auto* found = find_in_boxes(box_index, box_dir, bucket_of(hash, box_capacity), probe)) {
+            return found;
+        }
+        if (migrating()) {
+            size_type old_keyhash = bucket_of(hash, migration.box_capacity);
+            if (old_keyhash >= migration.cursor) {
+                return find_in_boxes(migration.box_index, migration.box_dir, old_keyhash, probe);
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief 删除哈希值为 hash 的键，迁移期间同时检查尚未迁移的旧桶
+     * 
+     * @return true表示找到并删除了键
+     */
+    template <typename K>
+    bool erase_hashed(const K& key, uint32_t hash) {
+        migrate_step();
+
+        key_probe<K> probe{key, hash};
+        bool erased = erase_in_boxes(box_index, box_dir, bucket_of(hash, box_capacity), probe);
+        if (!erased && migrating()) {
+            size_type old_keyhash = bucket_of(hash, migration.box_capacity);
+            if (old_keyhash >= migration.cursor) {
+                erased = erase_in_boxes(migration.box_index, migration.box_dir, old_keyhash, probe);
+            }
+        }
+
+        if (erased) {
+            size_--;
+            shrink_if_sparse();
+        }
+        return erased;
+    }
+
+    /**
+     * @brief 预取哈希值为 hash 的键在占用目录中的掩码
+     */
+    void prefetch_directory(uint32_t hash) const {
+        utils::prefetch(box_dir.word_of(bucket_of(hash, box_capacity)));
+    }
+
+    /**
+     * @brief 预取键在各主箱中的桶
+     * 
+     * 查找只预取目录中 box[keyhash] 非空的箱子；修改时还要预取每个主箱位图中对应的字，
+     * 插入可能放入任意一个主箱，所以修改时预取所有主箱。
+     * 
+     * @param hash 键的32位哈希值
+     * @param for_update 是否为插入/删除预取
+     */
+    void prefetch_buckets(uint32_t hash, bool for_update) const {
+        size_type keyhash = bucket_of(hash, box_capacity);
+        size_type box_count = box_index.size();
+        for (size_type i = for_update ? 0 : box_dir.next(keyhash, 0, box_count); i < box_count;
+             i = for_update ? i + 1 : box_dir.next(keyhash, i + 1, box_count)) {
+            const box_manager& box_mgr = *box_index[i];
+            utils::prefetch(box_mgr.box.data() + keyhash);
+            if (for_update) utils::prefetch(box_mgr.box_map.word_of(keyhash));
+        }
+    }
+
+    /**
+     * @brief 分批处理 keys
+     * 
+     * 每批 BATCH_CHUNK 个键分三个阶段：先算出所有哈希值并预取目录掩码，再按掩码预取各箱子中的桶，
+     * 最后依次调用 resolve(i, hash)。同一批键的缓存未命中互相重叠，而不是逐个串行等待。
+     */
+    template <typename K, typename Resolve>
+    void run_batch(const K* keys, size_type count, bool for_update, Resolve&& resolve) {
+        uint32_t hashes[BATCH_CHUNK];
+        for (size_type base = 0; base < count; base += BATCH_CHUNK) {
+            size_type n = std::min(BATCH_CHUNK, count - base);
+            for (size_type i = 0; i < n; i++) {
+                hashes[i] = hash_key(keys[base + i]);
+                prefetch_directory(hashes[i]);
+            }
+            for (size_type i = 0; i < n; i++) {
+                prefetch_buckets(hashes[i], for_update);
+            }
+            for (size_type i = 0; i < n; i++) {
+                resolve(base + i, hashes[i]);
+            }
+        }
+    }
+
+    /**
+     * @brief 在一组共用桶下标的箱子中删除键
+     * 
+     * @return true表示找到并删除了键
+     */
+    template <typename K>
+    bool erase_in_boxes(std::vector<box_manager*>& index, box_directory& dir,
+                        size_type keyhash, const key_probe<K>& key) {
+        size_type box_count = index.size();
+        for (size_type i = dir.next(keyhash, 0, box_count); i != box_directory::npos;
+             i = dir.next(keyhash, i + 1, box_count)) {
+            box_manager& box_mgr = *index[i];
+            // 根据伪代码: box[keyhash].remove(key); break
+            if (box_mgr.box[keyhash].remove(key)) {
+                if (box_mgr.box[keyhash].size() == 0) {
+                    box_mgr.box_map.set(keyhash, false);
+                    dir.set(keyhash, i, false);
+                    box_mgr.used_bucket_count--;
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 将表中不存在的键值对放入主箱
+     * 
+     * 放入第一个 box[keyhash] 为空的主箱，若所有主箱的该桶都非空则放入最后一个主箱，
+     * 放入最后一个主箱后按负载因子决定是否扩展。不修改 size_。
+     * 
+     * @param keyhash 键在主箱中的桶索引
+     * @param key 新元素的键和哈希值，只在构造之前用于确定桶内位置
+     * @param args 直接在桶中构造元素(stored_pair)的参数
+     * @return 放入后元素的指针
+     */
+    template <typename K, typename... Args>
+    pair_type* place_new(size_type keyhash, const key_probe<K>& key, Args&&... args) {
+        size_type box_count = box_index.size();
+        size_type target = box_dir.next(keyhash, 0, box_count, true);
+        if (target == box_directory::npos) target = box_count - 1;
+
+        box_manager& box_mgr = *box_index[target];
+        pair_type* inserted = box_mgr.box[keyhash].emplace_unique(key, std::forward<Args>(args)...);
+        if (!box_mgr.box_map.get(keyhash)) {
+            box_mgr.box_map.set(keyhash, true);
+            box_dir.set(keyhash, target, true);
+            box_mgr.used_bucket_count++;
+        }
+
+        // 根据伪代码: if 达到负载因子阈值(this.box_list.back())
+        if (target == box_count - 1) grow_if_needed();
+        return inserted;
     }    /**
-     * @brief 在桶中查找元素，使用红黑树的find方法
+     * @brief 单次查找的插入: 键不存在时用 args 构造值并放入主箱
+     * 
+     * @return 元素指针，以及是否发生了插入
+     */
+    template <typename K, typename... Args>
+    std::pair<pair_type*, bool> try_emplace_impl(K&& key, Args&&... args) {
+        migrate_step();
+
+        // 根据伪代码: keyhash = this.hasher(key, 0, this.box_capacity - 1)
+        uint32_t hash = hash_key(key);
+        if (auto* existing = find_node(key, hash)) {
+            return std::make_pair(existing, false);
+        }
+
+        // 根据伪代码: if box[keyhash] is empty，否则插入到最新的box里
+        pair_type* inserted = place_new(bucket_of(hash, box_capacity), key_probe<K>{key, hash}, hash,
+                                        std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+                                        std::forward_as_tuple(std::forward<Args>(args)...));
+        size_++;
+        return std::make_pair(inserted, true);
+    }
+
+    /**
+     * @brief 单次查找的插入或赋值
+     */
+    template <typename K, typename M>
+    std::pair<pair_type*, bool> insert_or_assign_impl(K&& key, M&& value) {
+        return insert_or_assign_hashed(hash_key(key), std::forward<K>(key), std::forward<M>(value));
+    }
+
+    /**
+     * @brief insert_or_assign_impl，键的哈希值 hash 已经算好
+     */
+    template <typename K, typename M>
+    std::pair<pair_type*, bool> insert_or_assign_hashed(uint32_t hash, K&& key, M&& value) {
+        migrate_step();
+
+        // 根据伪代码: else if key in box[keyhash]
+        if (auto* existing = find_node(key, hash)) {
+            // 根据伪代码: box[keyhash][key] = value   # 更新value
+            existing->second = std::forward<M>(value);
+            return std::make_pair(existing, false);
+        }
+
+        pair_type* inserted = place_new(bucket_of(hash, box_capacity), key_probe<K>{key, hash}, hash,
+                                        std::forward<K>(key), std::forward<M>(value));
+        size_++;
+        return std::make_pair(inserted, true);
+    }
+
+    /**
+     * @brief 在桶中查找元素
+     * 
+     * 桶内的比较器可以直接与键比较，不需要构造临时的键值对；哈希值不同的元素不会比较键。
      * 
      * @param bucket 要搜索的桶
-     * @param key 要查找的键
+     * @param key 要查找的键及其哈希值
      * @return 找到的键值对指针，如果未找到则返回nullptr
-     */    pair_type* find_in_bucket(bucket_type& bucket, const key_type& key) {
-        // 使用红黑树的find方法进行高效查找
-        pair_type search_pair;
-        search_pair.first = key;
-        // 使用默认值初始化second部分，因为红黑树只根据键进行比较
-        search_pair.second = mapped_type{};
-        
-        const pair_type* found = bucket.find(search_pair);
-        return const_cast<pair_type*>(found);
-    }/**
-     * @brief 更新键值对的值
+     */    template <typename K>
+    pair_type* find_in_bucket(bucket_type& bucket, const key_probe<K>& key) {
+        return bucket.find(key);
+    }
+
+    /**
+     * @brief 把 other 的所有元素放入本表，使用存储的哈希值，不重新计算哈希也不查找
+     * 
+     * 本表中不能已有 other 中的键。Move 为 true 时移动元素，之后 other 须被清空。
+     */
+    template <bool Move, typename Map>
+    void transfer_elements(Map& other) {
+        for (auto& box_mgr : other.box_list) {
+            for (size_type i = box_mgr.box_map.find_next_set(0); i != box_map_type::npos;
+                 i = box_mgr.box_map.find_next_set(i + 1)) {
+                for (auto it = box_mgr.box[i].begin(); it != box_mgr.box[i].end(); ++it) {
+                    stored_pair& stored = *it;
+                    key_probe<Key> probe{stored.first, stored.hash};
+                    if constexpr (Move) place_new(bucket_of(stored.hash, box_capacity), probe, std::move(stored));
+                    else place_new(bucket_of(stored.hash, box_capacity), probe, static_cast<const stored_pair&>(stored));
+                    size_++;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief 按箱逐桶复制没有在合并的 other，保持相同的箱子和桶布局
+     * 
+     * 每个非空桶整体复制：有序数组逐个拷贝，红黑树由已排好序的元素线性构造，
+     * 不计算哈希、不比较键、不逐个插入。本表须尚未创建任何箱子。
+     */
+    void copy_boxes(const HashMap& other) {
+        for (const box_manager& src : other.box_list) {
+            box_manager& box_mgr = box_list.emplace_back(box_capacity, key_eq_, allocator);
+            for (size_type i = src.box_map.find_next_set(0); i != box_map_type::npos;
+                 i = src.box_map.find_next_set(i + 1)) {
+                box_mgr.box[i] = src.box[i];
+            }
+            box_mgr.box_map = src.box_map;
+            box_mgr.used_bucket_count = src.used_bucket_count;
+            box_index.push_back(&box_mgr);
+        }
+        box_dir = other.box_dir;
+        size_ = other.size_;
+    }
+
+    /**
+     * @brief 箱内元素的键值对以 std::pair<const Key, Value> 的形式交给迭代器
+     */
+    static const_pair_type* as_const_pair(pair_type* p) {
+        return reinterpret_cast<const_pair_type*>(p);
+    }
+
+    /**
+     * @brief 把主箱与旧箱的桶下标空间划分为区间，在线程池中并行处理
+     * 
+     * 主箱占 [0, main_span)，main_span 为主箱桶数向上取整到 PARALLEL_GRAIN 的倍数；旧箱占其后的 migration.box_capacity 个下标。
+     * 区间边界都是 PARALLEL_GRAIN 的倍数，因此任务之间不共享桶、位图的字或目录的字。
+     * visit(index, dir, first, last) 处理一组共用桶下标的箱子中 [first, last) 的桶。
+     */
+    template <typename Visit>
+    void parallel_buckets(utils::work_stealing_pool& pool, Visit&& visit) {
+        size_type main_span = (box_capacity + PARALLEL_GRAIN - 1) / PARALLEL_GRAIN * PARALLEL_GRAIN;
+        size_type old_span = migrating() ? migration.box_capacity : 0;
+        pool.parallel_for(0, main_span + old_span, PARALLEL_GRAIN, [&](size_type first, size_type last) {
+            if (first < main_span) {
+                visit(box_index, box_dir, first, std::min(last, box_capacity));
+            } else {
+                visit(migration.box_index, migration.box_dir, first - main_span, last - main_span);
+            }
+        });
+    }
+
+    /**
+     * @brief 分配器能否在多个线程中同时使用。只对 std::allocator 成立，其他分配器的批量构建在调用线程中完成
+     */
+    static constexpr bool allocator_is_thread_safe =
+        std::is_same<Allocator, std::allocator<typename std::allocator_traits<Allocator>::value_type>>::value;
+
+    /**
+     * @brief parallel_erase_if 的实现：在 pool 中按桶区间删除使 pred 为真的元素
+     * 
+     * 每个任务只修改自己区间内的桶、位图和目录，非空桶计数在任务结束时合并。
+     */
+    template <typename Pred>
+    size_type erase_if_in(Pred& pred, utils::work_stealing_pool& pool) {
+        std::atomic<size_type> total{0};
+
+        std::mutex count_mutex;  // 保护各箱的 used_bucket_count
+        parallel_buckets(pool, [&](std::vector<box_manager*>& index, box_directory& dir, size_type first, size_type last) {
+            size_type local = 0;
+            std::vector<size_type> emptied(index.size(), 0);
+            for_each_bucket(index, first, last, [&](box_manager& box_mgr, size_type i, size_type b) {
+                bucket_type& bucket = box_mgr.box[b];
+                local += bucket.remove_if([&](stored_pair& elem) {
+                    return pred(static_cast<const const_pair_type&>(*as_const_pair(&elem)));
+                });
+                if (bucket.size() == 0) {
+                    box_mgr.box_map.set(b, false);
+                    dir.set(b, i, false);
+                    emptied[i]++;
+                }
+            });
+            if (local) {
+                std::lock_guard<std::mutex> lock(count_mutex);
+                for (size_type i = 0; i < index.size(); i++) index[i]->used_bucket_count -= emptied[i];
+            }
+            total.fetch_add(local, std::memory_order_relaxed);
+        });
+        size_ -= total.load(std::memory_order_relaxed);
+        shrink_if_sparse();
+        return total.load(std::memory_order_relaxed);
+    }
+
+
+    /**
+     * @brief 空表从随机访问范围批量构建
+     * 
+     * 1. 按输入长度一次性确定主箱桶数，重建为一个主箱；
+     * 2. 并行计算所有键的哈希值；
+     * 3. 按桶下标把元素下标划分到宽 PARALLEL_GRAIN 个桶的分区中（各输入块先统计直方图，再按前缀和分散，保持输入顺序）；
+     * 4. 各分区由不同线程填充，分区之间不共享桶、位图的字或目录的字，不需要加锁。
+     * 与逐个 insert 的结果相同：重复的键以范围中最后一次出现的值为准。
+     */
+    template <typename RandomIt>
+    void bulk_build(RandomIt first, size_type n, utils::work_stealing_pool& pool) {
+        size_type required = calculate_initial_box_capacity(n);
+        if (required > box_capacity) box_capacity = required;
+        init_boxes();
+
+        std::vector<uint32_t> hashes(n);
+        pool.parallel_for(0, n, PARALLEL_GRAIN, [&](size_type lo, size_type hi) {
+            for (size_type i = lo; i < hi; i++) {
+                const Key& key = first[i].first;
+                hashes[i] = hash_key(key);
+            }
+        });
+
+        size_type capacity = box_capacity;
+        size_type partitions = (capacity + PARALLEL_GRAIN - 1) / PARALLEL_GRAIN;
+        size_type blocks = std::min<size_type>((n + PARALLEL_GRAIN - 1) / PARALLEL_GRAIN, pool.concurrency() * 4);
+        size_type block_size = (n + blocks - 1) / blocks;
+        auto partition_of = [&](size_type i) { return bucket_of(hashes[i], capacity) / PARALLEL_GRAIN; };
+
+        // 每个输入块的分区直方图，前缀和之后变为该块在每个分区中的写入位置
+        std::vector<size_type> offsets(blocks * partitions, 0);
+        pool.parallel_for(0, blocks, 1, [&](size_type lo, size_type hi) {
+            for (size_type b = lo; b < hi; b++) {
+                size_type* counts = offsets.data() + b * partitions;
+                for (size_type i = b * block_size, end = std::min(n, (b + 1) * block_size); i < end; i++) counts[partition_of(i)]++;
+            }
+        });
+        std::vector<size_type> partition_begin(partitions + 1);
+        size_type total = 0;
+        for (size_type p = 0; p < partitions; p++) {
+            partition_begin[p] = total;
+            for (size_type b = 0; b < blocks; b++) {
+                size_type count = offsets[b * partitions + p];
+                offsets[b * partitions + p] = total;
+                total += count;
+            }
+        }
+        partition_begin[partitions] = total;
+
+        std::vector<size_type> order(n);
+        pool.parallel_for(0, blocks, 1, [&](size_type lo, size_type hi) {
+            for (size_type b = lo; b < hi; b++) {
+                size_type* cursor = offsets.data() + b * partitions;
+                for (size_type i = b * block_size, end = std::min(n, (b + 1) * block_size); i < end; i++) order[cursor[partition_of(i)]++] = i;
+            }
+        });
+
+        box_manager& box_mgr = *box_index.front();
+        std::atomic<size_type> inserted{0};
+        std::atomic<size_type> used{0};
+        pool.parallel_for(0, partitions, 1, [&](size_type lo, size_type hi) {
+            size_type local_inserted = 0;
+            size_type local_used = 0;
+            for (size_type k = partition_begin[lo]; k < partition_begin[hi]; k++) {
+                size_type i = order[k];
+                uint32_t hash = hashes[i];
+                size_type keyhash = bucket_of(hash, capacity);
+                bucket_type& bucket = box_mgr.box[keyhash];
+                const Key& key = first[i].first;
+                key_probe<Key> probe{key, hash};
+                if (pair_type* existing = bucket.find(probe)) {
+                    existing->second = first[i].second;
+                    continue;
+                }
+                bucket.emplace_unique(probe, hash, key, first[i].second);
+                local_inserted++;
+                if (!box_mgr.box_map.get(keyhash)) {
+                    box_mgr.box_map.set(keyhash, true);
+                    box_dir.set(keyhash, 0, true);
+                    local_used++;
+                }
+            }
+            inserted.fetch_add(local_inserted, std::memory_order_relaxed);
+            used.fetch_add(local_used, std::memory_order_relaxed);
+        });
+        box_mgr.used_bucket_count = used.load(std::memory_order_relaxed);
+        size_ = inserted.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 扫描下标为 stride 倍数的主箱桶下标，把桶一级的统计累加到 stats
      * 
-     * @param oldpair 旧键值对指针
-     * @param new_value 新的值
+     * 每个桶下标依次访问占用目录中置位的主箱，第 r 个非空箱子中的元素命中时访问 r 个箱子。
+     * 合并期间，旧桶下标 ob 在它覆盖的第一个主箱桶下标 (ob << shift) 被扫描时一并统计，
+     * 旧箱中的元素命中时先访问其哈希值对应的主箱桶下标上的所有非空箱子。
+     * stride 须为2的幂，保证抽样的主箱桶下标和旧桶下标互相对应。
+     */
+    void collect_stats(utils::map_stats& stats, size_type stride) const {
+        size_type main_count = box_index.size();
+        size_type old_count = migration.box_index.size();
+        size_type shift = 0;
+        if (migrating()) {
+            while ((migration.box_capacity << shift) < box_capacity) shift++;
+        }
+
+        for (size_type b = 0; b < box_capacity; b += stride) {
+            size_type rank = 0;
+            for (size_type i = box_dir.next(b, 0, main_count); i != box_directory::npos;
+                 i = box_dir.next(b, i + 1, main_count)) {
+                const bucket_type& bucket = box_index[i]->box[b];
+                rank++;
+                stats.add_bucket(i, b, bucket.size(), bucket.tree_height());
+                stats.hit_boxes += bucket.size() * rank;
+            }
+
+            size_type miss_cost = rank;
+            size_type ob = b >> shift;
+            if (migrating() && ob >= migration.cursor) {
+                miss_cost += migration.box_dir.count(ob, old_count);
+                if ((ob << shift) == b) {
+                    size_type old_rank = 0;
+                    for (size_type j = migration.box_dir.next(ob, 0, old_count); j != box_directory::npos;
+                         j = migration.box_dir.next(ob, j + 1, old_count)) {
+                        const bucket_type& bucket = migration.box_index[j]->box[ob];
+                        old_rank++;
+                        stats.add_bucket(main_count + j, ob, bucket.size(), bucket.tree_height());
+                        for (const stored_pair& elem : bucket) {
+                            stats.hit_boxes += box_dir.count(bucket_of(elem.hash, box_capacity), main_count) + old_rank;
+                        }
+                    }
+                }
+            }
+            stats.add_position(miss_cost);
+        }
+    }
+
+    /**
+     * @brief 对一组箱子中 [first, last) 内每个非空桶调用 f(box_manager&, box下标, 桶下标)
      */
-    void update_node_value(pair_type *oldpair, const mapped_type& new_value) {
-        oldpair->second = new_value;
+    template <typename F>
+    static void for_each_bucket(std::vector<box_manager*>& index, size_type first, size_type last, F&& f) {
+        for (size_type i = 0; i < index.size(); i++) {
+            box_manager& box_mgr = *index[i];
+            for (size_type b = box_mgr.box_map.find_next_set(first, last); b != box_map_type::npos;
+                 b = box_mgr.box_map.find_next_set(b + 1, last)) {
+                f(box_mgr, i, b);
+            }
+        }
     }
 
 public:     // 公共函数
@@ -160,9 +1050,9 @@ public:     // 公共函数
     class iterator : public utils::_iterator<const_pair_type*, iterator> {
       public:
         HashMap* hashmap_ptr;
-        typename std::list<box_manager>::iterator current_box;
+        typename box_list_type::iterator current_box;
         size_type current_bucket_index;
-        typename utils::rbtree<pair_type>::iterator rbtree_iter;
+        typename bucket_type::iterator bucket_iter;
         bool is_end_iterator;
         
     public:
@@ -177,13 +1067,13 @@ public:     // 公共函数
                 // 结束迭代器应该有一致的ptr值
                 this->ptr = nullptr;
             }
-        }        void goback() override {
+        }        void goback() {
             if (is_end_iterator || !hashmap_ptr) return;
             
             // 尝试移动到当前桶中的下一个元素
-            ++rbtree_iter;
-            if (rbtree_iter != current_box->box[current_bucket_index].end()) {
-                this->ptr = reinterpret_cast<const_pair_type*>(&(*rbtree_iter));
+            ++bucket_iter;
+            if (bucket_iter != current_box->box[current_bucket_index].end()) {
+                this->ptr = as_const_pair(&(*bucket_iter));
                 return;
             }
             
@@ -192,14 +1082,14 @@ public:     // 公共函数
             find_next_valid_element();
         }
 
-        void goback(size_t n) override {
+        void goback(size_t n) {
             for (size_t i = 0; i < n; ++i) goback();
-        }        void gofront() override {
+        }        void gofront() {
             if (!hashmap_ptr || is_end_iterator) return;
               // 尝试移动到当前树中的上一个元素
-            if (rbtree_iter != current_box->box[current_bucket_index].begin()) {
-                --rbtree_iter;
-                this->ptr = reinterpret_cast<const_pair_type*>(&(*rbtree_iter));
+            if (bucket_iter != current_box->box[current_bucket_index].begin()) {
+                --bucket_iter;
+                this->ptr = as_const_pair(&(*bucket_iter));
                 return;
             }
             
@@ -207,21 +1097,19 @@ public:     // 公共函数
             find_previous_valid_element();
         }
 
-        void gofront(size_t n) override {
+        void gofront(size_t n) {
             for (size_t i = 0; i < n; ++i) gofront();
         }
 
       private:        void find_next_valid_element() {
             while (current_box != hashmap_ptr->box_list.end()) {
-                // 在当前箱中搜索下一个元素
-                for (; current_bucket_index < hashmap_ptr->box_capacity; ++current_bucket_index) {
-                    if (current_box->box_map.get(current_bucket_index) && 
-                        current_box->box[current_bucket_index].size() > 0) {                        rbtree_iter = current_box->box[current_bucket_index].begin();
-                        if (rbtree_iter != current_box->box[current_bucket_index].end()) {
-                            this->ptr = reinterpret_cast<const_pair_type*>(&(*rbtree_iter));
-                            return;
-                        }
-                    }
+                // 借助位图直接跳到当前箱中下一个非空桶
+                size_type next = current_box->box_map.find_next_set(current_bucket_index);
+                if (next != box_map_type::npos) {
+                    current_bucket_index = next;
+                    bucket_iter = current_box->box[current_bucket_index].begin();
+                    this->ptr = as_const_pair(&(*bucket_iter));
+                    return;
                 }
 
                 // 移动到下一个箱
@@ -235,14 +1123,14 @@ public:     // 公共函数
             // 向后搜索上一个元素
             while (true) {
                 // 尝试当前箱中的上一个桶
-                if (current_bucket_index > 0) {
-                    --current_bucket_index;
-                    if (current_box->box_map.get(current_bucket_index) && 
-                        current_box->box[current_bucket_index].size() > 0) {                        rbtree_iter = current_box->box[current_bucket_index].end();
-                        --rbtree_iter; // 移动到最后一个元素
-                        this->ptr = reinterpret_cast<const_pair_type*>(&(*rbtree_iter));
-                        return;
-                    }
+                size_type prev = current_bucket_index > 0
+                               ? current_box->box_map.find_prev_set(current_bucket_index - 1) : box_map_type::npos;
+                if (prev != box_map_type::npos) {
+                    current_bucket_index = prev;
+                    bucket_iter = current_box->box[current_bucket_index].end();
+                    --bucket_iter; // 移动到最后一个元素
+                    this->ptr = as_const_pair(&(*bucket_iter));
+                    return;
                 } else {
                     // 移动到上一个箱
                     if (current_box == hashmap_ptr->box_list.begin()) {
@@ -250,29 +1138,47 @@ public:     // 公共函数
                         return;
                     }
                     --current_box;
-                    current_bucket_index = hashmap_ptr->box_capacity;
+                    current_bucket_index = current_box->capacity;
                 }
             }
         }};    // const迭代器类型
     using const_iterator = iterator;
 
+private:
+    /**
+     * @brief 为指向箱内元素的指针创建迭代器
+     */
+    iterator make_iterator(pair_type* found) {
+        iterator result;
+        result.hashmap_ptr = this;
+        result.is_end_iterator = false;
+        result.set_ptr(as_const_pair(found));
+        return result;
+    }
+
+public:
+
     /**
      * @brief 带预估大小的构造函数
      * 
      * 根据预估的元素数量计算合适的初始桶大小，以减少后续扩展操作。
      * 
      * @param estimated_size 预估的元素数量，默认为0
+     * @param hash 哈希器
+     * @param equal 键相等比较器
+     * @param alloc 内存分配器
      */
-    explicit HashMap(size_type estimated_size = 0) 
-        : size_(0) {
+    explicit HashMap(size_type estimated_size = 0, const hasher_type& hash = hasher_type(),
+                     const key_equal_type& equal = key_equal_type(), const Allocator& alloc = Allocator())
+        : allocator(alloc), box_list(allocator), size_(0), hash_function_(hash), key_eq_(equal) {
         this->box_capacity = calculate_initial_box_capacity(estimated_size);
-        this->box_list.emplace_back(this->box_capacity);
+        this->init_boxes();
     }
 
     /**
      * @brief 范围构造函数
      * 
-     * 从迭代器范围构造HashMap。
+     * 从迭代器范围构造HashMap。前向迭代器范围按 std::distance 确定桶数，不必传入 estimated_size。
      * 
      * @tparam InputIt 输入迭代器类型
      * @param first 范围开始迭代器
@@ -281,9 +1187,7 @@ public:     // 公共函数
      */
     template<typename InputIt>
     HashMap(InputIt first, InputIt last, size_type estimated_size = 0) : HashMap(estimated_size) {
-        for (auto it = first; it != last; ++it) {
-            insert(it->first, it->second);
-        }
+        insert(first, last);
     }
 
     /**
@@ -293,7 +1197,8 @@ public:     // 公共函数
      * 
      * @param init 初始化列表
      * @param estimated_size 预估元素数量
-     */    HashMap(std::initializer_list<pair_type> init, size_type estimated_size = 0) : HashMap(estimated_size) {
+     */    HashMap(std::initializer_list<pair_type> init, size_type estimated_size = 0)
+        : HashMap(std::max<size_type>(estimated_size, init.size())) {
         for (const auto& pair : init) {
             insert(pair.first, pair.second);
         }
@@ -305,18 +1210,17 @@ public:     // 公共函数
      * 创建另一个HashMap的深度拷贝。
      * 
      * @param other 要拷贝的HashMap
-     */    HashMap(const HashMap& other) : box_capacity(other.box_capacity), size_(0), hasher(other.hasher), allocator(other.allocator) {
-        box_list.emplace_back(box_capacity);
-        
-        // 复制所有元素
-        for (const auto& box_mgr : other.box_list) {
-            for (size_type i = 0; i < box_capacity; ++i) {
-                if (box_mgr.box_map.get(i)) {
-                    for (auto it = box_mgr.box[i].begin(); it != box_mgr.box[i].end(); ++it) {
-                        insert(it->first, it->second);
-                    }
-                }
-            }
+     */    HashMap(const HashMap& other)
+        : allocator(std::allocator_traits<Allocator>::select_on_container_copy_construction(other.allocator)),
+          box_list(allocator), box_capacity(other.box_capacity), size_(0),
+          auto_shrink_(other.auto_shrink_), policy_(other.policy_),
+          hash_function_(other.hash_function_), key_eq_(other.key_eq_) {
+        if (other.migrating()) {
+            // 复制所有元素，复用存储的哈希值
+            init_boxes();
+            transfer_elements<false>(other);
+        } else {
+            copy_boxes(other);
         }
     }/** 
      * @brief 移动构造函数
@@ -324,16 +1228,22 @@ public:     // 公共函数
      * 通过移动语义从另一个HashMap构造，避免不必要的拷贝。
      * 
      * @param other 要移动的HashMap
-     */    HashMap(HashMap&& other) noexcept        : box_list(std::move(other.box_list)),
+     */    HashMap(HashMap&& other) noexcept
+        : allocator(other.allocator),
+          box_list(std::move(other.box_list)),
+          box_index(std::move(other.box_index)),
+          box_dir(std::move(other.box_dir)),
+          migration(std::move(other.migration)),
           box_capacity(other.box_capacity),
           size_(other.size_),
-          hasher(std::move(other.hasher)),
-          allocator(std::move(other.allocator)) {
+          auto_shrink_(other.auto_shrink_),
+          policy_(other.policy_),
+          hash_function_(other.hash_function_),
+          key_eq_(other.key_eq_) {
           // 将其他对象重置为空状态
-        other.box_list.clear();
         other.box_capacity = 16;
         other.size_ = 0;
-        other.box_list.emplace_back(other.box_capacity);
+        other.init_boxes();
     }
 
     /**
@@ -355,20 +1265,46 @@ public:     // 公共函数
      * @brief 移动赋值操作符
      * 
      * 通过移动语义赋值，提高性能。
+     * 分配器不随移动赋值传播（如 std::pmr::polymorphic_allocator）且两者不相等时，
+     * 保留当前分配器并逐个复制元素；这时需要从当前分配器分配内存，分配失败会抛出异常，因此不是 noexcept。
      * 
      * @param other 要移动的HashMap
      * @return 当前对象的引用
-     */    HashMap& operator=(HashMap&& other) noexcept {        if (this != &other) {
+     */    HashMap& operator=(HashMap&& other) noexcept(
+            std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+            std::allocator_traits<Allocator>::is_always_equal::value) {
+        if constexpr (!std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value) {
+            if (this != &other && allocator != other.allocator) {
+                hash_function_ = other.hash_function_;
+                key_eq_ = other.key_eq_;
+                box_capacity = other.box_capacity;
+                auto_shrink_ = other.auto_shrink_;
+                policy_ = other.policy_;
+                size_ = 0;
+                init_boxes();
+                transfer_elements<true>(other);
+                other.clear();
+                return *this;
+            }
+        }
+        if (this != &other) {
             box_list = std::move(other.box_list);
+            box_index = std::move(other.box_index);
+            box_dir = std::move(other.box_dir);
+            migration = std::move(other.migration);
             box_capacity = other.box_capacity;
             size_ = other.size_;
-            hasher = std::move(other.hasher);
-            allocator = std::move(other.allocator);
+            auto_shrink_ = other.auto_shrink_;
+            policy_ = other.policy_;
+            hash_function_ = other.hash_function_;
+            key_eq_ = other.key_eq_;
+            if constexpr (std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value) {
+                allocator = other.allocator;
+            }
               // 将其他对象重置为空状态
-            other.box_list.clear();
             other.box_capacity = 16;
             other.size_ = 0;
-            other.box_list.emplace_back(other.box_capacity);
+            other.init_boxes();
         }
         return *this;
     }    /**
@@ -383,122 +1319,92 @@ public:     // 公共函数
     /**
      * @brief 按照伪代码算法插入元素
      * 
+     * 先在主箱（以及迁移期间尚未迁移的旧桶）中查找键，存在则更新值；
+     * 否则插入到第一个 box[keyhash] 为空的主箱，若所有主箱的该桶都非空则插入到最后一个主箱。
+     * 迁移期间每次插入会顺带迁移一部分旧桶，之前取得的迭代器可能失效。
+     * 
      * @param key 要插入的键
      * @param value 要插入的值
      * @return pair<iterator, bool> 其中iterator指向元素，bool表示是否发生了插入
-     */    std::pair<iterator, bool> insert(const Key& key, const Value& value) {
-        // 根据伪代码: keyhash = this.hasher(key, 0, this.box_capacity - 1)
-        size_type keyhash = get_bucket_index(key);
-        
-        // 根据伪代码: for box : this.box_list
-        for (auto& box_mgr : box_list) {
-            // 根据伪代码: if box[keyhash] is empty
-            if (!box_mgr.box_map.get(keyhash)) {                // 插入新元素
-                pair_type new_pair;
-                new_pair.first = key;                new_pair.second = value;
-                box_mgr.box[keyhash].push(std::move(new_pair));
-                box_mgr.box_map.set(keyhash, true);
-                box_mgr.used_bucket_count++;                size_++;
-                
-                // 创建指向插入元素的迭代器
-                iterator result;
-                result.hashmap_ptr = this;
-                result.is_end_iterator = false;
-                result.set_ptr(reinterpret_cast<const_pair_type*>(find_in_bucket(box_mgr.box[keyhash], key)));
-                return std::make_pair(result, true);
-            }
-            // 根据伪代码: else if key in box[keyhash]
-            else if (auto* existing = find_in_bucket(box_mgr.box[keyhash], key)) {                // 根据伪代码: box[keyhash][key] = value   # 更新value
-                update_node_value(existing, value);
-                  // 创建指向现有元素的迭代器
-                iterator result;
-                result.hashmap_ptr = this;
-                result.is_end_iterator = false;
-                result.set_ptr(reinterpret_cast<const_pair_type*>(existing));
-                return std::make_pair(result, false);
-            }            // 根据伪代码: else if box == this.box_list.back()
-            else if (&box_mgr == &box_list.back()) {
-                // 根据伪代码: box[keyhash][key] = value   # 插入到最新的box里
-                pair_type new_pair;                new_pair.first = key;
-                new_pair.second = value;
-                box_mgr.box[keyhash].push(std::move(new_pair));
-                size_++;
-                
-                // 创建指向插入元素的迭代器
-                iterator result;
-                result.hashmap_ptr = this;
-                result.is_end_iterator = false;
-                result.set_ptr(reinterpret_cast<const_pair_type*>(find_in_bucket(box_mgr.box[keyhash], key)));
-                
-                // 根据伪代码: if 达到负载因子阈值(this.box_list.back())
-                if (should_expand()) {
-                    // 根据伪代码: this.box_list.push_back(new box)
-                    expand_box();
-                }
-                
-                return std::make_pair(result, true);
-            }
-        }
-        
-        // 如果box_list不为空则永远不应该到达这里
-        return std::make_pair(end(), false);
-    }    // =====================================================================================
+     */
+    std::pair<iterator, bool> insert(const Key& key, const Value& value) {
+        return insert_or_assign(key, value);
+    }
+
+    /**
+     * @brief 插入键值对（右值版本），键已存在时移动赋值
+     */
+    std::pair<iterator, bool> insert(Key&& key, Value&& value) {
+        return insert_or_assign(std::move(key), std::move(value));
+    }
+
+    /**
+     * @brief 键不存在时用 args 就地构造值并插入，键已存在时不做任何事（也不移动 key 和 args）
+     * 
+     * 只计算一次哈希、只查找一次。
+     * 
+     * @return pair<iterator, bool> 其中iterator指向元素，bool表示是否发生了插入
+     */
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        auto result = try_emplace_impl(key, std::forward<Args>(args)...);
+        return std::make_pair(make_iterator(result.first), result.second);
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) {
+        auto result = try_emplace_impl(std::move(key), std::forward<Args>(args)...);
+        return std::make_pair(make_iterator(result.first), result.second);
+    }
+
+    /**
+     * @brief 键存在时把 value 赋给它的值，否则插入
+     * 
+     * 只计算一次哈希、只查找一次。
+     * 
+     * @return pair<iterator, bool> 其中iterator指向元素，bool表示是否发生了插入
+     */
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, M&& value) {
+        auto result = insert_or_assign_impl(key, std::forward<M>(value));
+        return std::make_pair(make_iterator(result.first), result.second);
+    }
+
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(Key&& key, M&& value) {
+        auto result = insert_or_assign_impl(std::move(key), std::forward<M>(value));
+        return std::make_pair(make_iterator(result.first), result.second);
+    }
+
+    // =====================================================================================
     // 搜索操作
     // =====================================================================================
     
     /**
      * @brief 通过键查找元素（根据伪代码逻辑实现）
+     * 
+     * 只在占用目录中 box[keyhash] 非空的箱子里查找，未命中时不访问任何箱子。
+     * 查找不推进渐进式合并，迁移期间会同时检查主箱和尚未迁移的旧桶。
      */
-    iterator find(const Key& key) {
-        // 根据伪代码: keyhash = this.hasher(key, 0, this.box_capacity - 1)
-        size_type keyhash = get_bucket_index(key);
-        
-        // 根据伪代码: for box : this.box_list
-        for (auto& box_mgr : box_list) {
-            // 根据伪代码: if key in box[keyhash]
-            if (box_mgr.box_map.get(keyhash)) {
-                auto* found = find_in_bucket(box_mgr.box[keyhash], key);                if (found) {                    // 创建指向此元素的迭代器
-                    iterator result;
-                    result.hashmap_ptr = this;
-                    result.is_end_iterator = false;
-                    result.set_ptr(reinterpret_cast<const_pair_type*>(found));
-                    return result;
-                }
-            }
+    template <typename K = key_type>
+    iterator find(const key_arg<K>& key) {
+        if (auto* found = find_node(key, hash_key(key))) {
+            return make_iterator(found);
         }
         
         // 根据伪代码: return not found
         return end();
-    }    /**
+    }
+
+    /**
      * @brief 通过键删除元素（根据伪代码逻辑实现）
      */
-    bool erase(const Key& key) {
-        // 根据伪代码: keyhash = this.hasher(key, 0, this.box_capacity - 1)
-        size_type keyhash = get_bucket_index(key);
-        
-        // 根据伪代码: for box : this.box_list
-        for (auto& box_mgr : box_list) {
-            // 根据伪代码: if key in box[keyhash]
-            if (box_mgr.box_map.get(keyhash)) {
-                pair_type search_pair;
-                search_pair.first = key;
-                // 在删除前检查元素是否存在
-                if (find_in_bucket(box_mgr.box[keyhash], key)) {
-                    // 删除元素
-                    box_mgr.box[keyhash].remove(std::move(search_pair));
-                    // 根据伪代码: box[keyhash].remove(key); break
-                    if (box_mgr.box[keyhash].size() == 0) {
-                        box_mgr.box_map.set(keyhash, false);
-                        box_mgr.used_bucket_count--;
-                    }
-                    size_--;
-                    return true;
-                }
-            }
-        }
-        
-        return false;
-    }    /**
+    template <typename K = key_type>
+    bool erase(const key_arg<K>& key) {
+        return erase_hashed(key, hash_key(key));
+    }
+
+    /**
      * @brief 通过迭代器删除元素
      */
     iterator erase(iterator it) {
@@ -538,14 +1444,235 @@ public:     // 公共函数
      * @param key 要访问的键
      * @return 对应值的引用
      */    mapped_type& operator[](const Key& key) {
-        // 首先尝试查找现有的键
-        auto it = find(key);        if (it != end()) {
-            return it->second;
+        return try_emplace_impl(key).first->second;
+    }
+
+    mapped_type& operator[](Key&& key) {
+        return try_emplace_impl(std::move(key)).first->second;
+    }
+
+    // =====================================================================================
+    // 批量操作
+    // =====================================================================================
+
+    /**
+     * @brief 批量查找
+     * 
+     * 结果与逐个调用 find 相同。每批键先全部计算哈希值，再预取目录掩码和桶，最后逐个查找，
+     * 各个键的缓存未命中可以重叠，适合大表上的随机查找。
+     * 
+     * @param keys 要查找的键，共 count 个
+     * @param count 键的数量
+     * @param results 输出，results[i] 为 keys[i] 的迭代器，未找到时为 end()
+     */
+    template <typename K = key_type>
+    void find_batch(const key_arg<K>* keys, size_type count, iterator* results) {
+        run_batch(keys, count, false, [&](size_type i, uint32_t hash) {
+            auto* found = find_node(keys[i], hash);
+            results[i] = found ? make_iterator(found) : end();
+        });
+    }
+
+    /**
+     * @brief 批量插入，与按顺序逐个调用 insert(keys[i], values[i]) 等价
+     * 
+     * @param inserted 可选输出，inserted[i] 表示 keys[i] 是否为新插入（false 表示更新了已有的值）
+     */
+    void insert_batch(const Key* keys, const Value* values, size_type count, bool* inserted = nullptr) {
+        run_batch(keys, count, true, [&](size_type i, uint32_t hash) {
+            bool fresh = insert_or_assign_hashed(hash, keys[i], values[i]).second;
+            if (inserted) inserted[i] = fresh;
+        });
+    }
+
+    /**
+     * @brief 批量删除，与按顺序逐个调用 erase(keys[i]) 等价
+     * 
+     * @param erased 可选输出，erased[i] 表示 keys[i] 是否被删除
+     * @return 删除的元素个数
+     */
+    template <typename K = key_type>
+    size_type erase_batch(const key_arg<K>* keys, size_type count, bool* erased = nullptr) {
+        size_type total = 0;
+        run_batch(keys, count, true, [&](size_type i, uint32_t hash) {
+            bool removed = erase_hashed(keys[i], hash);
+            if (removed) total++;
+            if (erased) erased[i] = removed;
+        });
+        return total;
+    }
+
+    // =====================================================================================
+    // 并行操作
+    // =====================================================================================
+
+    /**
+     * @brief 并行地对每个元素调用 f(value_type&)
+     * 
+     * 主箱和旧箱的桶下标空间被划分为若干区间，由线程池中的线程分别处理。
+     * 不同的桶不共享元素或红黑树节点，f 可以修改值，但会被多个线程同时调用，且不能访问本表；
+     * 调用期间其他线程也不能访问本表。
+     * 
+     * @param pool 执行任务的线程池，默认为进程内共享的线程池
+     */
+    template <typename F>
+    void parallel_for_each(F f, utils::work_stealing_pool& pool = utils::work_stealing_pool::shared()) {
+        parallel_buckets(pool, [&](std::vector<box_manager*>& index, box_directory&, size_type first, size_type last) {
+            for_each_bucket(index, first, last, [&](box_manager& box_mgr, size_type, size_type b) {
+                for (stored_pair& elem : box_mgr.box[b]) f(*as_const_pair(&elem));
+            });
+        });
+    }
+
+    /**
+     * @brief 并行地统计使 pred(const value_type&) 为真的元素个数
+     */
+    template <typename Pred>
+    size_type parallel_count_if(Pred pred, utils::work_stealing_pool& pool = utils::work_stealing_pool::shared()) const {
+        std::atomic<size_type> total{0};
+        // 只读取，借用非const的划分逻辑
+        const_cast<HashMap*>(this)->parallel_buckets(pool,
+            [&](std::vector<box_manager*>& index, box_directory&, size_type first, size_type last) {
+                size_type local = 0;
+                for_each_bucket(index, first, last, [&](box_manager& box_mgr, size_type, size_type b) {
+                    for (stored_pair& elem : box_mgr.box[b]) local += pred(static_cast<const const_pair_type&>(*as_const_pair(&elem))) ? 1 : 0;
+                });
+                total.fetch_add(local, std::memory_order_relaxed);
+            });
+        return total.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 并行地把每个元素的值替换为 f(const value_type&) 的返回值
+     */
+    template <typename F>
+    void parallel_transform_values(F f, utils::work_stealing_pool& pool = utils::work_stealing_pool::shared()) {
+        parallel_buckets(pool, [&](std::vector<box_manager*>& index, box_directory&, size_type first, size_type last) {
+            for_each_bucket(index, first, last, [&](box_manager& box_mgr, size_type, size_type b) {
+                for (stored_pair& elem : box_mgr.box[b]) elem.second = f(static_cast<const const_pair_type&>(*as_const_pair(&elem)));
+            });
+        });
+    }
+
+    /**
+     * @brief 并行地删除所有使 pred(const value_type&) 为真的元素
+     * 
+     * 删除会释放桶内数组和红黑树节点，只有 std::allocator 在 pool 中并行删除，其他分配器在调用线程中完成；pred 不能抛出异常。
+     * 
+     * @return 删除的元素个数
+     */
+    template <typename Pred>
+    size_type parallel_erase_if(Pred pred, utils::work_stealing_pool& pool = utils::work_stealing_pool::shared()) {
+        if constexpr (!allocator_is_thread_safe) {
+            utils::work_stealing_pool serial(0);
+            return erase_if_in(pred, serial);
+        } else {
+            return erase_if_in(pred, pool);
         }
-        
-        // 键不存在，插入默认值
-        auto result = insert(key, mapped_type{});
-        return result.first->second;
+    }
+
+    // =====================================================================================
+    // 容量管理
+    // =====================================================================================
+
+    /**
+     * @brief 整理箱子：完成渐进式合并，清空并释放稀疏的主箱
+     * 
+     * 非空桶占比低于 COMPACT_THRESHOLD 的主箱中剩余的元素移入其他主箱，空出的箱子连同桶数组和位图一起释放，
+     * 之后的查找和插入只访问剩下的箱子。桶数不变；所有迭代器失效。
+     */
+    void compact() {
+        finish_migration();
+        drain_sparse_boxes();
+    }
+
+    /**
+     * @brief 按当前元素数量重建为一个主箱，释放多余的箱子、桶数组、位图和占用目录
+     * 
+     * 桶数为能以负载因子阈值容纳 size() 个元素的最小2的幂（至少16），但不超过当前桶数；
+     * 一个箱子放不下时按插入规则追加箱子。元素使用存储的哈希值移入新箱，不重新计算哈希也不比较键；所有迭代器失效。
+     * 已经只有一个大小合适的主箱时不做任何事。
+     */
+    void shrink_to_fit() {
+        size_type capacity = std::min(calculate_initial_box_capacity(size_), box_capacity);
+        if (!migrating() && box_index.size() == 1 && box_capacity == capacity) return;
+        rebuild(capacity);
+    }
+
+    /**
+     * @brief 预留空间，使之后插入共 n 个元素时不再追加箱子或合并
+     * 
+     * 桶数已多于容纳 n 个元素所需，或者只有一个桶数恰好足够的主箱时不做任何事；
+     * 否则重建为一个桶数能以负载因子阈值容纳 n 个元素的主箱。
+     * 不会减少桶数；发生重建时所有迭代器失效。
+     */
+    void reserve(size_type n) {
+        size_type capacity = calculate_initial_box_capacity(n);
+        if (capacity < box_capacity) return;
+        if (capacity == box_capacity && !migrating() && box_index.size() == 1) return;
+        rebuild(capacity);
+    }
+
+    /**
+     * @brief 重建为一个桶数至少为 buckets、且能以负载因子阈值容纳 size() 个元素的主箱
+     * 
+     * 桶数向上取整到2的幂（至少16），可以小于当前桶数；一个箱子放不下时按插入规则追加箱子。所有迭代器失效。
+     */
+    void rehash(size_type buckets) {
+        size_type capacity = calculate_initial_box_capacity(size_);
+        while (capacity < buckets) capacity <<= 1;
+        if (!migrating() && box_index.size() == 1 && box_capacity == capacity) return;
+        rebuild(capacity);
+    }
+
+    /**
+     * @brief 是否开启了自动收缩
+     */
+    bool auto_shrink() const {
+        return auto_shrink_;
+    }
+
+    /**
+     * @brief 开启或关闭自动收缩
+     * 
+     * 开启后，删除使元素数量低于主箱总桶数的 AUTO_SHRINK_LOAD 时自动调用 shrink_to_fit，
+     * clear() 释放所有箱子并回到最小桶数，适合周期性清空、峰值远大于常态的表。
+     * 开启时删除可能使所有迭代器失效。
+     */
+    void auto_shrink(bool enabled) {
+        auto_shrink_ = enabled;
+    }
+
+    /**
+     * @brief 统计内存占用
+     * 
+     * 按组成部分报告字节数：各箱的桶数组（其中桶对象内嵌的比较器单独列出）、位图、占用目录和箱索引、
+     * 小有序数组、红黑树节点、箱链表节点，以及平均每个元素的字节数。迁移期间包含旧箱。
+     * 只访问非空桶，开销与非空桶数量成正比。
+     */
+    utils::memory_report memory_usage() const {
+        utils::memory_report report;
+        report.exact = std::is_same<Allocator, std::allocator<value_type>>::value;
+        report.object = sizeof(HashMap);
+        for (const box_manager& box_mgr : box_list) {
+            report.bucket_arrays += box_mgr.box.capacity() * sizeof(bucket_type);
+            // 空的比较器经空基类优化不占桶内空间，只计入非空的部分
+            report.comparators += box_mgr.box.size() *
+                ((std::is_empty<pair_less>::value ? 0 : sizeof(pair_less)) +
+                 (std::is_empty<pair_equal>::value ? 0 : sizeof(pair_equal)));
+            report.bitmaps += box_mgr.box_map.word_count * sizeof(typename box_map_type::word_type);
+            // std::list 的节点: 前后两个指针和 box_manager
+            report.box_list += sizeof(box_manager) + 2 * sizeof(void*);
+            for (size_type i = box_mgr.box_map.find_next_set(0); i != box_map_type::npos;
+                 i = box_mgr.box_map.find_next_set(i + 1)) {
+                const bucket_type& bucket = box_mgr.box[i];
+                (bucket.is_tree() ? report.tree_nodes : report.small_arrays) += bucket.heap_bytes();
+            }
+        }
+        report.directory = (box_dir.words.capacity() + migration.box_dir.words.capacity()) * sizeof(uint64_t) +
+                           (box_index.capacity() + migration.box_index.capacity()) * sizeof(box_manager*);
+        report.finish(size_);
+        return report;
     }
 
     /**
@@ -579,8 +1706,8 @@ public:     // 公共函数
      * @return 当前的负载因子值
      */
     double load_factor() const {
-        if (box_list.empty()) return 0.0;
-        const auto& last_box = box_list.back();
+        if (box_index.empty()) return 0.0;
+        const auto& last_box = *box_index.back();
         return static_cast<double>(last_box.used_bucket_count) / box_capacity;
     }
 
@@ -605,27 +1732,26 @@ public:     // 公共函数
      * 
      * 删除HashMap中的所有元素，但保持桶数组的大小不变。
      * 清空后HashMap的大小为0，但容量保持原值。
+     * 如果正在进行渐进式合并，直接释放尚未迁移完的旧箱。
      */    void clear() {
-        // 通过重建空的红黑树来清空所有箱
+        if (migrating()) {
+            box_list.erase(migration.first, box_list.end());
+            migration = migration_state();
+        }
+
+        // 清空所有桶，释放数组和红黑树
         for (auto& box_mgr : box_list) {
-            for (size_type i = 0; i < box_capacity; ++i) {
-                if (box_mgr.box_map.get(i)) {
-                    // 重建空的红黑树，使用相同的比较器
-                    box_mgr.box[i] = bucket_type(
-                        [](const pair_type& a, const pair_type& b) -> bool { 
-                            return a.first < b.first; 
-                        },
-                        [](const pair_type& a, const pair_type& b) -> bool { 
-                            return a.first == b.first; 
-                        }
-                    );
-                }
+            for (size_type i = box_mgr.box_map.find_next_set(0); i != box_map_type::npos;
+                 i = box_mgr.box_map.find_next_set(i + 1)) {
+                box_mgr.box[i].clear();
             }
-            box_mgr.box_map.init(box_capacity);
+            box_mgr.box_map.clear_all();
             box_mgr.used_bucket_count = 0;
         }
+        box_dir.reset();
         
         size_ = 0;
+        if (auto_shrink_) shrink_to_fit();
     }
 
     /**
@@ -637,7 +1763,8 @@ public:     // 公共函数
      * @return 对应值的引用
      * @throws std::out_of_range 如果键不存在
      */
-    mapped_type& at(const Key& key) {
+    template <typename K = key_type>
+    mapped_type& at(const key_arg<K>& key) {
         auto it = find(key);
         if (it == end()) {
             throw std::out_of_range("HashMap::at: key not found");
@@ -652,7 +1779,8 @@ public:     // 公共函数
      * @return 对应值的const引用
      * @throws std::out_of_range 如果键不存在
      */
-    const mapped_type& at(const Key& key) const {
+    template <typename K = key_type>
+    const mapped_type& at(const key_arg<K>& key) const {
         auto it = find(key);
         if (it == end()) {
             throw std::out_of_range("HashMap::at: key not found");
@@ -665,7 +1793,8 @@ public:     // 公共函数
      * 
      * @param key 要检查的键
      * @return true如果键存在，false否则
-     */    bool contains(const Key& key) const {
+     */    template <typename K = key_type>
+    bool contains(const key_arg<K>& key) const {
         return find(key) != end();
     }
 
@@ -674,12 +1803,54 @@ public:     // 公共函数
     /**
      * @brief 插入一个范围内的元素
      * 
+     * 空表插入至少 PARALLEL_GRAIN 个元素的随机访问范围时走批量构建路径（见 bulk_build），
+     * 分配器为 std::allocator 时使用共享线程池并行构建。
+     * 其他前向迭代器范围先按 std::distance 预留空间（见 reserve_for_insert），再逐个插入。
+     * 
      * @tparam InputIt 输入迭代器类型
      * @param first 范围开始迭代器
      * @param last 范围结束迭代器
      */
     template<typename InputIt>
     void insert(InputIt first, InputIt last) {
+        using category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value) {
+            size_type n = static_cast<size_type>(std::distance(first, last));
+            if constexpr (std::is_base_of<std::random_access_iterator_tag, category>::value) {
+                if (empty() && n >= PARALLEL_GRAIN) {
+                    if constexpr (allocator_is_thread_safe) {
+                        bulk_build(first, n, utils::work_stealing_pool::shared());
+                    } else {
+                        utils::work_stealing_pool serial(0);
+                        bulk_build(first, n, serial);
+                    }
+                    return;
+                }
+            }
+            reserve_for_insert(n);
+        }
+        for (auto it = first; it != last; ++it) {
+            insert(it->first, it->second);
+        }
+    }
+
+    /**
+     * @brief 在指定线程池中插入一个随机访问范围内的元素
+     * 
+     * 空表走批量构建路径：按输入长度一次性确定桶数，并行哈希、按桶下标分区后由多个线程无锁填充；
+     * 只有 std::allocator 在 pool 中并行构建，其他分配器在调用线程中完成。非空表逐个插入。重复的键以最后一次出现的值为准。
+     */
+    template<typename RandomIt>
+    void insert(RandomIt first, RandomIt last, utils::work_stealing_pool& pool) {
+        if (empty() && first != last) {
+            if constexpr (allocator_is_thread_safe) {
+                bulk_build(first, static_cast<size_type>(last - first), pool);
+            } else {
+                utils::work_stealing_pool serial(0);
+                bulk_build(first, static_cast<size_type>(last - first), serial);
+            }
+            return;
+        }
         for (auto it = first; it != last; ++it) {
             insert(it->first, it->second);
         }
@@ -691,6 +1862,7 @@ public:     // 公共函数
      * @param ilist 包含要插入元素的初始化列表
      */
     void insert(std::initializer_list<value_type> ilist) {
+        reserve_for_insert(ilist.size());
         for (const auto& pair : ilist) {
             insert(pair.first, pair.second);
         }
@@ -708,7 +1880,7 @@ public:     // 公共函数
     template<typename... Args>
     std::pair<iterator, bool> emplace(Args&&... args) {
         pair_type pair(std::forward<Args>(args)...);
-        return insert(std::move(pair.first), std::move(pair.second));
+        return insert_or_assign(std::move(pair.first), std::move(pair.second));
     }
 
 
@@ -737,29 +1909,102 @@ public:     // 公共函数
      * @param key 要查找的键
      * @return 指向找到元素的const迭代器，如果未找到则返回end()
      */
-    const_iterator find(const Key& key) const {
-        return const_cast<HashMap*>(this)->find(key);
-    }    /**
-     * @brief 调试函数，打印哈希表内容
+    template <typename K = key_type>
+    const_iterator find(const key_arg<K>& key) const {
+        return const_cast<HashMap*>(this)->find<K>(key);
+    }
+
+    /**
+     * @brief 结构统计快照
+     * 
+     * 箱子一级的信息（每个主箱和旧箱的桶数、非空桶数和占用率）直接读取计数，总是精确的；
+     * 桶大小和树高的直方图、每次查找访问的箱子数以及元素最多的热点桶需要扫描桶下标。
+     * sample 为0时扫描所有桶下标，开销与桶数成正比；否则按2的幂步长抽取约 sample 个桶下标，
+     * 开销与 sample 乘以箱子数成正比，适合在生产环境中定期导出。调用期间不能修改本表。
+     * 
+     * @param sample 抽样的桶下标数，0 表示全部扫描
+     * @param hot_limit 热点桶列表的最大长度
+     */
+    utils::map_stats stats(size_type sample = 0, size_type hot_limit = 8) const {
+        utils::map_stats result;
+        result.size = size_;
+        result.bucket_count = box_capacity;
+        result.element_load = static_cast<double>(size_) / (box_capacity * box_index.size());
+        result.migrating = migrating();
+        result.migrated_buckets = migration.cursor;
+        result.hot_limit = hot_limit;
+        for (const box_manager& box_mgr : box_list) {
+            utils::map_stats::box_info info;
+            info.capacity = box_mgr.capacity;
+            info.used_buckets = box_mgr.used_bucket_count;
+            info.occupancy = static_cast<double>(box_mgr.used_bucket_count) / box_mgr.capacity;
+            info.old = result.boxes.size() >= box_index.size();
+            result.boxes.push_back(info);
+        }
+
+        size_type stride = 1;
+        while (sample && stride * sample < box_capacity) stride <<= 1;
+        result.total_positions = box_capacity;
+        collect_stats(result, stride);
+        result.finish();
+        return result;
+    }
+
+    /**
+     * @brief 调试函数，打印结构统计
      * 
-     * 输出HashMap的调试信息，包括大小、桶容量、负载因子等统计信息。
-     */    void debug() const {
+     * 输出大小、桶容量、每个箱子的占用率、桶大小和树高的直方图、查找访问的箱子数以及热点桶，
+     * 不逐个列出非空桶。
+     */
+    void debug() const {
+        utils::map_stats info = stats();
         std::cout << "HashMap调试信息:\n";
-        std::cout << "  大小: " << size_ << "\n";
-        std::cout << "  桶容量: " << box_capacity << "\n";
+        std::cout << "  大小: " << info.size << "\n";
+        std::cout << "  桶容量: " << info.bucket_count << "\n";
         std::cout << "  负载因子: " << load_factor() << "\n";
-        std::cout << "  箱子数量: " << box_list.size() << "\n";
-        
-        size_type box_index = 0;
-        for (const auto& box_mgr : box_list) {
-            std::cout << "  箱子 " << box_index << " (非空桶数: " << box_mgr.used_bucket_count << "):\n";
-            for (size_type i = 0; i < box_capacity; ++i) {
-                if (box_mgr.box_map.get(i)) {
-                    std::cout << "    桶 " << i << ": 包含元素 (树大小: " << box_mgr.box[i].size() << ")\n";
-                }
-            }
-            box_index++;
+        std::cout << "  箱子数量: " << info.boxes.size() << "\n";
+        if (info.migrating) {
+            std::cout << "  正在合并: 旧箱 " << migration.box_index.size() << " 个, 已迁移旧桶 "
+                      << info.migrated_buckets << "/" << migration.box_capacity << "\n";
+        }
+        for (size_type i = 0; i < info.boxes.size(); i++) {
+            const auto& box = info.boxes[i];
+            std::cout << "  箱子 " << i << (box.old ? " (旧箱, " : " (") << "桶数: " << box.capacity
+                      << ", 非空桶数: " << box.used_buckets << ", 占用率: " << box.occupancy << ")\n";
+        }
+        std::cout << "  桶大小分布:";
+        for (size_type k = 0; k < info.size_histogram.size(); k++) {
+            std::cout << " [" << (size_type(1) << k) << ", " << (size_type(2) << k) << "): " << info.size_histogram[k];
+        }
+        std::cout << "\n  红黑树高度分布:";
+        for (size_type h = 0; h < info.height_histogram.size(); h++) {
+            if (info.height_histogram[h]) std::cout << " " << h << ": " << info.height_histogram[h];
         }
+        std::cout << "\n  每次查找访问的箱子数: 命中平均 " << info.avg_boxes_per_hit << ", 未命中平均 "
+                  << info.avg_boxes_per_miss << ", 最多 " << info.max_boxes_per_lookup << "\n";
+        for (const auto& hot : info.hot_buckets) {
+            std::cout << "    热点桶: 箱子 " << hot.box << " 桶 " << hot.bucket << ", 元素数 " << hot.size;
+            if (hot.height) std::cout << ", 树高 " << hot.height;
+            std::cout << "\n";
+        }
+    }
+
+    /**
+     * @brief 获取哈希器
+     * 
+     * @return 当前使用的哈希器对象
+     */
+    hasher_type hash_function() const {
+        return hash_function_;
+    }
+
+    /**
+     * @brief 获取键相等比较器
+     * 
+     * @return 当前使用的键相等比较器对象
+     */
+    key_equal_type key_eq() const {
+        return key_eq_;
     }
 
     /**
@@ -782,19 +2027,78 @@ public:     // 公共函数
     /**
      * @brief 获取最大负载因子
      * 
-     * @return 当前设置的最大负载因子（固定为0.75）
+     * @return 最后一个主箱的非空桶占比超过此值时扩展，默认为0.75
      */
     double max_load_factor() const {
-        return LOAD_FACTOR_THRESHOLD;
+        return policy_.max_load_factor;
+    }
+
+    /**
+     * @brief 设置最大负载因子
+     * 
+     * 只影响之后的扩展以及 reserve/rehash/shrink_to_fit 计算的桶数，不立即重建。
+     * 
+     * @param ml 新的最大负载因子，取值 (0, 1]
+     * @throws std::invalid_argument 如果 ml 不在 (0, 1] 内
+     */
+    void max_load_factor(double ml) {
+        hashmap_storage::growth_policy policy = policy_;
+        policy.max_load_factor = ml;
+        set_growth_policy(policy);
+    }
+
+    /**
+     * @brief 获取增长策略
+     */
+    const hashmap_storage::growth_policy& get_growth_policy() const {
+        return policy_;
     }
 
     /**
-     * @brief 设置最大负载因子（未实现 - 固定为0.75）
+     * @brief 设置增长策略
+     * 
+     * 只影响之后的扩展：主箱数量已超过新的上限时，下一次扩展开始渐进式合并。
      * 
-     * @param ml 要设置的最大负载因子（此参数会被忽略）
-     */    void max_load_factor(double ml) {
-        (void)ml; // 忽略 - 负载因子固定
+     * @param policy 新的增长策略
+     * @throws std::invalid_argument 如果负载因子不在 (0, 1] 内、主箱数量上限为0或倍增系数不是不小于2的2的幂
+     */
+    void set_growth_policy(const hashmap_storage::growth_policy& policy) {
+        if (!(policy.max_load_factor > 0.0 && policy.max_load_factor <= 1.0)) {
+            throw std::invalid_argument("HashMap::set_growth_policy: max_load_factor must be in (0, 1]");
+        }
+        if (policy.max_box_count == 0) {
+            throw std::invalid_argument("HashMap::set_growth_policy: max_box_count must be positive");
+        }
+        if (policy.growth_factor < 2 || (policy.growth_factor & (policy.growth_factor - 1)) != 0) {
+            throw std::invalid_argument("HashMap::set_growth_policy: growth_factor must be a power of two >= 2");
+        }
+        policy_ = policy;
     }
 };
 
+/**
+ * @brief 使用开放寻址平坦表作为存储引擎的HashMap
+ * 
+ * 公共接口、迭代器和哈希方式（utils::hash / XXHash32）与默认引擎相同。
+ * 元素存放在连续的槽数组中，查找时每次用 SSE2 比较16个控制字节，适合查找密集的场景；
+ * 扩容时整体重建，插入可能使所有迭代器失效。
+ */
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+class HashMap<Key, Value, Hash, KeyEqual, Allocator, hashmap_storage::flat>
+    : public utils::flat_table<Key, Value, Hash, KeyEqual, Allocator> {
+    using base_type = utils::flat_table<Key, Value, Hash, KeyEqual, Allocator>;
+
+public:
+    using base_type::base_type;
+};
+
+/**
+ * @brief 使用开放寻址平坦表的HashMap的简写
+ */
+template <typename Key, typename Value,
+          typename Hash = utils::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>,
+          typename Allocator = std::allocator<std::pair<const Key, Value>>>
+using FlatHashMap = HashMap<Key, Value, Hash, KeyEqual, Allocator, hashmap_storage::flat>;
+
 #endif // HASHMAP_HPP
@@ -0,0 +1,270 @@
+#ifndef SHARDED_HASHMAP_HPP
+#define SHARDED_HASHMAP_HPP
+
+#include "hashmap.hpp"
+#include "utils/spinlock.hpp"
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief 按写者分片的 HashMap，适合每个线程高频累加计数(如 map[key] += 1)
+ *
+ * 每个写者通过 register_writer() 取得自己独占的分片(一个 HashMap)，写入只访问本分片，
+ * 线程之间不共享被写的缓存行。读取时用归约器 Reduce 把各分片中同一个键的值合并：
+ * - 按需合并：get() 在每个分片中查找并归约，snapshot() / merge_into() 合并出一个完整的 HashMap；
+ * - 定期刷新的合并视图：refresh() 重建合并视图，find() 只读视图，不访问分片。
+ * drain_into() 把分片的元素移入目标表并清空分片，用于周期性地汇总增量。
+ *
+ * 每个分片有一把自旋锁，写者每次写入取得自己分片的锁；锁只在合并时才有竞争，平时只是本线程缓存行上的一次原子交换。
+ * 写者注销后分片和其中的数据保留，由之后注册的写者复用。
+ *
+ * @tparam Key 键类型
+ * @tparam Value 值类型
+ * @tparam Reduce 归约器，Value(const Value&, const Value&)，须满足结合律与交换律
+ * @tparam Hash 哈希函数对象类型
+ * @tparam KeyEqual 键相等比较函数对象类型
+ * @tparam Allocator 内存分配器类型
+ */
+template <typename Key, typename Value,
+          typename Reduce = std::plus<Value>,
+          typename Hash = utils::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>,
+          typename Allocator = std::allocator<std::pair<const Key, Value>>>
+class ShardedHashMap {
+public:
+    using map_type                = HashMap<Key, Value, Hash, KeyEqual, Allocator>;
+
+    // 类型定义
+    using key_type                = Key;                            // 键
+    using mapped_type             = Value;                          // 值类型
+    using size_type               = typename map_type::size_type;   // 大小
+    using reducer                 = Reduce;                         // 归约器
+    using hasher                  = Hash;                           // 哈希器
+    using key_equal               = KeyEqual;                       // 键相等比较器
+    using allocator_type          = Allocator;                      // 分配器
+
+private:
+    struct alignas(64) shard {
+      mutable utils::spinlock     lock;               // 写者写入与合并之间互斥
+      map_type                    map;                // 分片数据
+      bool                        in_use = false;     // 是否被某个写者持有，受 shards_mutex 保护
+
+      shard(size_type estimated_size, const hasher& hash, const key_equal& equal, const Allocator& alloc)
+        : map(estimated_size, hash, equal, alloc) {}
+    };
+
+private:
+    size_type                     shard_size;         // 新分片的预计元素数量
+    hasher                        hash_function_;     // 哈希器
+    key_equal                     key_eq_;            // 键相等比较器
+    Allocator                     allocator;          // 内存分配器
+    reducer                       reduce;             // 归约器
+    mutable std::mutex            shards_mutex;       // 保护分片列表和 in_use
+    std::list<shard>              shards;             // 分片，地址在表的生命周期内不变
+    mutable std::mutex            view_mutex;         // 保护 view 指针
+    std::shared_ptr<const map_type> view;             // 最近一次 refresh() 的合并视图
+
+public:
+    /**
+     * @brief 写者句柄，只能由一个线程使用。析构时归还分片，分片中的数据保留
+     */
+    class writer {
+        friend class ShardedHashMap;
+
+    protected:
+        ShardedHashMap*           owner = nullptr;
+        shard*                    slot = nullptr;
+
+        writer(ShardedHashMap* owner, shard* slot) : owner(owner), slot(slot) {}
+
+    public:
+        writer() = default;
+        writer(const writer&) = delete;
+        writer& operator=(const writer&) = delete;
+
+        writer(writer&& other) noexcept : owner(other.owner), slot(other.slot) {
+            other.owner = nullptr;
+            other.slot = nullptr;
+        }
+
+        writer& operator=(writer&& other) noexcept {
+            if (this != &other) {
+                release();
+                owner = other.owner;
+                slot = other.slot;
+                other.owner = nullptr;
+                other.slot = nullptr;
+            }
+            return *this;
+        }
+
+        ~writer() { release(); }
+
+        /**
+         * @brief 以本分片中键的值调用 f(mapped_type&)，键不存在时先插入值初始化的值
+         */
+        template <typename F>
+        void update(const Key& key, F&& f) {
+            std::lock_guard<utils::spinlock> lock(slot->lock);
+            f(slot->map.try_emplace(key).first->second);
+        }
+
+        /**
+         * @brief 把 value 归约到本分片中键的值上，键不存在时直接插入
+         */
+        void add(const Key& key, const Value& value) {
+            std::lock_guard<utils::spinlock> lock(slot->lock);
+            auto result = slot->map.try_emplace(key, value);
+            if (!result.second) result.first->second = owner->reduce(result.first->second, value);
+        }
+
+        void release() {
+            if (!owner) return;
+            std::lock_guard<std::mutex> lock(owner->shards_mutex);
+            slot->in_use = false;
+            owner = nullptr;
+            slot = nullptr;
+        }
+    };
+
+private:    // 内部函数
+    /**
+     * @brief 把 source 的每个元素归约到 target 上。move_values 为 true 时移出 source 的值
+     */
+    template <bool move_values, typename Source>
+    void combine(map_type& target, Source& source) const {
+        for (auto& kv : source) {
+            // 键已存在时 try_emplace 不会移动实参，kv.second 仍可用于归约
+            auto result = target.try_emplace(kv.first, std::conditional_t<move_values, Value&&, const Value&>(kv.second));
+            if (!result.second) result.first->second = reduce(result.first->second, kv.second);
+        }
+    }
+
+public:     // 公共函数
+    /**
+     * @brief 构造函数
+     *
+     * @param estimated_shard_size 每个分片预计的元素数量
+     */
+    explicit ShardedHashMap(size_type estimated_shard_size = 0, const reducer& reduce = reducer(),
+                            const hasher& hash = hasher(), const key_equal& equal = key_equal(),
+                            const Allocator& alloc = Allocator())
+        : shard_size(estimated_shard_size), hash_function_(hash), key_eq_(equal), allocator(alloc), reduce(reduce) {}
+
+    ShardedHashMap(const ShardedHashMap&) = delete;
+    ShardedHashMap& operator=(const ShardedHashMap&) = delete;
+
+    /**
+     * @brief 为当前线程取得一个独占的分片，优先复用已注销写者的分片
+     */
+    writer register_writer() {
+        std::lock_guard<std::mutex> lock(shards_mutex);
+        for (shard& s : shards) {
+            if (!s.in_use) {
+                s.in_use = true;
+                return writer(this, &s);
+            }
+        }
+        shards.emplace_back(shard_size, hash_function_, key_eq_, allocator);
+        shards.back().in_use = true;
+        return writer(this, &shards.back());
+    }
+
+    /**
+     * @brief 按需合并：在每个分片中查找键并归约
+     *
+     * @return true表示至少有一个分片含有该键
+     */
+    bool get(const Key& key, mapped_type& value) const {
+        std::lock_guard<std::mutex> lock(shards_mutex);
+        bool found = false;
+        for (const shard& s : shards) {
+            std::lock_guard<utils::spinlock> shard_lock(s.lock);
+            auto it = s.map.find(key);
+            if (it == s.map.end()) continue;
+            value = found ? reduce(value, it->second) : it->second;
+            found = true;
+        }
+        return found;
+    }
+
+    /**
+     * @brief 把所有分片归约到 target 上，分片不变。每次只锁一个分片
+     */
+    void merge_into(map_type& target) const {
+        std::lock_guard<std::mutex> lock(shards_mutex);
+        for (const shard& s : shards) {
+            std::lock_guard<utils::spinlock> shard_lock(s.lock);
+            combine<false>(target, s.map);
+        }
+    }
+
+    /**
+     * @brief 把所有分片的元素移出并归约到 target 上，然后清空分片
+     *
+     * 各分片依次处理，写者只在自己的分片被处理的短暂时间内等待；之后的写入计入下一次汇总。
+     */
+    void drain_into(map_type& target) {
+        std::lock_guard<std::mutex> lock(shards_mutex);
+        for (shard& s : shards) {
+            std::lock_guard<utils::spinlock> shard_lock(s.lock);
+            combine<true>(target, s.map);
+            s.map.clear();
+        }
+    }
+
+    /**
+     * @brief 合并所有分片得到的完整 HashMap
+     */
+    map_type snapshot() const {
+        map_type merged(0, hash_function_, key_eq_, allocator);
+        merge_into(merged);
+        return merged;
+    }
+
+    /**
+     * @brief 重建合并视图，之后的 find() 读取新视图
+     */
+    void refresh() {
+        auto merged = std::make_shared<const map_type>(snapshot());
+        std::lock_guard<std::mutex> lock(view_mutex);
+        view = std::move(merged);
+    }
+
+    /**
+     * @brief 在最近一次 refresh() 的合并视图中查找，不访问分片
+     *
+     * @return true表示视图中有该键；尚未 refresh() 时总是 false
+     */
+    bool find(const Key& key, mapped_type& value) const {
+        std::shared_ptr<const map_type> current;
+        {
+            std::lock_guard<std::mutex> lock(view_mutex);
+            current = view;
+        }
+        if (!current) return false;
+        auto it = current->find(key);
+        if (it == current->end()) return false;
+        value = it->second;
+        return true;
+    }
+
+    /**
+     * @brief 分片数量，即同时注册过的写者数量的最大值
+     */
+    size_type shard_count() const {
+        std::lock_guard<std::mutex> lock(shards_mutex);
+        return shards.size();
+    }
+
+    hasher hash_function() const { return hash_function_; }
+    key_equal key_eq() const { return key_eq_; }
+    allocator_type get_allocator() const { return allocator; }
+};
+
+#endif // SHARDED_HASHMAP_HPP
@@ -0,0 +1,45 @@
+#include "hashmap.hpp"
+#include <chrono>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// 从转储数据重建查找表: 逐个插入与随机访问范围的批量构建
+// 工作负载: ENTRY_COUNT 个互不相同的随机键
+
+const int ENTRY_COUNT = 4000000;
+
+template <typename F>
+double time_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    std::cout << "=== 批量构建基准测试 ===\n";
+    std::cout << "元素数 " << ENTRY_COUNT << "\n\n";
+
+    std::vector<std::pair<int, int>> dump;
+    dump.reserve(ENTRY_COUNT);
+    for (int i = 0; i < ENTRY_COUNT; ++i) dump.emplace_back(static_cast<int>(i * 2654435761u), i);
+
+    size_t one_by_one_size = 0;
+    double one_by_one_ms = time_ms([&] {
+        HashMap<int, int> map;
+        for (auto& kv : dump) map.insert(kv.first, kv.second);
+        one_by_one_size = map.size();
+    });
+
+    size_t bulk_size = 0;
+    double bulk_ms = time_ms([&] {
+        HashMap<int, int> map(dump.begin(), dump.end());
+        bulk_size = map.size();
+    });
+
+    std::cout << "参与线程数: " << utils::work_stealing_pool::shared().concurrency() << "\n";
+    std::cout << "逐个插入: " << one_by_one_ms << " ms\n";
+    std::cout << "批量构建: " << bulk_ms << " ms\n";
+    std::cout << "加速比: " << one_by_one_ms / bulk_ms << "\n";
+    return one_by_one_size == bulk_size ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+#include "concurrent_hashmap.hpp"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 多线程吞吐量: 一把全局锁保护的 HashMap 与按桶条带加锁的 ConcurrentHashMap
+// 工作负载: 80% 查找、10% 插入、10% 删除，键均匀分布在 [0, KEY_RANGE)
+
+const int KEY_RANGE = 1 << 20;
+const int OPS_PER_THREAD = 1000000;
+
+std::atomic<long> hit_sink{0};   // 防止查找被优化掉
+
+struct LockedMap {
+    std::mutex mutex;
+    HashMap<int, int> map;
+
+    bool find(int key, int& value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = map.find(key);
+        if (it == map.end()) return false;
+        value = it->second;
+        return true;
+    }
+    void insert(int key, int value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        map.try_emplace(key, value);
+    }
+    void erase(int key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        map.erase(key);
+    }
+};
+
+struct StripedMap {
+    ConcurrentHashMap<int, int> map;
+
+    bool find(int key, int& value) { return map.find(key, value); }
+    void insert(int key, int value) { map.insert(key, value); }
+    void erase(int key) { map.erase(key); }
+};
+
+// 返回每秒操作数(百万)
+template <typename Map>
+double run(Map& map, int threads) {
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&map, t] {
+            std::mt19937 rng(12345u + t);
+            std::uniform_int_distribution<int> key_dist(0, KEY_RANGE - 1);
+            std::uniform_int_distribution<int> op_dist(0, 9);
+            int value = 0;
+            long hits = 0;
+            for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                int key = key_dist(rng);
+                int op = op_dist(rng);
+                if (op == 0) map.insert(key, i);
+                else if (op == 1) map.erase(key);
+                else hits += map.find(key, value);
+            }
+            hit_sink += hits;
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return threads * static_cast<double>(OPS_PER_THREAD) / elapsed / 1e6;
+}
+
+template <typename Map>
+void prefill(Map& map) {
+    for (int i = 0; i < KEY_RANGE; i += 2) map.insert(i, i);
+}
+
+int main() {
+    std::cout << "=== 多线程吞吐量基准测试 ===\n";
+    std::cout << "80% 查找 / 10% 插入 / 10% 删除，键空间 " << KEY_RANGE << "，每线程 " << OPS_PER_THREAD << " 次操作\n\n";
+
+    unsigned max_threads = std::thread::hardware_concurrency();
+    if (max_threads == 0) max_threads = 4;
+
+    std::cout << "线程数\t全局锁 HashMap (Mops/s)\tConcurrentHashMap (Mops/s)\t加速比\n";
+    std::vector<unsigned> thread_counts;
+    for (unsigned threads = 1; threads < max_threads; threads *= 2) thread_counts.push_back(threads);
+    thread_counts.push_back(max_threads);
+
+    for (unsigned threads : thread_counts) {
+        LockedMap locked;
+        prefill(locked);
+        StripedMap striped;
+        prefill(striped);
+
+        double locked_mops = run(locked, static_cast<int>(threads));
+        double striped_mops = run(striped, static_cast<int>(threads));
+        std::cout << threads << "\t" << locked_mops << "\t\t\t" << striped_mops << "\t\t\t"
+                  << striped_mops / locked_mops << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "hashmap.hpp"
+#include "test_common.hpp"
+#include <iostream>
+#include <set>
+#include <string>
+
+template <typename Map>
+static bool check(Map& map, const std::set<int>& expected) {
+    if (map.size() != expected.size()) return false;
+    for (int key : expected) {
+        auto it = map.find(key);
+        if (it == map.end() || it->second != std::to_string(key)) return false;
+    }
+    std::set<int> seen;
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        if (!seen.insert(it->first).second) return false;
+    }
+    return seen == expected;
+}
+
+int main() {
+    std::cout << "=== Testing adaptive bucket forms ===\n";
+
+    // 所有键在同一个桶，使桶依次经历 内联 -> 有序数组 -> 红黑树 -> 有序数组 -> 内联
+    HashMap<int, std::string, SingleBucketHash> map;
+    std::set<int> expected;
+
+    // 逆序插入，覆盖有序数组的中间插入
+    for (int i = 40; i > 0; --i) {
+        if (!map.insert(i, std::to_string(i)).second) return 1;
+        expected.insert(i);
+        if (!check(map, expected)) {
+            std::cout << "Mismatch after inserting " << i << "\n";
+            return 1;
+        }
+    }
+
+    // 已存在的键只更新值
+    if (map.insert(20, "20").second || map.size() != 40) return 1;
+    if (map.find(100) != map.end()) return 1;
+
+    for (int i = 1; i <= 40; ++i) {
+        if (!map.erase(i * 7 % 41)) {
+            std::cout << "Failed to erase " << i * 7 % 41 << "\n";
+            return 1;
+        }
+        expected.erase(i * 7 % 41);
+        if (!check(map, expected)) {
+            std::cout << "Mismatch after erasing " << i * 7 % 41 << "\n";
+            return 1;
+        }
+    }
+    if (!map.empty() || map.erase(1)) return 1;
+
+    // 拷贝含有各种形式桶的表
+    HashMap<int, std::string, SingleBucketHash> small;
+    for (int i = 0; i < 12; ++i) small.insert(i, std::to_string(i));
+    HashMap<int, std::string, SingleBucketHash> copy(small);
+    std::set<int> twelve;
+    for (int i = 0; i < 12; ++i) twelve.insert(i);
+    if (!check(copy, twelve) || !check(small, twelve)) return 1;
+
+    small.clear();
+    if (!small.empty() || small.begin() != small.end()) return 1;
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
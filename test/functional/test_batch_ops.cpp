@@ -0,0 +1,89 @@
+#include "hashmap.hpp"
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// find_batch / insert_batch / erase_batch: 结果与逐个调用 find / insert / erase 相同
+template <typename Map>
+static bool check(Map& map, int count) {
+    // 批量插入，批次之间跨越多次扩展(以及箱式引擎的渐进式合并)
+    std::vector<int> keys, values;
+    for (int i = 0; i < count; ++i) {
+        keys.push_back(i * 7);
+        values.push_back(i);
+    }
+    std::unique_ptr<bool[]> inserted(new bool[count]);
+    map.insert_batch(keys.data(), values.data(), keys.size(), inserted.get());
+    if (map.size() != static_cast<size_t>(count)) return false;
+    for (int i = 0; i < count; ++i) if (!inserted[i]) return false;
+
+    // 已有键只更新值；同一批中重复的键按顺序处理
+    std::vector<int> update_keys = {0, 7, 7, -1};
+    std::vector<int> update_values = {100, 200, 300, 400};
+    bool update_inserted[4];
+    map.insert_batch(update_keys.data(), update_values.data(), 4, update_inserted);
+    if (update_inserted[0] || update_inserted[1] || update_inserted[2] || !update_inserted[3]) return false;
+    if (map.find(7)->second != 300 || map.size() != static_cast<size_t>(count) + 1) return false;
+
+    // 批量查找，命中和未命中混合
+    std::vector<int> probes;
+    for (int i = -5; i < count * 7 + 5; i += 3) probes.push_back(i);
+    std::vector<typename Map::iterator> results(probes.size());
+    map.find_batch(probes.data(), probes.size(), results.data());
+    for (size_t i = 0; i < probes.size(); ++i) {
+        auto single = map.find(probes[i]);
+        if (results[i] != single) return false;
+        if (single != map.end() && results[i]->first != probes[i]) return false;
+    }
+
+    // 批量删除一半，其中包含不存在的键
+    std::vector<int> doomed;
+    for (int i = 0; i < count; i += 2) doomed.push_back(i * 7);
+    doomed.push_back(-2);
+    std::unique_ptr<bool[]> erased(new bool[doomed.size()]);
+    size_t removed = map.erase_batch(doomed.data(), doomed.size(), erased.get());
+    if (removed != doomed.size() - 1 || erased[doomed.size() - 1]) return false;
+    if (map.size() != static_cast<size_t>(count) + 1 - removed) return false;
+    for (int i = 0; i < count; ++i) {
+        if (map.contains(i * 7) != (i % 2 == 1)) return false;
+    }
+
+    // 空批次
+    if (map.erase_batch(doomed.data(), 0) != 0) return false;
+    return true;
+}
+
+int main() {
+    std::cout << "=== Testing batched find/insert/erase ===\n";
+
+    HashMap<int, int> box;
+    if (!check(box, 5000)) {
+        std::cout << "Box engine batch operations failed\n";
+        return 1;
+    }
+
+    FlatHashMap<int, int> flat;
+    if (!check(flat, 5000)) {
+        std::cout << "Flat engine batch operations failed\n";
+        return 1;
+    }
+
+    // 透明哈希: 用 string_view 批量查找 std::string 键
+    using StringMap = HashMap<std::string, int, utils::hash<std::string>, std::equal_to<>>;
+    StringMap strings;
+    std::vector<std::string> names = {"alpha", "beta", "gamma"};
+    std::vector<int> ids = {1, 2, 3};
+    strings.insert_batch(names.data(), ids.data(), names.size());
+    std::string_view views[] = {"beta", "delta"};
+    StringMap::iterator found[2];
+    strings.find_batch(views, 2, found);
+    if (found[0] == strings.end() || found[0]->second != 2 || found[1] != strings.end()) {
+        std::cout << "Heterogeneous batch lookup failed\n";
+        return 1;
+    }
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "hashmap.hpp"
+#include <iostream>
+#include <set>
+
+// 64位字位图: 查找、计数与范围操作，以及大量删除后稀疏表的遍历
+static bool check_against(const utils::bitmap<>& bits, const std::set<utils::ulint>& expected) {
+    if (bits.count() != expected.size()) return false;
+    utils::ulint pos = bits.find_next_set(0);
+    for (utils::ulint want : expected) {
+        if (pos != want) return false;
+        pos = bits.find_next_set(pos + 1);
+    }
+    if (pos != utils::bitmap<>::npos) return false;
+
+    pos = bits.find_prev_set(bits.size());
+    for (auto it = expected.rbegin(); it != expected.rend(); ++it) {
+        if (pos != *it) return false;
+        pos = pos ? bits.find_prev_set(pos - 1) : utils::bitmap<>::npos;
+    }
+    return pos == utils::bitmap<>::npos;
+}
+
+int main() {
+    std::cout << "=== Testing word-level bitmap ===\n";
+
+    utils::bitmap<> bits;
+    bits.init(200);
+    std::set<utils::ulint> expected;
+    if (!check_against(bits, expected) || bits.any()) return 1;
+
+    for (utils::ulint i : {0, 1, 63, 64, 65, 127, 128, 199}) {
+        bits.set(i, true);
+        expected.insert(i);
+    }
+    if (!check_against(bits, expected)) return 1;
+
+    bits.set(64, false);
+    expected.erase(64);
+    if (!check_against(bits, expected) || bits.get(64) || !bits.get(65)) return 1;
+
+    bits.set_range(10, 140);
+    for (utils::ulint i = 10; i < 140; ++i) expected.insert(i);
+    if (!check_against(bits, expected)) return 1;
+
+    bits.clear_range(60, 130);
+    for (utils::ulint i = 60; i < 130; ++i) expected.erase(i);
+    if (!check_against(bits, expected)) return 1;
+
+    utils::bitmap<> mask;
+    mask.init(200);
+    mask.set_range(0, 100);
+    utils::bitmap<> both(bits);
+    both &= mask;
+    std::set<utils::ulint> below;
+    for (utils::ulint i : expected) if (i < 100) below.insert(i);
+    if (!check_against(both, below)) return 1;
+
+    both |= mask;
+    std::set<utils::ulint> upto;
+    for (utils::ulint i = 0; i < 100; ++i) upto.insert(i);
+    if (!check_against(both, upto)) return 1;
+
+    bits.set_all();
+    if (bits.count() != 200 || bits.find_prev_set(1000) != 199) return 1;
+    bits.clear_all();
+    if (bits.any() || bits.find_next_set(0) != utils::bitmap<>::npos) return 1;
+
+    try {
+        bits.set(200, true);
+        return 1;
+    } catch (const utils::utils_exception&) {}
+
+    // 大量删除后只剩少量元素，遍历和反向遍历都应只访问剩余元素
+    HashMap<int, int> map;
+    for (int i = 0; i < 100000; ++i) map.insert(i, i);
+    for (int i = 0; i < 100000; ++i) if (i % 10007) map.erase(i);
+    std::set<int> remaining;
+    for (auto it = map.begin(); it != map.end(); ++it) remaining.insert(it->first);
+    if (remaining != std::set<int>{0, 10007, 20014, 30021, 40028, 50035, 60042, 70049, 80056, 90063}) return 1;
+
+    auto last = map.begin();
+    for (int i = 1; i < 10; ++i) ++last;
+    std::set<int> backwards;
+    for (int i = 0; i < 10; ++i, --last) backwards.insert(last->first);
+    if (backwards != remaining) return 1;
+
+    map.clear();
+    if (!map.empty() || map.begin() != map.end()) return 1;
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
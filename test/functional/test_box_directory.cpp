@@ -0,0 +1,59 @@
+#include "hashmap.hpp"
+#include <iostream>
+#include <string>
+
+// 箱子数量远超8个时(触发占用目录加宽)，查找、删除、重新插入仍应正确
+int main() {
+    std::cout << "=== Testing cross-box occupancy directory ===\n";
+
+    HashMap<int, int> map;  // 每箱16个桶，插入大量元素会产生很多箱子
+    const int count = 5000;
+
+    for (int i = 0; i < count; ++i) {
+        map.insert(i, i * 2);
+    }
+    std::cout << "Size after insert: " << map.size() << "\n";
+    if (map.size() != static_cast<size_t>(count)) return 1;
+
+    for (int i = 0; i < count; ++i) {
+        auto it = map.find(i);
+        if (it == map.end() || it->second != i * 2) {
+            std::cout << "Missing key " << i << "\n";
+            return 1;
+        }
+    }
+    for (int i = count; i < count * 2; ++i) {
+        if (map.find(i) != map.end()) {
+            std::cout << "Unexpected key " << i << "\n";
+            return 1;
+        }
+    }
+
+    // 删除偶数键后早期箱子会出现空桶，重新插入不能产生重复键
+    for (int i = 0; i < count; i += 2) map.erase(i);
+    std::cout << "Size after erase: " << map.size() << "\n";
+    if (map.size() != static_cast<size_t>(count / 2)) return 1;
+
+    for (int i = 1; i < count; i += 2) {
+        auto result = map.insert(i, i * 3);
+        if (result.second) {
+            std::cout << "Duplicate insert of key " << i << "\n";
+            return 1;
+        }
+    }
+    if (map.size() != static_cast<size_t>(count / 2)) return 1;
+
+    size_t iterated = 0;
+    for (const auto& pair : map) {
+        if (pair.first % 2 == 0 || pair.second != pair.first * 3) {
+            std::cout << "Bad element " << pair.first << "\n";
+            return 1;
+        }
+        ++iterated;
+    }
+    std::cout << "Iterated: " << iterated << "\n";
+    if (iterated != map.size()) return 1;
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
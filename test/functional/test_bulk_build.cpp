@@ -0,0 +1,104 @@
+#include "hashmap.hpp"
+#include "test_common.hpp"
+#include "utils/mempool.hpp"
+#include <iostream>
+#include <list>
+#include <string>
+#include <utility>
+#include <vector>
+
+template <typename Map>
+bool same_contents(Map& built, Map& expected) {
+    if (built.size() != expected.size()) return false;
+    for (auto& kv : expected) {
+        auto it = built.find(kv.first);
+        if (it == built.end() || it->second != kv.second) return false;
+    }
+    size_t visited = 0;
+    for (auto it = built.begin(); it != built.end(); ++it) ++visited;
+    return visited == built.size();
+}
+
+// 随机访问范围的批量构建与逐个插入的结果一致：重复键取最后一次出现的值，之后的插入/删除正常
+int main() {
+    std::cout << "=== Testing bulk build from random-access ranges ===\n";
+
+    const int n = 300000;
+    std::vector<std::pair<int, int>> input;
+    input.reserve(n + n / 10);
+    for (int i = 0; i < n; ++i) input.emplace_back(i * 7, i);
+    // 重复的键，后出现的值覆盖前面的值
+    for (int i = 0; i < n / 10; ++i) input.emplace_back(i * 70, -i);
+
+    HashMap<int, int> expected;
+    for (auto& kv : input) expected.insert(kv.first, kv.second);
+
+    // 范围构造函数
+    HashMap<int, int> built(input.begin(), input.end());
+    if (!same_contents(built, expected)) {
+        std::cout << "Range constructor differs from sequential insert\n";
+        return 1;
+    }
+    if (built.bucket_count() < static_cast<size_t>(n)) return 1;
+
+    // 指定线程池
+    utils::work_stealing_pool pool(3);
+    HashMap<int, int> pooled;
+    pooled.insert(input.begin(), input.end(), pool);
+    if (!same_contents(pooled, expected)) {
+        std::cout << "Pooled bulk build differs from sequential insert\n";
+        return 1;
+    }
+
+    // 构建后的表可以继续插入、删除，并触发扩展
+    for (int i = 0; i < n; ++i) pooled.insert(i * 7 + 1, i);
+    for (int i = 0; i < n; i += 2) pooled.erase(i * 7);
+    if (pooled.size() != expected.size() + n - n / 2) return 1;
+    if (pooled.contains(0) || !pooled.contains(7) || pooled[7 * 3 + 1] != 3) return 1;
+
+    // 非空表和非随机访问范围逐个插入
+    HashMap<int, int> partial;
+    partial.insert(-1, -1);
+    partial.insert(input.begin(), input.end());
+    if (partial.size() != expected.size() + 1) return 1;
+    std::list<std::pair<int, int>> listed(input.begin(), input.begin() + 10000);
+    HashMap<int, int> from_list(listed.begin(), listed.end());
+    if (from_list.size() != 10000) return 1;
+
+    // 键类型需要转换的范围
+    std::vector<std::pair<const char*, int>> words(5000, std::make_pair("", 0));
+    std::vector<std::string> storage;
+    storage.reserve(words.size());
+    for (size_t i = 0; i < words.size(); ++i) {
+        storage.push_back("word" + std::to_string(i % 4000));
+        words[i] = std::make_pair(storage.back().c_str(), static_cast<int>(i));
+    }
+    HashMap<std::string, int> converted(words.begin(), words.end());
+    if (converted.size() != 4000 || converted["word1"] != 4001 || converted["word3999"] != 3999) return 1;
+
+    // 非 std::allocator 的分配器在调用线程中批量构建
+    using PoolMap = HashMap<int, int, utils::hash<int>, std::equal_to<int>,
+                            utils::mempool_allocator<std::pair<const int, int>>>;
+    PoolMap pool_expected;
+    for (auto& kv : input) pool_expected.insert(kv.first, kv.second);
+    PoolMap pool_built(input.begin(), input.end());
+    if (!same_contents(pool_built, pool_expected)) return 1;
+
+    // 指定线程池时也一样：pmr 内存池只在调用线程中使用
+    {
+        owner_thread_resource resource;
+        using PmrMap = HashMap<int, int, utils::hash<int>, std::equal_to<int>,
+                               std::pmr::polymorphic_allocator<std::pair<const int, int>>>;
+        PmrMap pmr_expected;
+        for (auto& kv : input) pmr_expected.insert(kv.first, kv.second);
+        PmrMap pmr_built(0, {}, {}, &resource);
+        pmr_built.insert(input.begin(), input.end(), pool);
+        if (!same_contents(pmr_built, pmr_expected) || resource.foreign_access) {
+            std::cout << "pmr bulk build used the memory resource from a pool thread\n";
+            return 1;
+        }
+    }
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
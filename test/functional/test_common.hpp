@@ -0,0 +1,70 @@
+/**
+ * @file test_common.hpp
+ * @brief 功能测试共用的哈希器和检查函数
+ */
+#ifndef HASHMAP_TEST_FUNCTIONAL_TEST_COMMON_HPP
+#define HASHMAP_TEST_FUNCTIONAL_TEST_COMMON_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory_resource>
+#include <thread>
+#include <unordered_map>
+
+// 非线程安全的内存池，记录是否有其他线程通过它分配或释放
+class owner_thread_resource : public std::pmr::memory_resource {
+  public:
+    std::pmr::unsynchronized_pool_resource upstream;
+    std::thread::id owner = std::this_thread::get_id();
+    std::atomic<bool> foreign_access{false};
+
+  private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (std::this_thread::get_id() != owner) foreign_access = true;
+        return upstream.allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        if (std::this_thread::get_id() != owner) foreign_access = true;
+        upstream.deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+// 只有4个不同哈希值，所有元素挤在少数几个桶里，桶转为红黑树
+struct CollidingHash {
+    size_t operator()(int key) const { return static_cast<size_t>(key % 4); }
+};
+
+// 所有整数键哈希到同一个桶
+struct SingleBucketHash {
+    uint32_t operator()(int) const { return 7; }
+};
+
+/**
+ * @brief map 与 reference 的元素完全相同：大小一致，reference 的每个键都能查到相同的值，遍历只访问 reference 中的键
+ * @param stage 不一致时输出的阶段名
+ */
+template <typename Map>
+bool matches(Map& map, const std::unordered_map<int, int>& reference, const char* stage) {
+    if (map.size() != reference.size()) {
+        std::cout << stage << ": size " << map.size() << ", expected " << reference.size() << "\n";
+        return false;
+    }
+    for (auto& kv : reference) {
+        auto it = map.find(kv.first);
+        if (it == map.end() || it->second != kv.second) {
+            std::cout << stage << ": missing key " << kv.first << "\n";
+            return false;
+        }
+    }
+    size_t visited = 0;
+    for (auto& kv : map) {
+        if (reference.count(kv.first) == 0) return false;
+        ++visited;
+    }
+    return visited == reference.size();
+}
+
+#endif  // HASHMAP_TEST_FUNCTIONAL_TEST_COMMON_HPP
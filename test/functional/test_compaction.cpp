@@ -0,0 +1,150 @@
+#include "hashmap.hpp"
+#include "test_common.hpp"
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <random>
+
+template <typename Map>
+bool check_shrink(Map& map, int n, const char* name) {
+    std::unordered_map<int, int> reference;
+    for (int i = 0; i < n; ++i) {
+        map.insert(i, i);
+        reference[i] = i;
+    }
+    size_t peak_buckets = map.bucket_count();
+
+    // 大量删除后整理，只剩少数元素
+    for (int i = 0; i < n; ++i) {
+        if (i % 50 != 0) {
+            map.erase(i);
+            reference.erase(i);
+        }
+    }
+    map.compact();
+    if (!matches(map, reference, name) || map.bucket_count() != peak_buckets) return false;
+
+    // 桶数不会增加；冲突严重、只用到少数桶的表本来就只有最小桶数
+    map.shrink_to_fit();
+    size_t expected_max = peak_buckets > 16 ? peak_buckets - 1 : 16;
+    if (!matches(map, reference, name) || map.bucket_count() > expected_max) {
+        std::cout << name << ": shrink_to_fit kept " << map.bucket_count() << " buckets\n";
+        return false;
+    }
+
+    // 收缩后继续插入，再次扩展
+    for (int i = 0; i < n; i += 3) {
+        map.insert(i, -i);
+        reference[i] = -i;
+    }
+    if (!matches(map, reference, name)) return false;
+    map.clear();
+    map.shrink_to_fit();
+    return map.empty() && map.bucket_count() == 16 && map.begin() == map.end();
+}
+
+// compact / shrink_to_fit 保留所有元素并释放多余的箱子；开启自动收缩后删除和 clear 触发收缩
+int main() {
+    std::cout << "=== Testing compaction and shrink_to_fit ===\n";
+
+    HashMap<int, int> box_map;
+    if (!check_shrink(box_map, 200000, "box")) return 1;
+
+    HashMap<int, int, CollidingHash> tree_map;
+    if (!check_shrink(tree_map, 3000, "tree")) return 1;
+
+    FlatHashMap<int, int> flat_map;
+    if (!check_shrink(flat_map, 200000, "flat")) return 1;
+
+    // 渐进式合并进行到一半时整理
+    {
+        HashMap<int, int> map;
+        std::unordered_map<int, int> reference;
+        std::mt19937 rng(777);
+        std::uniform_int_distribution<int> key_dist(0, 50000);
+        for (int step = 0; step < 80000; ++step) {
+            int key = key_dist(rng);
+            if (step % 3 == 0) {
+                map.erase(key);
+                reference.erase(key);
+            } else {
+                map.insert(key, step);
+                reference[key] = step;
+            }
+            if (step % 7919 == 0) {
+                map.compact();
+                if (!matches(map, reference, "mid-migration compact")) return 1;
+            }
+        }
+        map.shrink_to_fit();
+        if (!matches(map, reference, "mid-migration shrink")) return 1;
+    }
+
+    // 只能移动的值类型: 整理时桶逐个移动，不需要拷贝构造
+    {
+        HashMap<int, std::unique_ptr<int>> map;
+        HashMap<int, std::unique_ptr<int>, CollidingHash> tree_map;
+        for (int i = 0; i < 20000; ++i) {
+            map.try_emplace(i, std::make_unique<int>(i));
+            if (i < 2000) tree_map.try_emplace(i, std::make_unique<int>(i));
+        }
+        for (int i = 0; i < 20000; ++i) {
+            if (i % 10 != 0) {
+                map.erase(i);
+                if (i < 2000) tree_map.erase(i);
+            }
+        }
+        map.compact();
+        tree_map.compact();
+        if (map.size() != 2000 || tree_map.size() != 200) return 1;
+        for (int i = 0; i < 20000; i += 10) {
+            auto it = map.find(i);
+            if (it == map.end() || *it->second != i) {
+                std::cout << "move-only compact lost key " << i << "\n";
+                return 1;
+            }
+            if (i < 2000 && (tree_map.find(i) == tree_map.end() || *tree_map.find(i)->second != i)) return 1;
+        }
+    }
+
+    // 自动收缩
+    {
+        HashMap<int, int> map;
+        map.auto_shrink(true);
+        HashMap<int, int> copy(map);
+        if (!copy.auto_shrink()) return 1;
+
+        std::unordered_map<int, int> reference;
+        for (int i = 0; i < 100000; ++i) {
+            map.insert(i, i);
+            reference[i] = i;
+        }
+        size_t peak_buckets = map.bucket_count();
+        for (int i = 0; i < 99000; ++i) {
+            map.erase(i);
+            reference.erase(i);
+        }
+        if (map.bucket_count() >= peak_buckets) {
+            std::cout << "Auto shrink did not trigger: " << map.bucket_count() << " buckets\n";
+            return 1;
+        }
+        if (!matches(map, reference, "auto shrink")) return 1;
+
+        // 每天清空一次的表回到最小桶数
+        for (int i = 0; i < 100000; ++i) map.insert(i, i);
+        map.clear();
+        if (!map.empty() || map.bucket_count() != 16) return 1;
+        map.insert(1, 1);
+        if (map[1] != 1) return 1;
+
+        // 关闭后 clear 保持桶数
+        map.auto_shrink(false);
+        for (int i = 0; i < 100000; ++i) map.insert(i, i);
+        size_t buckets = map.bucket_count();
+        map.clear();
+        if (map.bucket_count() != buckets) return 1;
+    }
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include "concurrent_hashmap.hpp"
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ConcurrentHashMap: 多线程插入、查找、删除、compute 的结果与串行执行一致，并发扩容不丢元素
+int main() {
+    std::cout << "=== Testing ConcurrentHashMap ===\n";
+
+    const int thread_count = 8;
+    const int per_thread = 20000;
+
+    // 各线程插入不相交的键，期间追加箱子并多次扩容
+    ConcurrentHashMap<int, int> map;
+    {
+        std::vector<std::thread> workers;
+        for (int t = 0; t < thread_count; ++t) {
+            workers.emplace_back([&map, t] {
+                for (int i = 0; i < per_thread; ++i) map.insert(t * per_thread + i, i);
+            });
+        }
+        for (auto& worker : workers) worker.join();
+    }
+    if (map.size() != static_cast<size_t>(thread_count * per_thread)) {
+        std::cout << "Lost inserts: " << map.size() << "\n";
+        return 1;
+    }
+    for (int k = 0; k < thread_count * per_thread; ++k) {
+        int value = -1;
+        if (!map.find(k, value) || value != k % per_thread) return 1;
+    }
+
+    // insert 不覆盖，insert_or_assign 覆盖
+    if (map.insert(5, 100)) return 1;
+    int value = 0;
+    if (!map.find(5, value) || value != 5) return 1;
+    if (map.insert_or_assign(5, 100) || !map.find(5, value) || value != 100) return 1;
+
+    // 并发删除一半，同时其他线程查找
+    {
+        std::atomic<bool> bad{false};
+        std::vector<std::thread> workers;
+        for (int t = 0; t < thread_count; ++t) {
+            workers.emplace_back([&, t] {
+                for (int i = 0; i < per_thread; i += 2) {
+                    if (!map.erase(t * per_thread + i)) bad = true;
+                }
+                for (int i = 1; i < per_thread; i += 2) {
+                    if (!map.contains(((t + 1) % thread_count) * per_thread + i)) bad = true;
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        if (bad || map.size() != static_cast<size_t>(thread_count * per_thread / 2)) return 1;
+    }
+
+    // compute: 多个线程对少量键原子地累加
+    ConcurrentHashMap<std::string, long> counters;
+    {
+        const int rounds = 5000;
+        std::vector<std::thread> workers;
+        for (int t = 0; t < thread_count; ++t) {
+            workers.emplace_back([&] {
+                for (int i = 0; i < rounds; ++i) {
+                    counters.compute("key" + std::to_string(i % 16), [](long& v) { ++v; return true; });
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        long total = 0;
+        for (int k = 0; k < 16; ++k) {
+            long v = 0;
+            if (!counters.find("key" + std::to_string(k), v)) return 1;
+            total += v;
+        }
+        if (total != static_cast<long>(thread_count) * rounds) {
+            std::cout << "compute lost updates: " << total << "\n";
+            return 1;
+        }
+    }
+
+    // compute 返回 false 删除键，键不存在时不插入
+    if (counters.compute("key0", [](long&) { return false; }) || counters.contains("key0")) return 1;
+    if (counters.compute("absent", [](long&) { return false; }) || counters.contains("absent")) return 1;
+    if (!counters.try_emplace("fresh", 7) || counters.try_emplace("fresh", 8)) return 1;
+
+    counters.clear();
+    if (!counters.empty() || counters.contains("key1")) return 1;
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
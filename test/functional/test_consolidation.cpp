@@ -0,0 +1,79 @@
+#include "hashmap.hpp"
+#include <iostream>
+#include <unordered_map>
+#include <random>
+
+// 随机插入/删除/查找与 std::unordered_map 对照，期间会多次触发渐进式合并，
+// 覆盖合并进行到一半时的插入、查找和删除
+int main() {
+    std::cout << "=== Testing incremental box consolidation ===\n";
+
+    HashMap<int, int> map;
+    std::unordered_map<int, int> reference;
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> key_dist(0, 20000);
+    std::uniform_int_distribution<int> op_dist(0, 9);
+
+    size_t last_bucket_count = map.bucket_count();
+    int consolidations = 0;
+
+    for (int step = 0; step < 60000; ++step) {
+        int key = key_dist(rng);
+        int op = op_dist(rng);
+        if (op < 6) {
+            auto result = map.insert(key, step);
+            bool inserted = reference.find(key) == reference.end();
+            reference[key] = step;
+            if (result.second != inserted || result.first->second != step) {
+                std::cout << "Insert mismatch at step " << step << "\n";
+                return 1;
+            }
+        } else if (op < 8) {
+            if (map.erase(key) != (reference.erase(key) == 1)) {
+                std::cout << "Erase mismatch at step " << step << "\n";
+                return 1;
+            }
+        } else {
+            auto it = map.find(key);
+            auto ref = reference.find(key);
+            if ((it == map.end()) != (ref == reference.end()) ||
+                (it != map.end() && it->second != ref->second)) {
+                std::cout << "Find mismatch at step " << step << "\n";
+                return 1;
+            }
+        }
+
+        if (map.bucket_count() != last_bucket_count) {
+            last_bucket_count = map.bucket_count();
+            ++consolidations;
+        }
+        if (map.size() != reference.size()) {
+            std::cout << "Size mismatch at step " << step << "\n";
+            return 1;
+        }
+    }
+
+    std::cout << "Consolidations: " << consolidations << ", final bucket count: " << map.bucket_count() << "\n";
+    if (consolidations == 0) return 1;
+
+    size_t iterated = 0;
+    for (const auto& pair : map) {
+        auto ref = reference.find(pair.first);
+        if (ref == reference.end() || ref->second != pair.second) {
+            std::cout << "Iteration mismatch for key " << pair.first << "\n";
+            return 1;
+        }
+        ++iterated;
+    }
+    if (iterated != reference.size()) return 1;
+
+    // 拷贝合并中途的表
+    HashMap<int, int> copy(map);
+    if (copy.size() != map.size()) return 1;
+    for (const auto& pair : reference) {
+        if (copy.find(pair.first) == copy.end()) return 1;
+    }
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
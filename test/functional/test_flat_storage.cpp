@@ -0,0 +1,100 @@
+#include "hashmap.hpp"
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+// 平坦表存储引擎: 与 std::unordered_map 对比随机插入、删除(产生墓碑)、查找和遍历
+template <typename Map>
+static bool same_contents(const Map& map, const std::unordered_map<int, int>& ref) {
+    if (map.size() != ref.size()) return false;
+    size_t iterated = 0;
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        auto found = ref.find(it->first);
+        if (found == ref.end() || found->second != it->second) return false;
+        ++iterated;
+    }
+    return iterated == ref.size();
+}
+
+int main() {
+    std::cout << "=== Testing flat storage engine ===\n";
+
+    FlatHashMap<int, int> map;
+    std::unordered_map<int, int> ref;
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> key_dist(0, 20000);
+
+    for (int op = 0; op < 100000; ++op) {
+        int key = key_dist(rng);
+        switch (rng() % 4) {
+            case 0:
+            case 1: {
+                bool inserted = map.insert(key, op).second;
+                bool expected = ref.find(key) == ref.end();
+                ref[key] = op;
+                if (inserted != expected) {
+                    std::cout << "Insert mismatch for key " << key << "\n";
+                    return 1;
+                }
+                break;
+            }
+            case 2:
+                if (map.erase(key) != (ref.erase(key) == 1)) {
+                    std::cout << "Erase mismatch for key " << key << "\n";
+                    return 1;
+                }
+                break;
+            default: {
+                auto it = map.find(key);
+                auto expected = ref.find(key);
+                if ((it == map.end()) != (expected == ref.end()) ||
+                    (it != map.end() && it->second != expected->second)) {
+                    std::cout << "Find mismatch for key " << key << "\n";
+                    return 1;
+                }
+            }
+        }
+    }
+    std::cout << "Size: " << map.size() << ", slots: " << map.bucket_count() << "\n";
+    if (!same_contents(map, ref)) {
+        std::cout << "Contents differ after random operations\n";
+        return 1;
+    }
+
+    // 拷贝、移动与按迭代器删除
+    FlatHashMap<int, int> copy(map);
+    if (!same_contents(copy, ref)) return 1;
+    FlatHashMap<int, int> moved(std::move(copy));
+    if (!same_contents(moved, ref) || !copy.empty()) return 1;
+
+    for (auto it = moved.begin(); it != moved.end(); ) {
+        if (it->first % 2 == 0) {
+            ref.erase(it->first);
+            it = moved.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (!same_contents(moved, ref)) {
+        std::cout << "Contents differ after erase by iterator\n";
+        return 1;
+    }
+
+    // 字符串键、operator[]、at、emplace
+    FlatHashMap<std::string, int> words = {{"apple", 1}, {"banana", 2}};
+    words["cherry"] = 3;
+    words.emplace("durian", 4);
+    if (words.size() != 4 || words.at("banana") != 2 || !words.contains("durian")) return 1;
+    try {
+        words.at("missing");
+        return 1;
+    } catch (const std::out_of_range&) {
+    }
+
+    words.clear();
+    if (!words.empty() || words.begin() != words.end()) return 1;
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
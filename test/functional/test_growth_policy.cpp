@@ -0,0 +1,118 @@
+#include "hashmap.hpp"
+#include "test_common.hpp"
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+
+// 随机插入/删除，检查负载因子不超过设定值、每次合并后桶数至少按 growth_factor 倍增
+bool run_policy(const hashmap_storage::growth_policy& policy, const char* name) {
+    HashMap<int, int> map;
+    map.set_growth_policy(policy);
+    std::unordered_map<int, int> reference;
+    std::mt19937 rng(2024);
+    std::uniform_int_distribution<int> key_dist(0, 200000);
+
+    size_t buckets = map.bucket_count();
+    for (int step = 0; step < 150000; ++step) {
+        int key = key_dist(rng);
+        if (step % 4 == 3) {
+            map.erase(key);
+            reference.erase(key);
+        } else {
+            map.insert(key, step);
+            reference[key] = step;
+        }
+        if (map.load_factor() > policy.max_load_factor + 1.0 / map.bucket_count()) {
+            std::cout << name << ": load factor " << map.load_factor() << " above " << policy.max_load_factor << "\n";
+            return false;
+        }
+        if (map.bucket_count() != buckets) {
+            if (map.bucket_count() < buckets * policy.growth_factor) {
+                std::cout << name << ": grew from " << buckets << " to " << map.bucket_count() << "\n";
+                return false;
+            }
+            buckets = map.bucket_count();
+        }
+    }
+    if (!matches(map, reference, name)) return false;
+
+    // 拷贝、移动和重建保留增长策略
+    HashMap<int, int> copy(map);
+    HashMap<int, int> moved(std::move(copy));
+    moved.rehash(0);
+    const auto& kept = moved.get_growth_policy();
+    return kept.max_load_factor == policy.max_load_factor && kept.max_box_count == policy.max_box_count &&
+           kept.growth_factor == policy.growth_factor && matches(moved, reference, name);
+}
+
+// 增长策略: 运行时的最大负载因子、主箱数量上限和合并时的倍增系数
+int main() {
+    std::cout << "=== Testing configurable growth policy ===\n";
+
+    HashMap<int, int> defaults;
+    if (defaults.max_load_factor() != 0.75 || defaults.get_growth_policy().max_box_count != 4 ||
+        defaults.get_growth_policy().growth_factor != 2) return 1;
+
+    if (!run_policy(hashmap_storage::growth_policy{}, "default")) return 1;
+    if (!run_policy(hashmap_storage::growth_policy{0.5, 4, 2}, "load 0.5")) return 1;
+    if (!run_policy(hashmap_storage::growth_policy{0.9, 1, 4}, "single box, x4")) return 1;
+    if (!run_policy(hashmap_storage::growth_policy{0.75, 16, 2}, "sixteen boxes")) return 1;
+
+    // 负载因子为1时，所有桶都非空后仍然扩展
+    {
+        HashMap<int, int> full;
+        full.max_load_factor(1.0);
+        size_t initial = full.bucket_count();
+        for (int i = 0; i < 100000; ++i) full.insert(i, i);
+        if (full.bucket_count() <= initial || full.size() != 100000) {
+            std::cout << "load 1.0: bucket count stayed at " << full.bucket_count() << "\n";
+            return 1;
+        }
+    }
+    if (!run_policy(hashmap_storage::growth_policy{1.0, 4, 2}, "load 1.0")) return 1;
+
+    // max_load_factor(double) 生效，并影响预留的桶数
+    HashMap<int, int> sparse;
+    sparse.max_load_factor(0.25);
+    if (sparse.max_load_factor() != 0.25) return 1;
+    sparse.reserve(1000);
+    if (sparse.bucket_count() < 4000) return 1;
+
+    // 非法参数
+    int rejected = 0;
+    auto expect_throw = [&](const hashmap_storage::growth_policy& policy) {
+        try {
+            sparse.set_growth_policy(policy);
+        } catch (const std::invalid_argument&) {
+            rejected++;
+        }
+    };
+    expect_throw(hashmap_storage::growth_policy{0.0, 4, 2});
+    expect_throw(hashmap_storage::growth_policy{1.5, 4, 2});
+    expect_throw(hashmap_storage::growth_policy{0.75, 0, 2});
+    expect_throw(hashmap_storage::growth_policy{0.75, 4, 3});
+    expect_throw(hashmap_storage::growth_policy{0.75, 4, 1});
+    if (rejected != 5 || sparse.max_load_factor() != 0.25) return 1;
+
+    // 平坦表的最大负载因子
+    FlatHashMap<int, int> flat;
+    for (int i = 0; i < 1000; ++i) flat.insert(i, i);
+    flat.max_load_factor(0.5);
+    if (flat.max_load_factor() != 0.5 || flat.load_factor() > 0.5) return 1;
+    for (int i = 1000; i < 50000; ++i) {
+        flat.insert(i, i);
+        if (flat.load_factor() > 0.5) return 1;
+    }
+    if (flat.size() != 50000 || flat[49999] != 49999) return 1;
+    bool flat_rejected = false;
+    try {
+        flat.max_load_factor(0.95);
+    } catch (const std::invalid_argument&) {
+        flat_rejected = true;
+    }
+    if (!flat_rejected) return 1;
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include "hashmap.hpp"
+#include <iostream>
+#include <string>
+#include <string_view>
+
+// 异构查找: 哈希器与键相等比较器都声明 is_transparent 时，可以用 std::string_view / C 字符串查找 std::string 键
+struct NoDefault {
+    int value;
+    explicit NoDefault(int v) : value(v) {}
+};
+
+// 所有键落在同一个桶中，覆盖有序数组和红黑树形式的桶
+struct CollidingHash {
+    using is_transparent = void;
+    uint32_t operator()(std::string_view) const { return 5; }
+};
+
+static_assert(utils::is_transparent<utils::hash<std::string>>::value, "string hash should be transparent");
+static_assert(!utils::is_transparent<std::equal_to<std::string>>::value, "std::equal_to<T> is not transparent");
+
+template <typename Map>
+static bool check(Map& map, int count) {
+    for (int i = 0; i < count; ++i) map.insert("key" + std::to_string(i), NoDefault(i));
+
+    std::string buffer = "prefix:key7:suffix";
+    std::string_view view = std::string_view(buffer).substr(7, 4);
+    auto it = map.find(view);
+    if (it == map.end() || it->second.value != 7) return false;
+    if (!map.contains(view) || map.contains(std::string_view("missing"))) return false;
+    if (map.at("key3").value != 3) return false;
+
+    const Map& cmap = map;
+    if (cmap.find(std::string_view("key5")) == cmap.end() || cmap.at(std::string_view("key5")).value != 5) return false;
+
+    try {
+        map.at(std::string_view("missing"));
+        return false;
+    } catch (const std::out_of_range&) {}
+
+    if (!map.erase(std::string_view("key7")) || map.erase("key7") || map.contains(view)) return false;
+    for (int i = 0; i < count; ++i) {
+        if (i != 7 && !map.contains(std::string_view("key" + std::to_string(i)))) return false;
+    }
+    return map.size() == static_cast<size_t>(count - 1);
+}
+
+int main() {
+    std::cout << "=== Testing heterogeneous lookup ===\n";
+
+    HashMap<std::string, NoDefault, utils::hash<std::string>, std::equal_to<>> box_map;
+    if (!check(box_map, 1000)) return 1;
+
+    HashMap<std::string, NoDefault, CollidingHash, std::equal_to<>> small_bucket, tree_bucket;
+    if (!check(small_bucket, 8) || !check(tree_bucket, 40)) return 1;
+
+    FlatHashMap<std::string, NoDefault, utils::hash<std::string>, std::equal_to<>> flat_map;
+    if (!check(flat_map, 1000)) return 1;
+
+    // 默认的 std::equal_to<Key> 不透明，查找参数仍转换为 Key
+    HashMap<std::string, int> plain;
+    plain.insert("a", 1);
+    if (plain.find("a") == plain.end() || !plain.contains(std::string("a"))) return 1;
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
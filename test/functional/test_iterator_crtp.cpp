@@ -0,0 +1,55 @@
+#include "hashmap.hpp"
+#include "utils/queue.hpp"
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <type_traits>
+
+// 迭代器静态分派: 没有虚函数表，后置自增/自减返回旧位置的副本
+static_assert(!std::is_polymorphic<HashMap<int, int>::iterator>::value, "iterator should not carry a vptr");
+static_assert(!std::is_polymorphic<FlatHashMap<int, int>::iterator>::value, "iterator should not carry a vptr");
+static_assert(!std::is_polymorphic<utils::rbtree<int>::iterator>::value, "iterator should not carry a vptr");
+static_assert(!std::is_polymorphic<utils::static_deque<int>::iterator>::value, "iterator should not carry a vptr");
+static_assert(std::is_same<decltype(std::declval<HashMap<int, int>::iterator&>()++), HashMap<int, int>::iterator>::value,
+              "post-increment returns a copy");
+static_assert(std::is_same<decltype(++std::declval<HashMap<int, int>::iterator&>()), HashMap<int, int>::iterator&>::value,
+              "pre-increment returns a reference");
+static_assert(std::is_same<std::iterator_traits<HashMap<int, int>::iterator>::iterator_category,
+                           std::bidirectional_iterator_tag>::value, "bidirectional iterator");
+
+template <typename Map>
+static bool check_map(Map& map) {
+    for (int i = 0; i < 200; ++i) map.insert(i, i * 2);
+
+    std::set<int> seen;
+    for (auto it = map.begin(); it != map.end(); it++) {
+        if (it->second != it->first * 2 || !seen.insert(it->first).second) return false;
+    }
+    if (seen.size() != 200) return false;
+
+    auto it = map.begin();
+    auto old = it++;
+    if (old != map.begin() || old == it) return false;
+    auto back = it--;
+    if (it != map.begin() || back == it) return false;
+    return std::distance(map.begin(), map.end()) == 200;
+}
+
+int main() {
+    std::cout << "=== Testing CRTP iterators ===\n";
+
+    HashMap<int, int> box_map;
+    FlatHashMap<int, int> flat_map;
+    if (!check_map(box_map) || !check_map(flat_map)) return 1;
+
+    utils::rbtree<int> tree;
+    for (int i = 0; i < 100; ++i) tree.push(99 - i);
+    int expected = 0;
+    for (auto it = tree.begin(); it != tree.end(); it++) {
+        if (*it != expected++) return 1;
+    }
+    if (expected != 100) return 1;
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include "hashmap.hpp"
+#include "test_common.hpp"
+#include <iostream>
+
+// 全量扫描的统计与箱子一级的计数一致
+template <typename Map>
+bool consistent(const Map& map, const char* stage) {
+    utils::map_stats info = map.stats();
+    unsigned long long used = 0;
+    for (const auto& box : info.boxes) {
+        if (box.used_buckets > box.capacity) return false;
+        used += box.used_buckets;
+    }
+    unsigned long long histogram_buckets = 0;
+    for (auto n : info.size_histogram) histogram_buckets += n;
+    if (info.scanned_elements != map.size() || info.scanned_buckets != used || histogram_buckets != used) {
+        std::cout << stage << ": scanned " << info.scanned_elements << " elements in " << info.scanned_buckets
+                  << " buckets, expected " << map.size() << " in " << used << "\n";
+        return false;
+    }
+    if (info.scanned_positions != info.total_positions || info.total_positions != map.bucket_count()) return false;
+    if (map.size() && (info.avg_boxes_per_hit < 1.0 || info.avg_boxes_per_hit > info.max_boxes_per_lookup)) {
+        std::cout << stage << ": average boxes per hit " << info.avg_boxes_per_hit << "\n";
+        return false;
+    }
+    if (info.avg_boxes_per_miss > info.max_boxes_per_lookup) return false;
+    for (size_t i = 1; i < info.hot_buckets.size(); ++i) {
+        if (info.hot_buckets[i - 1].size < info.hot_buckets[i].size) return false;
+    }
+    return info.hot_buckets.size() <= info.hot_limit;
+}
+
+// stats() 报告每个箱子的占用率、桶大小和树高直方图、查找访问的箱子数和热点桶；支持抽样
+int main() {
+    std::cout << "=== Testing structural statistics ===\n";
+
+    // 增长过程中多次全量统计，覆盖追加箱子和渐进式合并
+    // 合并进行中的状态只抽样一个桶下标来判断，每次合并开始后全量统计一次
+    HashMap<int, int> map;
+    int migrations_checked = 0;
+    bool was_migrating = false;
+    for (int i = 0; i < 200000; ++i) {
+        map.insert(i, i);
+        bool migrating = map.stats(1, 0).migrating;
+        if ((migrating && !was_migrating) || i % 4999 == 0) {
+            if (!consistent(map, migrating ? "migration" : "insert")) return 1;
+            migrations_checked += migrating && !was_migrating;
+        }
+        was_migrating = migrating;
+    }
+    if (migrations_checked == 0) return 1;
+    for (int i = 0; i < 200000; i += 3) map.erase(i);
+    if (!consistent(map, "erase")) return 1;
+
+    // 只有一个主箱时命中只访问一个箱子
+    map.shrink_to_fit();
+    utils::map_stats single = map.stats();
+    if (single.boxes.size() != 1 || single.avg_boxes_per_hit != 1.0 || single.max_boxes_per_lookup != 1) return 1;
+    if (single.element_load != static_cast<double>(map.size()) / map.bucket_count()) return 1;
+
+    // 抽样
+    utils::map_stats sampled = map.stats(1024, 3);
+    if (sampled.scanned_positions < 1024 || sampled.scanned_positions > 2048 ||
+        sampled.scanned_elements >= map.size() || sampled.hot_buckets.size() > 3) {
+        std::cout << "Sampled " << sampled.scanned_positions << " positions\n";
+        return 1;
+    }
+    if (sampled.boxes.size() != single.boxes.size() || sampled.boxes[0].used_buckets != single.boxes[0].used_buckets) return 1;
+
+    // 冲突严重的桶出现在热点列表中，并记录红黑树高度
+    HashMap<int, int, CollidingHash> colliding;
+    for (int i = 0; i < 4000; ++i) colliding.insert(i, i);
+    if (!consistent(colliding, "colliding")) return 1;
+    utils::map_stats hot = colliding.stats(0, 2);
+    if (hot.hot_buckets.size() != 2 || hot.hot_buckets[0].size < 1000 || hot.hot_buckets[0].height == 0) return 1;
+    unsigned long long trees = 0;
+    for (auto n : hot.height_histogram) trees += n;
+    if (trees == 0) return 1;
+
+    HashMap<int, int> empty;
+    if (!consistent(empty, "empty") || empty.stats().avg_boxes_per_hit != 0.0) return 1;
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include "hashmap.hpp"
+#include "test_common.hpp"
+#include <iostream>
+#include <memory>
+#include <string>
+
+// 记录经过表自身分配器申请、尚未释放的字节数
+static unsigned long long live_bytes = 0;
+
+template <typename T>
+struct counting_allocator {
+    using value_type = T;
+
+    counting_allocator() = default;
+    template <typename U>
+    counting_allocator(const counting_allocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        live_bytes += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n) noexcept {
+        live_bytes -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const counting_allocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const counting_allocator<U>&) const noexcept { return false; }
+};
+
+// 经过表自身分配器的各项（桶数组、位图、小数组、红黑树、箱链表节点）之和应等于实际申请的字节数
+template <typename Map>
+bool accounted(const Map& map, const char* stage) {
+    utils::memory_report report = map.memory_usage();
+    unsigned long long through_allocator =
+        report.bucket_arrays + report.bitmaps + report.small_arrays + report.tree_nodes + report.box_list;
+    if (through_allocator != live_bytes) {
+        std::cout << stage << ": reported " << through_allocator << " bytes, allocator holds " << live_bytes << "\n";
+        return false;
+    }
+    unsigned long long sum = report.object + report.bucket_arrays + report.bitmaps + report.directory +
+                             report.small_arrays + report.tree_nodes + report.box_list;
+    if (report.total != sum || report.exact || report.comparators > report.bucket_arrays) return false;
+    if (map.size() && report.bytes_per_element != static_cast<double>(report.total) / map.size()) return false;
+    return true;
+}
+
+// memory_usage 按组成部分报告字节数，与分配器实际申请的字节数一致
+int main() {
+    std::cout << "=== Testing memory accounting ===\n";
+
+    {
+        using CountedMap = HashMap<int, std::string, utils::hash<int>, std::equal_to<int>,
+                                   counting_allocator<std::pair<const int, std::string>>>;
+        CountedMap map;
+        if (!accounted(map, "empty")) return 1;
+
+        // 插入过程中多次检查，覆盖追加箱子和渐进式合并
+        for (int i = 0; i < 100000; ++i) {
+            map.insert(i, "v");
+            if (i % 7777 == 0 && !accounted(map, "insert")) return 1;
+        }
+        for (int i = 0; i < 100000; i += 3) map.erase(i);
+        if (!accounted(map, "erase")) return 1;
+        map.compact();
+        if (!accounted(map, "compact")) return 1;
+        map.shrink_to_fit();
+        if (!accounted(map, "shrink")) return 1;
+        map.clear();
+        if (!accounted(map, "clear")) return 1;
+    }
+    if (live_bytes != 0) return 1;
+
+    {
+        using TreeMap = HashMap<int, int, CollidingHash, std::equal_to<int>,
+                                counting_allocator<std::pair<const int, int>>>;
+        TreeMap map;
+        for (int i = 0; i < 2000; ++i) map.insert(i, i);
+        utils::memory_report report = map.memory_usage();
+        if (report.tree_nodes == 0 || !accounted(map, "tree")) return 1;
+    }
+
+    // std::allocator 的报告是精确值；内联元素计入桶数组
+    HashMap<int, int> plain;
+    for (int i = 0; i < 10000; ++i) plain.insert(i, i);
+    utils::memory_report report = plain.memory_usage();
+    if (!report.exact || report.total < 10000 * sizeof(std::pair<int, int>) || report.bytes_per_element <= 0) return 1;
+    if (report.bucket_arrays < plain.bucket_count() * sizeof(std::pair<int, int>)) return 1;
+
+    FlatHashMap<int, int> flat;
+    for (int i = 0; i < 10000; ++i) flat.insert(i, i);
+    utils::memory_report flat_report = flat.memory_usage();
+    if (flat_report.bucket_arrays != flat.bucket_count() * sizeof(std::pair<int, int>) ||
+        flat_report.bitmaps != flat.bucket_count() || flat_report.tree_nodes != 0) return 1;
+
+    std::cout << "HashMap: " << report.bytes_per_element << " bytes/element, FlatHashMap: "
+              << flat_report.bytes_per_element << " bytes/element\n";
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include "hashmap.hpp"
+#include "utils/mempool.hpp"
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// mempool_allocator: 作为红黑树节点分配器，以及跨线程分配/释放
+int main() {
+    std::cout << "=== Testing mempool_allocator ===\n";
+
+    // 红黑树节点从内存池分配
+    {
+        utils::rbtree<int, std::less<int>, std::equal_to<int>, utils::mempool_allocator<int>> tree;
+        for (int round = 0; round < 20; ++round) {
+            for (int i = 0; i < 1000; ++i) tree.push(i);
+            if (tree.size() != 1000) return 1;
+            for (int i = 0; i < 1000; i += 2) tree.remove(i);
+            if (tree.size() != 500 || tree.find(2) || !tree.find(3)) return 1;
+            for (int i = 1; i < 1000; i += 2) tree.remove(i);
+            if (tree.size() != 0) return 1;
+        }
+    }
+
+    // 比较器和分配器都是空类时，红黑树只有根指针和元素个数
+    static_assert(sizeof(utils::rbtree<int, std::less<int>, std::equal_to<int>, utils::mempool_allocator<int>>)
+                  == sizeof(void*) + sizeof(unsigned long long), "empty functors should not take space");
+
+    // 桶也一样: 空的比较器、相等比较器和分配器不占空间，桶只有元素/指针的联合体和计数、形式
+    {
+        using bucket_type = HashMap<int, int>::bucket_type;
+        using stored_pair = HashMap<int, int>::stored_pair;
+        struct bucket_layout {
+            union {
+                alignas(stored_pair) unsigned char inline_storage[sizeof(stored_pair)];
+                void* pointer;
+            };
+            uint32_t count;
+            uint8_t array_capacity;
+            uint8_t form;
+        };
+        static_assert(sizeof(bucket_type) == sizeof(bucket_layout), "empty bucket functors should not take space");
+    }
+
+    // 释放的块被重复使用
+    {
+        utils::mempool_allocator<long> alloc;
+        long* first = alloc.allocate(1);
+        alloc.deallocate(first, 1);
+        long* second = alloc.allocate(1);
+        if (first != second) {
+            std::cout << "Freed block was not reused\n";
+            return 1;
+        }
+        alloc.deallocate(second, 1);
+
+        long* array = alloc.allocate(16);
+        for (int i = 0; i < 16; ++i) array[i] = i;
+        alloc.deallocate(array, 16);
+    }
+
+    // 一个线程分配、另一个线程释放，多个线程同时插入删除
+    {
+        utils::mempool_allocator<std::pair<int, int>> alloc;
+        std::vector<std::pair<int, int>*> blocks;
+        std::thread producer([&] {
+            for (int i = 0; i < 10000; ++i) {
+                auto* p = alloc.allocate(1);
+                p->first = i;
+                blocks.push_back(p);
+            }
+        });
+        producer.join();
+        std::thread consumer([&] {
+            for (size_t i = 0; i < blocks.size(); ++i) {
+                if (blocks[i]->first != static_cast<int>(i)) std::abort();
+                alloc.deallocate(blocks[i], 1);
+            }
+        });
+        consumer.join();
+
+        std::vector<std::thread> workers;
+        bool ok[4] = {true, true, true, true};
+        for (int t = 0; t < 4; ++t) {
+            workers.emplace_back([t, &ok] {
+                HashMap<int, int, utils::hash<int>, std::equal_to<int>,
+                        utils::mempool_allocator<std::pair<const int, int>>> map;
+                for (int round = 0; round < 5; ++round) {
+                    for (int i = 0; i < 2000; ++i) map.insert(i, i + t);
+                    for (int i = 0; i < 2000; ++i) {
+                        auto it = map.find(i);
+                        if (it == map.end() || it->second != i + t) ok[t] = false;
+                    }
+                    for (int i = 0; i < 2000; ++i) map.erase(i);
+                    if (!map.empty()) ok[t] = false;
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        for (bool b : ok) if (!b) return 1;
+    }
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include "hashmap.hpp"
+#include "test_common.hpp"
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+template <typename Map>
+size_t count_sequential(Map& map, int modulus) {
+    size_t n = 0;
+    for (auto& kv : map) n += kv.first % modulus == 0;
+    return n;
+}
+
+template <typename Map>
+bool check_map(Map& map, utils::work_stealing_pool& pool, int n, const char* name) {
+    // 插入过程中多次并行统计，覆盖追加箱子和渐进式合并的各个阶段
+    for (int i = 0; i < n; ++i) {
+        map.insert(i, i);
+        if (i % 9973 == 0 && map.parallel_count_if([](const auto& kv) { return kv.first % 3 == 0; }, pool) !=
+                                 count_sequential(map, 3)) {
+            std::cout << name << ": count_if mismatch at " << i << "\n";
+            return false;
+        }
+    }
+
+    map.parallel_transform_values([](const auto& kv) { return kv.second * 2; }, pool);
+    map.parallel_for_each([](auto& kv) { kv.second += 1; }, pool);
+    for (int i = 0; i < n; i += 101) {
+        if (map[i] != i * 2 + 1) {
+            std::cout << name << ": wrong value for " << i << "\n";
+            return false;
+        }
+    }
+
+    size_t expected = count_sequential(map, 5);
+    size_t erased = map.parallel_erase_if([](const auto& kv) { return kv.first % 5 == 0; }, pool);
+    if (erased != expected || map.size() != static_cast<size_t>(n) - expected) {
+        std::cout << name << ": erase_if removed " << erased << ", expected " << expected << "\n";
+        return false;
+    }
+    size_t visited = 0;
+    for (auto& kv : map) {
+        if (kv.first % 5 == 0) return false;
+        ++visited;
+    }
+    if (visited != map.size()) return false;
+    for (int i = 0; i < n; i += 7) {
+        if (map.contains(i) != (i % 5 != 0)) {
+            std::cout << name << ": contains(" << i << ") wrong after erase_if\n";
+            return false;
+        }
+    }
+
+    // 删除后还能正常插入
+    for (int i = 0; i < n; i += 5) map.insert(i, -i);
+    if (map.size() != static_cast<size_t>(n)) return false;
+    return map.parallel_erase_if([](const auto&) { return true; }, pool) == static_cast<size_t>(n) && map.empty();
+}
+
+// 并行 for_each / count_if / transform_values / erase_if 与串行遍历的结果一致；线程池正确划分区间并传递异常
+int main() {
+    std::cout << "=== Testing parallel bulk operations ===\n";
+
+    utils::work_stealing_pool pool(3);
+
+    // parallel_for 恰好覆盖每个下标一次，子区间边界对齐到 grain
+    {
+        std::vector<std::atomic<int>> hits(100003);
+        std::atomic<bool> misaligned{false};
+        pool.parallel_for(0, hits.size(), 64, [&](size_t first, size_t last) {
+            if (first % 64 != 0 || (last % 64 != 0 && last != hits.size())) misaligned = true;
+            for (size_t i = first; i < last; ++i) hits[i]++;
+        });
+        if (misaligned) return 1;
+        for (auto& h : hits) {
+            if (h != 1) return 1;
+        }
+
+        // 任务中再次调用 parallel_for
+        std::atomic<long> sum{0};
+        pool.parallel_for(0, 8, 1, [&](size_t a, size_t) {
+            pool.parallel_for(0, 1000, 10, [&](size_t first, size_t last) {
+                for (size_t i = first; i < last; ++i) sum += static_cast<long>(a);
+            });
+        });
+        if (sum != 1000L * (0 + 1 + 2 + 3 + 4 + 5 + 6 + 7)) return 1;
+
+        bool caught = false;
+        try {
+            pool.parallel_for(0, 1000, 10, [](size_t first, size_t) {
+                if (first == 500) throw std::runtime_error("task failed");
+            });
+        } catch (const std::runtime_error&) {
+            caught = true;
+        }
+        if (!caught) return 1;
+    }
+
+    HashMap<int, int> box_map;
+    if (!check_map(box_map, pool, 200000, "box")) return 1;
+
+    FlatHashMap<int, int> flat_map;
+    if (!check_map(flat_map, pool, 200000, "flat")) return 1;
+
+    // 红黑树桶中的 erase_if
+    HashMap<int, int, CollidingHash> tree_map;
+    if (!check_map(tree_map, pool, 2000, "tree")) return 1;
+
+    // pmr 分配器不能在多个线程中同时使用，erase_if 在调用线程中释放内存
+    {
+        owner_thread_resource resource;
+        HashMap<int, int, utils::hash<int>, std::equal_to<int>,
+                std::pmr::polymorphic_allocator<std::pair<const int, int>>> pmr_map(0, {}, {}, &resource);
+        if (!check_map(pmr_map, pool, 200000, "pmr")) return 1;
+        if (resource.foreign_access) {
+            std::cout << "pmr: memory resource used from a pool thread\n";
+            return 1;
+        }
+    }
+
+    // 默认的共享线程池
+    HashMap<int, int> shared_map;
+    for (int i = 0; i < 1000; ++i) shared_map[i] = i;
+    if (shared_map.parallel_count_if([](const auto& kv) { return kv.second < 10; }) != 10) return 1;
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include "hashmap.hpp"
+#include "test_common.hpp"
+#include <iostream>
+#include <memory_resource>
+#include <string>
+#include <type_traits>
+
+// HashMap 的分配器应当传递到箱、位图、桶内数组和红黑树节点: 使用 std::pmr 时所有内存都来自指定的 memory_resource
+class counting_resource : public std::pmr::memory_resource {
+public:
+    size_t allocations = 0;
+    size_t outstanding = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations;
+        outstanding += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        outstanding -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+template <typename Hash>
+using PmrMap = HashMap<int, int, Hash, std::equal_to<int>,
+                       std::pmr::polymorphic_allocator<std::pair<const int, int>>>;
+
+int main() {
+    std::cout << "=== Testing pmr allocator propagation ===\n";
+
+    counting_resource counting;
+    // 任何没有使用传入分配器的内存分配都会抛出 std::bad_alloc
+    std::pmr::memory_resource* previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+
+    {
+        PmrMap<utils::hash<int>> map(0, {}, {}, &counting);
+        for (int i = 0; i < 5000; ++i) map.insert(i, i);
+        for (int i = 0; i < 5000; i += 3) map.erase(i);
+        for (int i = 0; i < 5000; ++i) {
+            auto it = map.find(i);
+            if ((it != map.end()) != (i % 3 != 0)) return 1;
+        }
+
+        // 所有键落在同一个桶中，使桶转为红黑树
+        PmrMap<SingleBucketHash> colliding(0, {}, {}, &counting);
+        for (int i = 0; i < 100; ++i) colliding.insert(i, i);
+        for (int i = 0; i < 95; ++i) colliding.erase(i);
+        if (colliding.size() != 5 || colliding.find(97) == colliding.end()) return 1;
+
+        FlatHashMap<int, int, utils::hash<int>, std::equal_to<int>,
+                    std::pmr::polymorphic_allocator<std::pair<const int, int>>> flat(0, {}, {}, &counting);
+        for (int i = 0; i < 1000; ++i) flat.insert(i, i);
+        if (flat.size() != 1000) return 1;
+
+        std::cout << "Allocations from resource: " << counting.allocations << "\n";
+        if (counting.allocations == 0) return 1;
+
+        // 不同 memory_resource 之间移动赋值: 保留目标的分配器，逐个复制元素
+        counting_resource other_resource;
+        PmrMap<utils::hash<int>> target(0, {}, {}, &other_resource);
+        target = std::move(map);
+        if (target.get_allocator().resource() != &other_resource) return 1;
+        if (target.size() != 3333 || target.find(1) == target.end() || target.find(3) != target.end()) return 1;
+        if (!map.empty()) return 1;
+
+        // 目标的 memory_resource 耗尽时移动赋值抛出 std::bad_alloc，而不是终止程序
+        using FlatPmrMap = FlatHashMap<int, int, utils::hash<int>, std::equal_to<int>,
+                                       std::pmr::polymorphic_allocator<std::pair<const int, int>>>;
+        static_assert(!std::is_nothrow_move_assignable<PmrMap<utils::hash<int>>>::value, "pmr move may allocate");
+        static_assert(!std::is_nothrow_move_assignable<FlatPmrMap>::value, "pmr move may allocate");
+        static_assert(std::is_nothrow_move_assignable<HashMap<int, int>>::value, "std::allocator move is noexcept");
+        static_assert(std::is_nothrow_move_assignable<FlatHashMap<int, int>>::value, "std::allocator move is noexcept");
+
+        alignas(std::max_align_t) unsigned char buffer[16384];
+        int thrown = 0;
+        {
+            std::pmr::monotonic_buffer_resource bounded(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+            PmrMap<utils::hash<int>> small(0, {}, {}, &bounded);
+            try {
+                small = std::move(target);
+            } catch (const std::bad_alloc&) {
+                thrown++;
+            }
+        }
+        {
+            std::pmr::monotonic_buffer_resource bounded(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+            FlatPmrMap small(0, {}, {}, &bounded);
+            try {
+                small = std::move(flat);
+            } catch (const std::bad_alloc&) {
+                thrown++;
+            }
+        }
+        if (thrown != 2) {
+            std::cout << "Exhausted resource threw " << thrown << " times, expected 2\n";
+            return 1;
+        }
+    }
+
+    std::pmr::set_default_resource(previous);
+    std::cout << "Outstanding bytes after destruction: " << counting.outstanding << "\n";
+    if (counting.outstanding != 0) return 1;
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include "hashmap.hpp"
+#include "test_common.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+// rbtree::assign_sorted: 由有序序列线性构造合法的红黑树；HashMap 拷贝整体复制桶，不比较键
+struct CountingLess {
+    static long calls;
+    bool operator()(int a, int b) const { ++calls; return a < b; }
+};
+long CountingLess::calls = 0;
+
+// 暴露根节点以检查红黑性质
+struct checked_tree : utils::rbtree<int, CountingLess> {
+    using node = utils::rb_node<int>;
+
+    // 返回黑高，不满足性质时返回 -1
+    static int black_height(node* n, node* parent, const int* lo, const int* hi) {
+        if (!n) return 1;
+        if (n->parent() != parent) return -1;
+        if (lo && n->value <= *lo) return -1;
+        if (hi && n->value >= *hi) return -1;
+        if (n->color == node::COLOR_RED && parent && parent->color == node::COLOR_RED) return -1;
+        int left = black_height(n->left(), n, lo, &n->value);
+        int right = black_height(n->right(), n, &n->value, hi);
+        if (left < 0 || left != right) return -1;
+        return left + (n->color == node::COLOR_BLACK ? 1 : 0);
+    }
+
+    bool valid() const {
+        if (this->root && this->root->color != node::COLOR_BLACK) return false;
+        return black_height(this->root, nullptr, nullptr, nullptr) > 0;
+    }
+};
+
+int main() {
+    std::cout << "=== Testing linear-time red-black tree construction ===\n";
+
+    for (int n = 0; n <= 300; ++n) {
+        std::vector<int> sorted;
+        for (int i = 0; i < n; ++i) sorted.push_back(i * 2);
+
+        checked_tree tree;
+        tree.push(-1);
+        CountingLess::calls = 0;
+        tree.assign_sorted(sorted.begin(), sorted.end());
+        if (CountingLess::calls != 0 || tree.size() != static_cast<unsigned long long>(n) || !tree.valid()) {
+            std::cout << "Invalid tree for n = " << n << "\n";
+            return 1;
+        }
+
+        // 中序遍历得到原序列，之后仍可正常插入和删除
+        int expected = 0;
+        for (auto it = tree.begin(); it != tree.end(); ++it, expected += 2) {
+            if (*it != expected) return 1;
+        }
+        if (n && expected != n * 2) return 1;
+        for (int i = 1; i < n; i += 4) tree.push(i);
+        for (int i = 0; i < n; i += 3) tree.remove(i * 2);
+        if (!tree.valid()) return 1;
+    }
+
+    // 所有键落在同一个桶中: 桶转为红黑树，拷贝时整体复制
+    HashMap<int, std::string, SingleBucketHash> map;
+    for (int i = 0; i < 500; ++i) map.insert(i, std::to_string(i));
+    HashMap<int, std::string, SingleBucketHash> copy(map);
+    if (copy.size() != map.size()) return 1;
+    for (int i = 0; i < 500; ++i) {
+        auto it = copy.find(i);
+        if (it == copy.end() || it->second != std::to_string(i)) return 1;
+    }
+    copy.erase(7);
+    copy.insert(1000, "x");
+    if (copy.contains(7) || !map.contains(7) || map.contains(1000) || copy.size() != 500) return 1;
+
+    // 拷贝后的表可以继续扩展
+    HashMap<int, int> spread;
+    for (int i = 0; i < 20000; ++i) spread.insert(i, i);
+    HashMap<int, int> spread_copy = spread;
+    for (int i = 20000; i < 60000; ++i) spread_copy.insert(i, i);
+    for (int i = 0; i < 60000; i += 7) {
+        if (!spread_copy.contains(i) || spread_copy.find(i)->second != i) return 1;
+    }
+    if (spread.size() != 20000 || spread_copy.size() != 60000) return 1;
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include "concurrent_hashmap.hpp"
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ReadMostlyHashMap: 读者不加锁查找的同时写者插入、删除并触发扩容，读者看到的值始终一致，旧桶最终被回收
+int main() {
+    std::cout << "=== Testing ReadMostlyHashMap ===\n";
+
+    const int reader_count = 4;
+    const int writer_count = 2;
+    const int per_writer = 20000;
+    const int stable_keys = 1000;
+
+    ReadMostlyHashMap<int, int> map;
+    // 稳定键在整个过程中一直存在，值等于键的两倍
+    for (int k = 0; k < stable_keys; ++k) map.insert(k, k * 2);
+
+    std::atomic<bool> done{false};
+    std::atomic<bool> bad{false};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < reader_count; ++r) {
+        readers.emplace_back([&, r] {
+            auto reader = map.register_reader();
+            int i = r;
+            while (!done.load(std::memory_order_acquire)) {
+                int key = i++ % stable_keys;
+                int value = -1;
+                if (!map.find(key, value) || value != key * 2) bad = true;
+                // 写者插入的键要么不存在，要么值等于键的相反数
+                int other = stable_keys + i % (writer_count * per_writer);
+                if (map.find(other, value) && value != -other) bad = true;
+                reader.quiescent();
+            }
+        });
+    }
+
+    // 写者插入各自的键，再删除其中一半；期间追加箱子并多次扩容
+    std::vector<std::thread> writers;
+    for (int w = 0; w < writer_count; ++w) {
+        writers.emplace_back([&, w] {
+            int base = stable_keys + w * per_writer;
+            for (int i = 0; i < per_writer; ++i) {
+                if (!map.insert(base + i, -(base + i))) bad = true;
+            }
+            for (int i = 0; i < per_writer; i += 2) {
+                if (!map.erase(base + i)) bad = true;
+            }
+        });
+    }
+    for (auto& writer : writers) writer.join();
+    done.store(true, std::memory_order_release);
+    for (auto& reader : readers) reader.join();
+
+    if (bad) {
+        std::cout << "Inconsistent read or write\n";
+        return 1;
+    }
+    if (map.size() != static_cast<size_t>(stable_keys + writer_count * per_writer / 2)) {
+        std::cout << "Wrong size: " << map.size() << "\n";
+        return 1;
+    }
+
+    // 所有读者都已注销，旧桶和旧表都可以回收
+    map.reclaim();
+    if (map.pending_reclaim() != 0) {
+        std::cout << "Pending reclaim: " << map.pending_reclaim() << "\n";
+        return 1;
+    }
+
+    // 在线但不调用 quiescent() 的读者阻止回收
+    {
+        auto reader = map.register_reader();
+        map.insert_or_assign(0, 7);
+        map.reclaim();
+        if (map.pending_reclaim() == 0) return 1;
+        reader.quiescent();
+        map.reclaim();
+        if (map.pending_reclaim() != 0) return 1;
+
+        // offline 的读者不阻止回收
+        reader.offline();
+        map.insert_or_assign(0, 8);
+        map.reclaim();
+        if (map.pending_reclaim() != 0) return 1;
+        reader.online();
+
+        int value = 0;
+        if (!map.find(0, value) || value != 8) return 1;
+    }
+
+    // insert 不覆盖，insert_or_assign 覆盖，compute 返回 false 删除
+    ReadMostlyHashMap<std::string, long> counters;
+    auto reader = counters.register_reader();
+    if (!counters.insert("a", 1) || counters.insert("a", 2)) return 1;
+    long value = 0;
+    if (!counters.find("a", value) || value != 1) return 1;
+    if (counters.insert_or_assign("a", 3) || !counters.find("a", value) || value != 3) return 1;
+    if (!counters.compute("a", [](long& v) { v += 10; return true; }) || !counters.find("a", value) || value != 13) return 1;
+    if (counters.compute("a", [](long&) { return false; }) || counters.contains("a")) return 1;
+    if (counters.compute("absent", [](long&) { return false; }) || counters.contains("absent")) return 1;
+    if (!counters.try_emplace("fresh", 7) || counters.try_emplace("fresh", 8)) return 1;
+
+    counters.clear();
+    reader.quiescent();
+    if (!counters.empty() || counters.contains("fresh")) return 1;
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
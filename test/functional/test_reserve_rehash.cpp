@@ -0,0 +1,95 @@
+#include "hashmap.hpp"
+#include "test_common.hpp"
+#include <iostream>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+template <typename Map>
+bool check_sizing(Map& map, const char* name) {
+    const int n = 100000;
+
+    // reserve 之后插入 n 个元素，桶数不再变化
+    map.reserve(n);
+    size_t reserved = map.bucket_count();
+    if (reserved < static_cast<size_t>(n)) return false;
+    std::unordered_map<int, int> reference;
+    for (int i = 0; i < n; ++i) {
+        map.insert(i, i);
+        reference[i] = i;
+    }
+    if (map.bucket_count() != reserved) {
+        std::cout << name << ": grew after reserve: " << reserved << " -> " << map.bucket_count() << "\n";
+        return false;
+    }
+    if (!matches(map, reference, name)) return false;
+
+    // 更小的 reserve 不减少桶数
+    map.reserve(10);
+    if (map.bucket_count() != reserved) return false;
+
+    // rehash 可以增加或减少桶数，但至少能容纳现有元素
+    map.rehash(reserved * 4);
+    if (map.bucket_count() < reserved * 4 || !matches(map, reference, name)) return false;
+    map.rehash(0);
+    if (map.bucket_count() > reserved || map.bucket_count() < static_cast<size_t>(n)) return false;
+    if (!matches(map, reference, name)) return false;
+
+    for (int i = 0; i < n; i += 2) {
+        map.erase(i);
+        reference.erase(i);
+    }
+    map.rehash(1000);
+    if (map.bucket_count() >= reserved || !matches(map, reference, name)) return false;
+    for (int i = 0; i < n; i += 2) {
+        map.insert(i, -i);
+        reference[i] = -i;
+    }
+    return matches(map, reference, name);
+}
+
+// reserve / rehash 重建为合适的桶数；范围构造函数和 insert(first, last) 按 std::distance 预先确定桶数
+int main() {
+    std::cout << "=== Testing reserve, rehash and range presizing ===\n";
+
+    HashMap<int, int> box_map;
+    if (!check_sizing(box_map, "box")) return 1;
+
+    FlatHashMap<int, int> flat_map;
+    if (!check_sizing(flat_map, "flat")) return 1;
+
+    // 空表 reserve 之后的 bucket_count 与带预估大小构造的相同
+    HashMap<int, int> presized(5000);
+    HashMap<int, int> reserved;
+    reserved.reserve(5000);
+    if (reserved.bucket_count() != presized.bucket_count()) return 1;
+
+    // 非随机访问的前向迭代器范围
+    std::list<std::pair<int, int>> listed;
+    for (int i = 0; i < 50000; ++i) listed.emplace_back(i * 3, i);
+    HashMap<int, int> from_list(listed.begin(), listed.end());
+    if (from_list.size() != listed.size() || from_list.bucket_count() < listed.size()) return 1;
+    if (from_list.bucket_count() != HashMap<int, int>(listed.size()).bucket_count()) return 1;
+    for (auto& kv : listed) {
+        if (from_list[kv.first] != kv.second) return 1;
+    }
+
+    FlatHashMap<int, int> flat_from_list(listed.begin(), listed.end());
+    if (flat_from_list.bucket_count() != FlatHashMap<int, int>(listed.size()).bucket_count()) return 1;
+
+    // 非空表插入不少于现有元素数量的范围时先预留
+    HashMap<int, int> growing;
+    for (int i = 0; i < 100; ++i) growing.insert(-i - 1, i);
+    growing.insert(listed.begin(), listed.end());
+    if (growing.size() != listed.size() + 100 ||
+        growing.bucket_count() != HashMap<int, int>(listed.size() + 100).bucket_count()) return 1;
+    if (growing[-1] != 0 || growing[3] != 1) return 1;
+
+    // 初始化列表
+    HashMap<std::string, int> words{{"a", 1}, {"b", 2}, {"c", 3}};
+    if (words.size() != 3 || words["b"] != 2) return 1;
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "sharded_hashmap.hpp"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct max_of {
+    int operator()(int a, int b) const { return std::max(a, b); }
+};
+
+// ShardedHashMap: 多个写者各自计数，按需合并、合并视图与 drain 的结果与串行计数一致
+int main() {
+    std::cout << "=== Testing ShardedHashMap ===\n";
+
+    const int thread_count = 8;
+    const int rounds = 20000;
+    const int key_count = 100;
+
+    ShardedHashMap<int, long> counts;
+    {
+        std::vector<std::thread> workers;
+        for (int t = 0; t < thread_count; ++t) {
+            workers.emplace_back([&counts] {
+                auto writer = counts.register_writer();
+                for (int i = 0; i < rounds; ++i) {
+                    if (i & 1) writer.add(i % key_count, 1);
+                    else writer.update(i % key_count, [](long& v) { ++v; });
+                }
+            });
+        }
+        // 写者运行期间按需合并，任何时刻的值都不超过最终值
+        for (int i = 0; i < 100; ++i) {
+            long value = 0;
+            if (counts.get(i % key_count, value) && value > static_cast<long>(thread_count) * rounds / key_count) return 1;
+        }
+        for (auto& worker : workers) worker.join();
+    }
+    if (counts.shard_count() == 0 || counts.shard_count() > static_cast<size_t>(thread_count)) return 1;
+
+    const long expected = static_cast<long>(thread_count) * rounds / key_count;
+    for (int k = 0; k < key_count; ++k) {
+        long value = 0;
+        if (!counts.get(k, value) || value != expected) {
+            std::cout << "get(" << k << ") = " << value << "\n";
+            return 1;
+        }
+    }
+    long value = 0;
+    if (counts.get(key_count, value)) return 1;
+
+    // 合并视图在 refresh() 之前为空，之后与按需合并一致
+    if (counts.find(0, value)) return 1;
+    counts.refresh();
+    if (!counts.find(0, value) || value != expected) return 1;
+
+    auto merged = counts.snapshot();
+    if (merged.size() != static_cast<size_t>(key_count) || merged[key_count - 1] != expected) return 1;
+
+    // drain_into 移出所有分片并清空
+    ShardedHashMap<int, long>::map_type total;
+    total[0] = 5;
+    counts.drain_into(total);
+    if (total.size() != static_cast<size_t>(key_count) || total[0] != expected + 5) return 1;
+    if (counts.get(0, value) || counts.snapshot().size() != 0) return 1;
+
+    // 注销的写者归还分片，新写者复用
+    size_t shards = counts.shard_count();
+    {
+        auto writer = counts.register_writer();
+        writer.add(1, 2);
+    }
+    if (counts.shard_count() != shards || !counts.get(1, value) || value != 2) return 1;
+
+    // 自定义归约器: 取最大值
+    ShardedHashMap<std::string, int, max_of> peaks;
+    {
+        auto a = peaks.register_writer();
+        auto b = peaks.register_writer();
+        a.add("x", 3);
+        a.add("x", 1);
+        b.add("x", 7);
+        b.add("y", 4);
+        int peak = 0;
+        if (!peaks.get("x", peak) || peak != 7) return 1;
+        if (!peaks.get("y", peak) || peak != 4) return 1;
+    }
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
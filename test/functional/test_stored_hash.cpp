@@ -0,0 +1,74 @@
+#include "hashmap.hpp"
+#include <iostream>
+#include <string>
+
+// 每个元素保存完整的32位哈希值: 拷贝和合并迁移不再调用哈希器，哈希值不同时不比较键
+static int hash_calls = 0;
+static int key_compares = 0;
+
+struct CountingHash {
+    uint32_t operator()(const std::string& key) const {
+        ++hash_calls;
+        return utils::hash<std::string>{}(key);
+    }
+};
+
+struct CountingEqual {
+    bool operator()(const std::string& a, const std::string& b) const {
+        ++key_compares;
+        return a == b;
+    }
+};
+
+// 哈希值只有低位不同，线性映射后所有键落在同一个桶
+struct SameBucketHash {
+    using is_avalanching = void;
+    uint32_t operator()(int key) const { return static_cast<uint32_t>(key) & 0xFFFF; }
+};
+
+int main() {
+    std::cout << "=== Testing stored hash values ===\n";
+
+    using Map = HashMap<std::string, int, CountingHash, CountingEqual>;
+    Map map;
+    const int count = 20000;
+    for (int i = 0; i < count; ++i) map.insert("key-" + std::to_string(i), i);
+    if (map.size() != static_cast<size_t>(count)) return 1;
+
+    // 拷贝时复用存储的哈希值
+    hash_calls = 0;
+    Map copy(map);
+    std::cout << "Hash calls during copy: " << hash_calls << "\n";
+    if (hash_calls != 0 || copy.size() != map.size()) return 1;
+
+    // 查找: 每次一次哈希，命中时只比较一次键
+    hash_calls = 0;
+    key_compares = 0;
+    for (int i = 0; i < count; ++i) {
+        auto it = copy.find("key-" + std::to_string(i));
+        if (it == copy.end() || it->second != i) return 1;
+    }
+    std::cout << "Hash calls: " << hash_calls << ", key compares: " << key_compares << " for " << count << " hits\n";
+    if (hash_calls != count || key_compares != count) return 1;
+
+    // 未命中: 除非哈希值完全相同，否则不比较键
+    key_compares = 0;
+    for (int i = count; i < 2 * count; ++i) {
+        if (copy.find("key-" + std::to_string(i)) != copy.end()) return 1;
+    }
+    std::cout << "Key compares for " << count << " misses: " << key_compares << "\n";
+    if (key_compares > 2) return 1;
+
+    // 同一桶内按哈希值排序，所有桶形式下仍能正确查找和删除
+    HashMap<int, int, SameBucketHash> same;
+    for (int i = 0; i < 50; ++i) same.insert(i * 7, i);
+    for (int i = 0; i < 50; i += 2) {
+        if (!same.erase(i * 7)) return 1;
+    }
+    for (int i = 0; i < 50; ++i) {
+        if ((same.find(i * 7) != same.end()) != (i % 2 == 1)) return 1;
+    }
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
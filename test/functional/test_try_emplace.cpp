@@ -0,0 +1,96 @@
+#include "hashmap.hpp"
+#include <iostream>
+#include <memory>
+#include <string>
+
+// try_emplace / insert_or_assign / operator[]: 键已存在时不构造、不移动；支持只能移动的值
+struct Counted {
+    static int constructions;
+    int value;
+    explicit Counted(int v) : value(v) { ++constructions; }
+    Counted(Counted&& other) noexcept : value(other.value) {}
+    Counted& operator=(Counted&& other) noexcept { value = other.value; return *this; }
+    Counted(const Counted&) = delete;
+    Counted& operator=(const Counted&) = delete;
+};
+int Counted::constructions = 0;
+
+// 所有键落在同一个桶中，覆盖内联、有序数组和红黑树形式的就地构造
+struct CollidingHash {
+    uint32_t operator()(const std::string&) const { return 11; }
+};
+
+template <typename Map>
+static bool check(Map& map, int count) {
+    Counted::constructions = 0;
+    for (int i = 0; i < count; ++i) {
+        auto result = map.try_emplace(std::to_string(i), i);
+        if (!result.second || result.first->second.value != i) return false;
+    }
+    if (Counted::constructions != count || map.size() != static_cast<size_t>(count)) return false;
+
+    // 键已存在: 不构造值，也不移动实参
+    std::string key = "0";
+    auto again = map.try_emplace(std::move(key), 100);
+    if (again.second || again.first->second.value != 0 || key != "0") return false;
+    if (Counted::constructions != count) return false;
+
+    // insert_or_assign 覆盖已有值，插入新值
+    auto assigned = map.insert_or_assign("0", Counted(30));
+    if (assigned.second || assigned.first->second.value != 30) return false;
+    auto inserted = map.insert_or_assign(std::string("new"), Counted(7));
+    if (!inserted.second || map.at("new").value != 7) return false;
+
+    for (int i = 0; i < count; ++i) {
+        auto it = map.find(std::to_string(i));
+        if (it == map.end() || it->second.value != (i == 0 ? 30 : i)) return false;
+    }
+    return map.size() == static_cast<size_t>(count + 1);
+}
+
+template <typename Map>
+static bool check_counters(Map& counters) {
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 500; ++i) counters[i % 50]++;
+    }
+    if (counters.size() != 50) return false;
+    for (int i = 0; i < 50; ++i) {
+        if (counters.at(i) != 30) return false;
+    }
+
+    Map owners;
+    owners.try_emplace(1, 5);
+    owners.insert(2, 6);
+    int key = 3, value = 7;
+    owners.insert(key, value);
+    return owners.size() == 3 && owners[3] == 7 && owners[4] == 0 && owners.size() == 4;
+}
+
+int main() {
+    std::cout << "=== Testing try_emplace and insert_or_assign ===\n";
+
+    HashMap<std::string, Counted> box_map;
+    if (!check(box_map, 1000)) return 1;
+
+    for (int count : {1, 2, 5, 8, 9, 40}) {
+        HashMap<std::string, Counted, CollidingHash> colliding;
+        if (!check(colliding, count)) return 1;
+    }
+
+    FlatHashMap<std::string, Counted> flat_map;
+    if (!check(flat_map, 1000)) return 1;
+
+    HashMap<int, int> box_counters;
+    FlatHashMap<int, int> flat_counters;
+    if (!check_counters(box_counters) || !check_counters(flat_counters)) return 1;
+
+    // 只能移动的值
+    HashMap<int, std::unique_ptr<std::string>> owned;
+    owned.try_emplace(1, new std::string("one"));
+    owned.insert_or_assign(2, std::make_unique<std::string>("two"));
+    owned[3] = std::make_unique<std::string>("three");
+    if (*owned.at(1) != "one" || *owned.at(2) != "two" || *owned[3] != "three") return 1;
+
+    std::cout << "Test completed successfully\n";
+    return 0;
+}
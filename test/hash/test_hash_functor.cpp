@@ -0,0 +1,115 @@
+#include "hashmap.hpp"
+#include <cctype>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+// 不区分大小写的哈希器和相等比较器，与 std::string::operator< 的顺序不一致
+struct CaseInsensitiveHash {
+    size_t operator()(const std::string& s) const {
+        std::string folded(s);
+        for (char& c : folded) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return utils::hash<std::string>{}(folded);
+    }
+};
+
+struct CaseInsensitiveEqual {
+    bool operator()(const std::string& a, const std::string& b) const {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) return false;
+        }
+        return true;
+    }
+};
+
+// 只有4个不同哈希值，迫使不同的键在桶内排成哈希值相同的一段(有序数组和红黑树)
+struct FoldedCollidingHash {
+    size_t operator()(const std::string& s) const { return CaseInsensitiveHash{}(s) % 4; }
+};
+
+// 桶内只按哈希值排序，由 KeyEqual 判断相等，不依赖 Key::operator<
+template <typename Map>
+static bool check_case_insensitive(Map& map, int n) {
+    for (int i = 0; i < n; ++i) map.insert("KEY" + std::to_string(i), i);
+    for (int i = 0; i < n; ++i) {
+        auto it = map.find("key" + std::to_string(i));
+        if (it == map.end() || it->second != i) {
+            std::cout << "Case-insensitive key " << i << " not found\n";
+            return false;
+        }
+    }
+    for (int i = 0; i < n; ++i) map.insert("key" + std::to_string(i), -i);
+    if (map.size() != static_cast<size_t>(n)) {
+        std::cout << "Case-insensitive size " << map.size() << ", expected " << n << "\n";
+        return false;
+    }
+    for (int i = 0; i < n; ++i) {
+        if (map.at("Key" + std::to_string(i)) != -i) return false;
+    }
+    for (int i = 0; i < n; i += 2) {
+        if (!map.erase("kEY" + std::to_string(i))) return false;
+    }
+    for (int i = 0; i < n; ++i) {
+        if (map.contains("KEY" + std::to_string(i)) != (i % 2 == 1)) return false;
+    }
+    return map.size() == static_cast<size_t>(n / 2);
+}
+
+// 按内容哈希: 同内容、不同缓冲区的字符串哈希值必须相同
+int main() {
+    std::cout << "Testing content-aware hash functors...\n";
+
+    utils::hash<std::string> string_hash;
+    std::string a = "a string that is longer than the small string buffer";
+    std::string b(a.begin(), a.end());
+    if (string_hash(a) != string_hash(b)) return 1;
+    if (string_hash(a) != utils::hash<std::string_view>{}(std::string_view(a))) return 1;
+
+    using pair_key = std::pair<std::string, int>;
+    if (utils::hash<pair_key>{}(pair_key(a, 1)) != utils::hash<pair_key>{}(pair_key(b, 1))) return 1;
+    if (utils::hash<pair_key>{}(pair_key(a, 1)) == utils::hash<pair_key>{}(pair_key(a, 2))) return 1;
+
+    using tuple_key = std::tuple<int, std::string, double>;
+    if (utils::hash<tuple_key>{}(tuple_key(1, a, 0.0)) != utils::hash<tuple_key>{}(tuple_key(1, b, -0.0))) return 1;
+
+    // 字符串键的 HashMap: 用独立构造的键查找
+    HashMap<std::string, int> words;
+    for (int i = 0; i < 2000; ++i) {
+        words.insert("word_" + std::to_string(i), i);
+    }
+    for (int i = 0; i < 2000; ++i) {
+        auto it = words.find(std::string("word_") + std::to_string(i));
+        if (it == words.end() || it->second != i) {
+            std::cout << "String key " << i << " not found\n";
+            return 1;
+        }
+    }
+    std::cout << "String keys found, bucket count: " << words.bucket_count() << "\n";
+
+    // pair 键
+    HashMap<pair_key, int> pairs;
+    pairs.insert(pair_key("x", 1), 10);
+    pairs.insert(pair_key("x", 2), 20);
+    if (pairs.size() != 2 || pairs.at(pair_key("x", 2)) != 20) return 1;
+
+    // 自定义哈希器和相等比较器: std::hash 的结果会被再次混合
+    HashMap<int, int, std::hash<int>, std::equal_to<int>> custom;
+    for (int i = 0; i < 1000; ++i) custom.insert(i, -i);
+    for (int i = 0; i < 1000; ++i) {
+        if (custom.at(i) != -i) return 1;
+    }
+    std::hash<int> h = custom.hash_function();
+    (void)h;
+
+    HashMap<std::string, int, CaseInsensitiveHash, CaseInsensitiveEqual> folded;
+    if (!check_case_insensitive(folded, 20000)) return 1;
+    HashMap<std::string, int, FoldedCollidingHash, CaseInsensitiveEqual> colliding;
+    if (!check_case_insensitive(colliding, 400)) return 1;
+    std::cout << "Case-insensitive Hash/KeyEqual keys found\n";
+
+    std::cout << "Hash functor test completed successfully!\n";
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include "hashmap.hpp"
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+// 过期清理: 用迭代器串行扫描、按键删除，与按箱×桶下标区间并行删除的 parallel_erase_if
+// 工作负载: ENTRY_COUNT 个元素，值为过期时间，删除其中约四分之一已过期的元素
+
+const int ENTRY_COUNT = 4000000;
+const int EXPIRY_CUTOFF = ENTRY_COUNT / 4;
+
+template <typename F>
+double time_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void fill(HashMap<int, int>& map) {
+    // 值为伪随机的过期时间
+    for (int i = 0; i < ENTRY_COUNT; ++i) map[i] = static_cast<int>((i * 2654435761u) % ENTRY_COUNT);
+}
+
+int main() {
+    std::cout << "=== 并行过期清理基准测试 ===\n";
+    std::cout << "元素数 " << ENTRY_COUNT << "，删除过期时间小于 " << EXPIRY_CUTOFF << " 的元素\n\n";
+
+    utils::work_stealing_pool& pool = utils::work_stealing_pool::shared();
+
+    HashMap<int, int> sequential;
+    fill(sequential);
+    size_t sequential_erased = 0;
+    double sequential_ms = time_ms([&] {
+        // erase(iterator) 返回 end()，只能先收集过期的键再逐个删除
+        std::vector<int> expired;
+        for (auto& kv : sequential) {
+            if (kv.second < EXPIRY_CUTOFF) expired.push_back(kv.first);
+        }
+        for (int key : expired) sequential_erased += sequential.erase(key);
+    });
+
+    HashMap<int, int> parallel;
+    fill(parallel);
+    size_t parallel_erased = 0;
+    double parallel_ms = time_ms([&] {
+        parallel_erased = parallel.parallel_erase_if([](const auto& kv) { return kv.second < EXPIRY_CUTOFF; }, pool);
+    });
+
+    size_t counted = 0;
+    double count_ms = time_ms([&] {
+        counted = parallel.parallel_count_if([](const auto& kv) { return kv.second >= EXPIRY_CUTOFF; }, pool);
+    });
+
+    std::cout << "参与线程数: " << pool.concurrency() << "\n";
+    std::cout << "迭代器串行删除: " << sequential_ms << " ms，删除 " << sequential_erased << " 个\n";
+    std::cout << "parallel_erase_if: " << parallel_ms << " ms，删除 " << parallel_erased << " 个\n";
+    std::cout << "parallel_count_if: " << count_ms << " ms，剩余 " << counted << " 个\n";
+    std::cout << "加速比: " << sequential_ms / parallel_ms << "\n";
+    return sequential_erased == parallel_erased ? 0 : 1;
+}
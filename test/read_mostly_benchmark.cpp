@@ -0,0 +1,95 @@
+#include "concurrent_hashmap.hpp"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+// 读者扩展性: 条带锁的 ConcurrentHashMap 与读者不加锁的 ReadMostlyHashMap
+// 工作负载: 若干读者线程只做查找，同时一个写者线程持续插入、删除，键均匀分布在 [0, KEY_RANGE)
+
+const int KEY_RANGE = 1 << 20;
+const int LOOKUPS_PER_READER = 2000000;
+const int QUIESCENT_INTERVAL = 64;  // 读者每做多少次查找声明一次静止状态
+
+std::atomic<long> hit_sink{0};   // 防止查找被优化掉
+
+struct StripedReader {
+    explicit StripedReader(ConcurrentHashMap<int, int>&) {}
+    void quiescent() {}
+};
+
+struct ReadMostlyReader {
+    utils::qsbr_domain::reader reader;
+    explicit ReadMostlyReader(ReadMostlyHashMap<int, int>& map) : reader(map.register_reader()) {}
+    void quiescent() { reader.quiescent(); }
+};
+
+// 返回读者的总查找速度(百万次每秒)
+template <typename Map, typename Reader>
+double run(Map& map, int readers) {
+    std::atomic<bool> done{false};
+    std::thread writer([&map, &done] {
+        std::mt19937 rng(777u);
+        std::uniform_int_distribution<int> key_dist(0, KEY_RANGE - 1);
+        while (!done.load(std::memory_order_relaxed)) {
+            int key = key_dist(rng);
+            if (key & 1) map.insert(key, key);
+            else map.erase(key);
+        }
+    });
+
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < readers; ++t) {
+        workers.emplace_back([&map, t] {
+            Reader reader(map);
+            std::mt19937 rng(12345u + t);
+            std::uniform_int_distribution<int> key_dist(0, KEY_RANGE - 1);
+            int value = 0;
+            long hits = 0;
+            for (int i = 0; i < LOOKUPS_PER_READER; ++i) {
+                hits += map.find(key_dist(rng), value);
+                if (i % QUIESCENT_INTERVAL == 0) reader.quiescent();
+            }
+            hit_sink += hits;
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    done.store(true, std::memory_order_relaxed);
+    writer.join();
+    return readers * static_cast<double>(LOOKUPS_PER_READER) / elapsed / 1e6;
+}
+
+template <typename Map>
+void prefill(Map& map) {
+    for (int i = 0; i < KEY_RANGE; i += 2) map.insert(i, i);
+}
+
+int main() {
+    std::cout << "=== 读者扩展性基准测试 ===\n";
+    std::cout << "读者只查找，另有一个写者持续插入/删除，键空间 " << KEY_RANGE << "，每个读者 " << LOOKUPS_PER_READER << " 次查找\n\n";
+
+    unsigned max_threads = std::thread::hardware_concurrency();
+    if (max_threads == 0) max_threads = 4;
+
+    std::cout << "读者数\t条带锁 (Mops/s)\tReadMostly (Mops/s)\t加速比\n";
+    std::vector<unsigned> thread_counts;
+    for (unsigned threads = 1; threads < max_threads; threads *= 2) thread_counts.push_back(threads);
+    thread_counts.push_back(max_threads);
+
+    for (unsigned threads : thread_counts) {
+        ConcurrentHashMap<int, int> striped;
+        prefill(striped);
+        ReadMostlyHashMap<int, int> read_mostly;
+        prefill(read_mostly);
+
+        double striped_mops = run<ConcurrentHashMap<int, int>, StripedReader>(striped, static_cast<int>(threads));
+        double read_mostly_mops = run<ReadMostlyHashMap<int, int>, ReadMostlyReader>(read_mostly, static_cast<int>(threads));
+        std::cout << threads << "\t" << striped_mops << "\t\t" << read_mostly_mops << "\t\t\t"
+                  << read_mostly_mops / striped_mops << "\n";
+    }
+    return 0;
+}
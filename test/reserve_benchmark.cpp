@@ -0,0 +1,52 @@
+#include "hashmap.hpp"
+#include <chrono>
+#include <iostream>
+#include <list>
+#include <utility>
+
+// 已知规模的装载: 从空表逐个插入增长，与先 reserve、从前向迭代器范围构造的对比
+// 工作负载: ENTRY_COUNT 个互不相同的随机键
+
+const int ENTRY_COUNT = 2000000;
+
+template <typename F>
+double time_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    std::cout << "=== 预留容量基准测试 ===\n";
+    std::cout << "元素数 " << ENTRY_COUNT << "\n\n";
+
+    std::list<std::pair<int, int>> load;
+    for (int i = 0; i < ENTRY_COUNT; ++i) load.emplace_back(static_cast<int>(i * 2654435761u), i);
+
+    size_t grown_size = 0;
+    double grown_ms = time_ms([&] {
+        HashMap<int, int> map;
+        for (auto& kv : load) map.insert(kv.first, kv.second);
+        grown_size = map.size();
+    });
+
+    size_t reserved_size = 0;
+    double reserved_ms = time_ms([&] {
+        HashMap<int, int> map;
+        map.reserve(ENTRY_COUNT);
+        for (auto& kv : load) map.insert(kv.first, kv.second);
+        reserved_size = map.size();
+    });
+
+    size_t ranged_size = 0;
+    double ranged_ms = time_ms([&] {
+        HashMap<int, int> map(load.begin(), load.end());
+        ranged_size = map.size();
+    });
+
+    std::cout << "逐个插入增长: " << grown_ms << " ms\n";
+    std::cout << "reserve 后插入: " << reserved_ms << " ms\n";
+    std::cout << "前向迭代器范围构造: " << ranged_ms << " ms\n";
+    std::cout << "加速比: " << grown_ms / reserved_ms << "\n";
+    return grown_size == reserved_size && reserved_size == ranged_size ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+#include "concurrent_hashmap.hpp"
+#include "sharded_hashmap.hpp"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+// 高频计数: 共享的 ConcurrentHashMap 上 compute 累加，与每个线程写自己分片的 ShardedHashMap
+// 工作负载: 每个线程对 [0, KEY_RANGE) 中的随机键加一，结束后合并出总数
+
+const int KEY_RANGE = 1 << 12;
+const int OPS_PER_THREAD = 2000000;
+
+// 返回每秒操作数(百万)，含最后的合并
+template <typename Count, typename Total>
+double run(int threads, Count count, Total total) {
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&count, t] {
+            count(12345u + t);
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    long sum = total();
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (sum != static_cast<long>(threads) * OPS_PER_THREAD) std::cout << "计数错误: " << sum << "\n";
+    return threads * static_cast<double>(OPS_PER_THREAD) / elapsed / 1e6;
+}
+
+int main() {
+    std::cout << "=== 高频计数基准测试 ===\n";
+    std::cout << "键空间 " << KEY_RANGE << "，每线程 " << OPS_PER_THREAD << " 次加一\n\n";
+
+    unsigned max_threads = std::thread::hardware_concurrency();
+    if (max_threads == 0) max_threads = 4;
+
+    std::cout << "线程数\tConcurrentHashMap (Mops/s)\tShardedHashMap (Mops/s)\t加速比\n";
+    std::vector<unsigned> thread_counts;
+    for (unsigned threads = 1; threads < max_threads; threads *= 2) thread_counts.push_back(threads);
+    thread_counts.push_back(max_threads);
+
+    for (unsigned threads : thread_counts) {
+        ConcurrentHashMap<int, long> shared;
+        double shared_mops = run(static_cast<int>(threads),
+            [&shared](unsigned seed) {
+                std::mt19937 rng(seed);
+                std::uniform_int_distribution<int> key_dist(0, KEY_RANGE - 1);
+                for (int i = 0; i < OPS_PER_THREAD; ++i) shared.compute(key_dist(rng), [](long& v) { ++v; return true; });
+            },
+            [&shared] {
+                long sum = 0;
+                for (int k = 0; k < KEY_RANGE; ++k) {
+                    long v = 0;
+                    if (shared.find(k, v)) sum += v;
+                }
+                return sum;
+            });
+
+        ShardedHashMap<int, long> sharded;
+        double sharded_mops = run(static_cast<int>(threads),
+            [&sharded](unsigned seed) {
+                auto writer = sharded.register_writer();
+                std::mt19937 rng(seed);
+                std::uniform_int_distribution<int> key_dist(0, KEY_RANGE - 1);
+                for (int i = 0; i < OPS_PER_THREAD; ++i) writer.add(key_dist(rng), 1);
+            },
+            [&sharded] {
+                long sum = 0;
+                for (auto& kv : sharded.snapshot()) sum += kv.second;
+                return sum;
+            });
+
+        std::cout << threads << "\t" << shared_mops << "\t\t\t\t" << sharded_mops << "\t\t\t"
+                  << sharded_mops / shared_mops << "\n";
+    }
+    return 0;
+}
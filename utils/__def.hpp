@@ -2,11 +2,99 @@
 #define HASHMAP_UTILS___DEF_HPP
 
 #include <stdint.h>
+#include <type_traits>
+#include <utility>
+
+#if defined(_MSC_VER) && !defined(__clang__) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
 
 namespace utils {
   using ulint = uint64_t;
   using lint  = int64_t;
 
+  /**
+   * @brief 64位字中最低置位的位置(末尾0的个数), x 不得为 0.
+   */
+  inline unsigned ctz64(ulint x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctzll(x));
+#else
+    unsigned n = 0;
+    while (!(x & 1)) { x >>= 1; n++; }
+    return n;
+#endif
+  }
+
+  /**
+   * @brief 64位字中最高置位之前0的个数, x 不得为 0.
+   */
+  inline unsigned clz64(ulint x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_clzll(x));
+#else
+    unsigned n = 0;
+    while (!(x & (ulint(1) << 63))) { x <<= 1; n++; }
+    return n;
+#endif
+  }
+
+  /**
+   * @brief 64位字中置位的个数.
+   */
+  inline unsigned popcount64(ulint x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_popcountll(x));
+#else
+    unsigned n = 0;
+    for (; x; x &= x - 1) n++;
+    return n;
+#endif
+  }
+
+  /**
+   * @brief 提示 CPU 把 p 所在的缓存行预取到缓存中，不会产生访存错误. 不支持的编译器上什么也不做.
+   */
+  inline void prefetch(const void *p) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(p, 0, 3);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(static_cast<const char *>(p), _MM_HINT_T0);
+#else
+    (void)p;
+#endif
+  }
+
+  /**
+   * @brief 空基类优化(EBO)的存储. T 是空类时作为基类继承，不占空间；否则作为成员.
+   * @tparam T 存储的类型，通常是比较器、哈希器或分配器
+   * @tparam Tag 同一个类中继承多个 ebo_storage 时用于区分
+   */
+  template <typename T, int Tag, bool = std::is_empty<T>::value && !std::is_final<T>::value>
+  class ebo_storage : private T {
+    public:
+      ebo_storage() = default;
+      explicit ebo_storage(const T &value) : T(value) {}
+      explicit ebo_storage(T &&value) : T(std::move(value)) {}
+
+      T &get() noexcept { return *this; }
+      const T &get() const noexcept { return *this; }
+  };
+
+  template <typename T, int Tag>
+  class ebo_storage<T, Tag, false> {
+    protected:
+      T value;
+
+    public:
+      ebo_storage() = default;
+      explicit ebo_storage(const T &value) : value(value) {}
+      explicit ebo_storage(T &&value) : value(std::move(value)) {}
+
+      T &get() noexcept { return this->value; }
+      const T &get() const noexcept { return this->value; }
+  };
+
 } // namespace utils
 
 #endif  // HASHMAP_UTILS___DEF_HPP
@@ -2,6 +2,9 @@
 #define HASHMAP_UTILS___ITERATOR_HPP
 
 
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
 
 
 namespace utils {
@@ -10,11 +13,29 @@ namespace utils {
 template <typename T, typename PT>
 class _iterator { ~_iterator() = delete; };
 
+/**
+ * @brief 迭代器基类 (CRTP).
+ * @details 派生类 PT 需要提供 goback()、goback(size_t)、gofront()、gofront(size_t)，
+ *          自增、自减等运算符通过 static_cast 静态分派到派生类，没有虚函数表和 RTTI.
+ *          派生类可以定义自己的 operator==/operator!=，会隐藏这里按指针比较的版本.
+ * @tparam T 元素类型
+ * @tparam PT 派生的迭代器类型
+ */
 template <typename T, typename PT>
 class _iterator<T*, PT> {
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type        = typename std::remove_cv<T>::type;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = T*;
+    using reference         = T&;
+
   protected:
     T* ptr = nullptr;
 
+    PT &self() noexcept { return static_cast<PT&>(*this); }
+    const PT &self() const noexcept { return static_cast<const PT&>(*this); }
+
   public:
     _iterator() = default;
     _iterator(const _iterator &iter) {
@@ -29,7 +50,7 @@ class _iterator<T*, PT> {
       return reinterpret_cast<size_t>(this->ptr);
     }
 
-    virtual void point_to(T* nptr) {
+    void point_to(T* nptr) {
       this->ptr = nptr;
     }
 
@@ -40,80 +61,74 @@ class _iterator<T*, PT> {
 
     PT& operator=(const _iterator &iter) {
       this->ptr = iter.ptr;
-      return static_cast<PT&>(*this);
+      return this->self();
     }
     PT& operator=(_iterator &&iter) {
       this->ptr = iter.ptr;
       iter.ptr = nullptr;
-      return static_cast<PT&>(*this);
+      return this->self();
     }
 
     // before
-    PT operator++() {
-      this->goback();
-      return *dynamic_cast<PT*>(this);
+    PT& operator++() {
+      this->self().goback();
+      return this->self();
     }
 
     // after
-    PT& operator++(int) {
-      PT tmp(static_cast<const PT &>(*this));
-      this->goback();
+    PT operator++(int) {
+      PT tmp(this->self());
+      this->self().goback();
       return tmp;
     }
 
     // before
-    PT operator--() {
-      this->gofront();
-      return *dynamic_cast<PT*>(this);
+    PT& operator--() {
+      this->self().gofront();
+      return this->self();
     }
 
     // after
-    PT& operator--(int) {
-      PT tmp(static_cast<const PT&>(*this));
-      this->gofront();
+    PT operator--(int) {
+      PT tmp(this->self());
+      this->self().gofront();
       return tmp;
     }
 
     PT& operator+=(size_t n) {
-      this->goback(n);
-      return static_cast<PT&>(*this);
+      this->self().goback(n);
+      return this->self();
     }
 
     PT& operator-=(size_t n) {
-      this->gofront(n);
-      return static_cast<PT&>(*this);
+      this->self().gofront(n);
+      return this->self();
     }
 
-    PT operator+(size_t n) {
-      PT tmp(static_cast<const PT&>(*this));
+    PT operator+(size_t n) const {
+      PT tmp(this->self());
       tmp.goback(n);
       return tmp;
     }
 
-    PT operator-(size_t n) {
-      PT tmp(static_cast<const PT&>(*this));
+    PT operator-(size_t n) const {
+      PT tmp(this->self());
       tmp.gofront(n);
       return tmp;
     }
 
-    virtual bool operator<(const _iterator &iter) {
+    bool operator<(const _iterator &iter) const {
       return (this->ptr < iter.ptr);
     }
-    virtual bool operator==(const _iterator &iter) {
+    bool operator==(const _iterator &iter) const {
       return (this->ptr == iter.ptr);
     }
-    virtual bool operator!=(const _iterator &iter) {
+    bool operator!=(const _iterator &iter) const {
       return (this->ptr != iter.ptr);
     }
-    virtual bool operator>(const _iterator &iter) {
-      return (this->ptr == iter.ptr);
+    bool operator>(const _iterator &iter) const {
+      return (this->ptr > iter.ptr);
     }
-
-
-    virtual void goback() = 0;
-    virtual void goback(size_t n) = 0;
-    virtual void gofront() = 0;
-    virtual void gofront(size_t n) = 0;
 };
 
 
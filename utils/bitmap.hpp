@@ -5,61 +5,106 @@
 #include "__errs.hpp"
 
 #include <cstring>
+#include <memory>
 
 namespace utils {
 
 /**
  * @brief 位图类.
- * @details 逻辑上，它是一个固定长度的数组，其中数组的元素取值只能为 true 或 false. 实际上，它是一块固定长度的内存，内存中每个字节的每一位都是数组的一个元素.
+ * @details 逻辑上，它是一个固定长度的数组，其中数组的元素取值只能为 true 或 false. 实际上，它是一块固定长度的内存，
+ *          按64位字存放，每个字的每一位都是数组的一个元素. 最后一个字中超出 bit_count 的位始终为 0，
+ *          因此 count 和 find_next_set/find_prev_set 可以整字地用 popcount/ctz/clz 处理.
+ * @tparam Allocator 分配器类型，会被重绑定到 word_type
  */
-template <typename Allocator = std::allocator<unsigned char> >
+template <typename Allocator = std::allocator<uint64_t> >
 class bitmap {
+  public:
+    using word_type = uint64_t;
+    static constexpr ulint WORD_BITS = 64;
+    static constexpr ulint npos = ~static_cast<ulint>(0);   // find_next_set/find_prev_set 没有找到时的返回值
+
   protected:
-    Allocator allocator;
+    using word_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<word_type>;
+    using word_traits    = std::allocator_traits<word_allocator>;
+
+    word_allocator allocator;
 
   public:
-    unsigned char *bits = nullptr;
+    word_type *words = nullptr;
     unsigned char init_pad = 0b00000000;
     ulint bit_count = 0;
-    ulint bit_byte = 0;
+    ulint word_count = 0;
+
+  protected:
+    static ulint words_for(ulint bit_count) noexcept { return (bit_count + WORD_BITS - 1) / WORD_BITS; }
+
+    /**
+     * @brief 最后一个字中有效位的掩码.
+     */
+    word_type tail_mask() const noexcept {
+      ulint rem = this->bit_count % WORD_BITS;
+      return rem ? (static_cast<word_type>(1) << rem) - 1 : ~static_cast<word_type>(0);
+    }
+
+    void release() {
+      if (this->words) {
+        word_traits::deallocate(this->allocator, this->words, this->word_count);
+        this->words = nullptr;
+      }
+    }
+
+    /**
+     * @brief 把 [first, last) 范围内的位设置为 value.
+     */
+    void fill_range(ulint first, ulint last, bool value) {
+      while (first < last) {
+        ulint w = first / WORD_BITS;
+        ulint lo = first % WORD_BITS;
+        ulint hi = (last - w * WORD_BITS) < WORD_BITS ? last - w * WORD_BITS : WORD_BITS;
+        word_type mask = (hi - lo == WORD_BITS) ? ~static_cast<word_type>(0)
+                       : ((static_cast<word_type>(1) << (hi - lo)) - 1) << lo;
+        if (value) this->words[w] |= mask;
+        else this->words[w] &= ~mask;
+        first = w * WORD_BITS + hi;
+      }
+    }
 
   public:
     bitmap() = default;
     bitmap(unsigned char init_pad) : init_pad(init_pad) {}
+    explicit bitmap(const Allocator& alloc) : allocator(alloc) {}
 
     // Copy constructor
-    bitmap(const bitmap& other) : init_pad(other.init_pad), bit_count(other.bit_count), bit_byte(other.bit_byte) {
-      if (other.bits && other.bit_byte > 0) {
-        this->bits = this->allocator.allocate(this->bit_byte);
-        std::memcpy(this->bits, other.bits, this->bit_byte);
+    bitmap(const bitmap& other)
+      : allocator(word_traits::select_on_container_copy_construction(other.allocator)),
+        init_pad(other.init_pad), bit_count(other.bit_count), word_count(other.word_count) {
+      if (other.words && other.word_count > 0) {
+        this->words = word_traits::allocate(this->allocator, this->word_count);
+        std::memcpy(this->words, other.words, this->word_count * sizeof(word_type));
       }
     }
 
     // Move constructor
-    bitmap(bitmap&& other) noexcept 
-      : bits(other.bits), init_pad(other.init_pad), bit_count(other.bit_count), bit_byte(other.bit_byte) {
-      other.bits = nullptr;
+    bitmap(bitmap&& other) noexcept
+      : allocator(std::move(other.allocator)), words(other.words), init_pad(other.init_pad),
+        bit_count(other.bit_count), word_count(other.word_count) {
+      other.words = nullptr;
       other.bit_count = 0;
-      other.bit_byte = 0;
+      other.word_count = 0;
     }
 
     // Copy assignment operator
     bitmap& operator=(const bitmap& other) {
       if (this != &other) {
-        // Deallocate current memory
-        if (this->bits) {
-          this->allocator.deallocate(this->bits, this->bit_byte);
-          this->bits = nullptr;
-        }
-        
-        // Copy from other
+        this->release();
+
         this->init_pad = other.init_pad;
         this->bit_count = other.bit_count;
-        this->bit_byte = other.bit_byte;
-        
-        if (other.bits && other.bit_byte > 0) {
-          this->bits = this->allocator.allocate(this->bit_byte);
-          std::memcpy(this->bits, other.bits, this->bit_byte);
+        this->word_count = other.word_count;
+
+        if (other.words && other.word_count > 0) {
+          this->words = word_traits::allocate(this->allocator, this->word_count);
+          std::memcpy(this->words, other.words, this->word_count * sizeof(word_type));
         }
       }
       return *this;
@@ -67,59 +112,189 @@ class bitmap {
 
     // Move assignment operator
     bitmap& operator=(bitmap&& other) noexcept {
+      if constexpr (!word_traits::propagate_on_container_move_assignment::value) {
+        // 分配器不随移动传播且不相等时，只能复制内容
+        if (this->allocator != other.allocator) return *this = static_cast<const bitmap&>(other);
+      }
       if (this != &other) {
-        // Deallocate current memory
-        if (this->bits) {
-          this->allocator.deallocate(this->bits, this->bit_byte);
-        }
-        
-        // Move from other
-        this->bits = other.bits;
+        this->release();
+
+        if constexpr (word_traits::propagate_on_container_move_assignment::value)
+          this->allocator = std::move(other.allocator);
+        this->words = other.words;
         this->init_pad = other.init_pad;
         this->bit_count = other.bit_count;
-        this->bit_byte = other.bit_byte;
-        
-        // Reset other
-        other.bits = nullptr;
+        this->word_count = other.word_count;
+
+        other.words = nullptr;
         other.bit_count = 0;
-        other.bit_byte = 0;
+        other.word_count = 0;
       }
       return *this;
     }
 
     ~bitmap() {
-      if (this->bits) {
-        this->allocator.deallocate(this->bits, this->bit_byte);
-      }
+      this->release();
     }
 
+    /**
+     * @brief 重新分配 bit_count 位，每个字节填充为 init_pad.
+     */
     void init(ulint bit_count) {
+      this->release();
       this->bit_count = bit_count;
-      this->bit_byte = bit_count % 8 ? bit_count / 8 + 1 : bit_count / 8;
-      this->bits = this->allocator.allocate(this->bit_byte);
-      std::memset(this->bits, this->init_pad, this->bit_byte);
+      this->word_count = words_for(bit_count);
+      if (!this->word_count) return;
+      this->words = word_traits::allocate(this->allocator, this->word_count);
+      std::memset(this->words, this->init_pad, this->word_count * sizeof(word_type));
+      this->words[this->word_count - 1] &= this->tail_mask();
     }
 
     void set(ulint location, bool value) {
-      if (location > this->bit_count)
-        throw utils_exception("bitmap::set(): location > bit_count!");
+      if (location >= this->bit_count)
+        throw utils_exception("bitmap::set(): location >= bit_count!");
 
-      ulint byte_offset = location / 8;
-      ulint bit_offset = location % 8;
+      word_type mask = static_cast<word_type>(1) << (location % WORD_BITS);
       if (value)
-        this->bits[byte_offset] |= static_cast<unsigned char>(0b00000001) << bit_offset;
+        this->words[location / WORD_BITS] |= mask;
       else
-        this->bits[byte_offset] &= ~(static_cast<unsigned char>(0b00000001) << bit_offset);
+        this->words[location / WORD_BITS] &= ~mask;
     }
 
     bool get(ulint location) const {
-      ulint byte_offset = location / 8;
-      ulint bit_offset = location % 8;
-
       return static_cast<bool>(
-          this->bits[byte_offset] & (static_cast<unsigned char>(0b00000001) << bit_offset)
+          this->words[location / WORD_BITS] & (static_cast<word_type>(1) << (location % WORD_BITS))
       );
     }
+
+    inline ulint size() const noexcept { return this->bit_count; }
+
+    /**
+     * @brief location 所在字的地址，用于预取.
+     */
+    const word_type *word_of(ulint location) const noexcept { return this->words + location / WORD_BITS; }
+
+    /**
+     * @brief 值为 true 的位数.
+     */
+    ulint count() const noexcept {
+      ulint total = 0;
+      for (ulint w = 0; w < this->word_count; w++) total += popcount64(this->words[w]);
+      return total;
+    }
+
+    /**
+     * @brief 是否有值为 true 的位.
+     */
+    bool any() const noexcept {
+      for (ulint w = 0; w < this->word_count; w++)
+        if (this->words[w]) return true;
+      return false;
+    }
+
+    /**
+     * @brief 从 location 开始(含)向后查找第一个值为 true 的位.
+     * @return 找到的位置，没有时返回 npos
+     */
+    ulint find_next_set(ulint location) const noexcept {
+      if (location >= this->bit_count) return npos;
+      ulint w = location / WORD_BITS;
+      word_type cur = this->words[w] & (~static_cast<word_type>(0) << (location % WORD_BITS));
+      while (!cur) {
+        if (++w == this->word_count) return npos;
+        cur = this->words[w];
+      }
+      return w * WORD_BITS + ctz64(cur);
+    }
+
+    /**
+     * @brief 在 [location, last) 内查找第一个值为 true 的位，只读取覆盖该范围的字.
+     * @return 找到的位置，没有时返回 npos
+     */
+    ulint find_next_set(ulint location, ulint last) const noexcept {
+      if (last > this->bit_count) last = this->bit_count;
+      if (location >= last) return npos;
+      ulint w = location / WORD_BITS;
+      ulint last_word = (last - 1) / WORD_BITS;
+      word_type cur = this->words[w] & (~static_cast<word_type>(0) << (location % WORD_BITS));
+      while (!cur) {
+        if (w == last_word) return npos;
+        cur = this->words[++w];
+      }
+      ulint found = w * WORD_BITS + ctz64(cur);
+      return found < last ? found : npos;
+    }
+
+    /**
+     * @brief 从 location 开始(含)向前查找第一个值为 true 的位.
+     * @return 找到的位置，没有时返回 npos
+     */
+    ulint find_prev_set(ulint location) const noexcept {
+      if (!this->bit_count) return npos;
+      if (location >= this->bit_count) location = this->bit_count - 1;
+      ulint w = location / WORD_BITS;
+      ulint shift = WORD_BITS - 1 - location % WORD_BITS;
+      word_type cur = this->words[w] & (~static_cast<word_type>(0) >> shift);
+      while (!cur) {
+        if (w-- == 0) return npos;
+        cur = this->words[w];
+      }
+      return w * WORD_BITS + (WORD_BITS - 1 - clz64(cur));
+    }
+
+    /**
+     * @brief 把 [first, last) 范围内的位全部设置为 true.
+     */
+    void set_range(ulint first, ulint last) {
+      if (last > this->bit_count)
+        throw utils_exception("bitmap::set_range(): last > bit_count!");
+      this->fill_range(first, last, true);
+    }
+
+    /**
+     * @brief 把 [first, last) 范围内的位全部设置为 false.
+     */
+    void clear_range(ulint first, ulint last) {
+      if (last > this->bit_count)
+        throw utils_exception("bitmap::clear_range(): last > bit_count!");
+      this->fill_range(first, last, false);
+    }
+
+    /**
+     * @brief 所有位设置为 true.
+     */
+    void set_all() noexcept {
+      if (!this->word_count) return;
+      std::memset(this->words, 0xFF, this->word_count * sizeof(word_type));
+      this->words[this->word_count - 1] &= this->tail_mask();
+    }
+
+    /**
+     * @brief 所有位设置为 false，不重新分配内存.
+     */
+    void clear_all() noexcept {
+      if (this->word_count) std::memset(this->words, 0, this->word_count * sizeof(word_type));
+    }
+
+    /**
+     * @brief 按位与，只处理两者共有的位.
+     */
+    bitmap& operator&=(const bitmap& other) noexcept {
+      ulint n = this->word_count < other.word_count ? this->word_count : other.word_count;
+      for (ulint w = 0; w < n; w++) this->words[w] &= other.words[w];
+      for (ulint w = n; w < this->word_count; w++) this->words[w] = 0;
+      return *this;
+    }
+
+    /**
+     * @brief 按位或，只处理两者共有的位.
+     */
+    bitmap& operator|=(const bitmap& other) noexcept {
+      ulint n = this->word_count < other.word_count ? this->word_count : other.word_count;
+      for (ulint w = 0; w < n; w++) this->words[w] |= other.words[w];
+      if (n == this->word_count && n) this->words[n - 1] &= this->tail_mask();
+      return *this;
+    }
 };
 
 
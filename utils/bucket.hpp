@@ -0,0 +1,741 @@
+/**
+ * @file bucket.hpp
+ * @brief HashMap 的桶: 根据元素个数在内联元素、小有序数组和红黑树之间切换.
+ */
+#ifndef HASHMAP_UTILS_BUCKET_HPP
+#define HASHMAP_UTILS_BUCKET_HPP
+
+#include "__def.hpp"
+#include "__iterator.hpp"
+#include "rbtree.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace utils {
+
+/**
+ * @brief 自适应桶.
+ * @details 负载因子为 0.75 时绝大多数桶只有 0~2 个元素，没有必要为每个元素分配一个红黑树节点:
+ *   - 空桶不占用额外内存;
+ *   - 只有一个元素时直接存放在桶内(内联);
+ *   - 2 ~ SMALL_CAPACITY 个元素时存放在一块连续的有序数组中，二分查找;
+ *   - 超过 SMALL_CAPACITY 个元素时转为红黑树，保证最坏情况 O(log n);
+ *     红黑树的元素减少到 UNTREEIFY_THRESHOLD 个时再转回有序数组.
+ *   push 返回的指针和迭代器在下一次修改该桶之前有效.
+ * @tparam T 元素类型
+ * @tparam Compare 元素的严格弱序比较函数对象，等价(互不小于)的元素可以有多个
+ * @tparam Equal 元素的相等比较函数对象，相等的元素在 Compare 下必须等价，等价的元素不一定相等
+ * @tparam Allocator 分配器类型，重绑定后用于有序数组、红黑树对象及其节点
+ */
+template <typename T, typename Compare, typename Equal, typename Allocator = std::allocator<T> >
+class adaptive_bucket : private ebo_storage<Compare, 0>,
+                        private ebo_storage<Equal, 1>,
+                        private ebo_storage<typename std::allocator_traits<Allocator>::template rebind_alloc<T>, 2> {
+  public:
+    using allocator_type = Allocator;
+    using tree_type      = rbtree<T, Compare, Equal, Allocator>;
+
+    static constexpr uint32_t SMALL_CAPACITY      = 8;
+    static constexpr uint32_t UNTREEIFY_THRESHOLD = 6;
+
+    class iterator : public utils::_iterator<T*, iterator> {
+      friend class adaptive_bucket;
+
+      protected:
+        T *first = nullptr;                         // 内联/数组形式的第一个元素
+        T *last = nullptr;                          // 内联/数组形式的尾后位置
+        bool in_tree = false;                       // 是否为红黑树形式
+        typename tree_type::iterator tree_iter;     // 红黑树形式的迭代器
+
+      public:
+        using utils::_iterator<T*, iterator>::_iterator;
+        iterator() = default;
+
+        bool operator==(const iterator &iter) const {
+          if (this->in_tree != iter.in_tree) return false;
+          if (this->in_tree) return this->tree_iter == iter.tree_iter;
+          return this->ptr == iter.ptr;
+        }
+
+        bool operator!=(const iterator &iter) const {
+          return !(*this == iter);
+        }
+
+        void goback() {
+          if (this->in_tree) {
+            ++this->tree_iter;
+            this->ptr = &*this->tree_iter;
+          } else if (this->ptr != this->last) {
+            ++this->ptr;
+          }
+        }
+
+        void goback(size_t n) {
+          for (size_t i = 0; i != n; i++) this->goback();
+        }
+
+        void gofront() {
+          if (this->in_tree) {
+            --this->tree_iter;
+            this->ptr = &*this->tree_iter;
+          } else if (this->ptr != this->first) {
+            --this->ptr;
+          }
+        }
+
+        void gofront(size_t n) {
+          for (size_t i = 0; i != n; i++) this->gofront();
+        }
+    };
+
+  protected:
+    enum class form_t : uint8_t { EMPTY, INLINE, ARRAY, TREE };
+
+    using array_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+    using array_traits    = std::allocator_traits<array_allocator>;
+    using tree_allocator  = typename std::allocator_traits<Allocator>::template rebind_alloc<tree_type>;
+    using tree_traits     = std::allocator_traits<tree_allocator>;
+    using comparer_base   = ebo_storage<Compare, 0>;
+    using equaler_base    = ebo_storage<Equal, 1>;
+    using alloc_base      = ebo_storage<array_allocator, 2>;
+
+    union {
+      alignas(T) unsigned char inline_storage[sizeof(T)];   // INLINE: 唯一的元素
+      T *array;                                             // ARRAY: 有序数组
+      tree_type *tree;                                      // TREE: 红黑树
+    };
+    uint32_t count = 0;                                     // INLINE/ARRAY 形式的元素个数
+    uint8_t array_capacity = 0;                             // ARRAY 形式的数组容量
+    form_t form = form_t::EMPTY;
+
+    const Compare &comparer() const noexcept { return comparer_base::get(); }
+    const Equal &equaler() const noexcept { return equaler_base::get(); }
+    array_allocator &array_alloc() noexcept { return alloc_base::get(); }
+    const array_allocator &array_alloc() const noexcept { return alloc_base::get(); }
+
+    T *inline_value() noexcept {
+      return std::launder(reinterpret_cast<T *>(this->inline_storage));
+    }
+
+    const T *inline_value() const noexcept {
+      return std::launder(reinterpret_cast<const T *>(this->inline_storage));
+    }
+
+    /**
+     * @brief 有序数组中第一个不小于 val 的位置.
+     */
+    template <typename U>
+    uint32_t lower_bound(const U &val) const {
+      return static_cast<uint32_t>(
+          std::lower_bound(this->array, this->array + this->count, val, this->comparer()) - this->array);
+    }
+
+    /**
+     * @brief 有序数组中与 val 相等的元素的下标，不存在时返回 count.
+     * @details 从 val 的 lower_bound 位置 pos 起，在与 val 等价的一段中用 Equal 逐个比较.
+     */
+    template <typename U>
+    uint32_t find_pos(const U &val, uint32_t pos) const {
+      for (; pos < this->count && !this->comparer()(val, this->array[pos]); pos++) {
+        if (this->equaler()(this->array[pos], val)) return pos;
+      }
+      return this->count;
+    }
+
+    T *allocate_array(uint32_t capacity) {
+      this->array_capacity = static_cast<uint8_t>(capacity);
+      return array_traits::allocate(this->array_alloc(), capacity);
+    }
+
+    void deallocate_array(T *arr, uint32_t capacity) {
+      array_traits::deallocate(this->array_alloc(), arr, capacity);
+    }
+
+    /**
+     * @brief 把元素从 src 移动构造到未初始化的 dst，并析构 src.
+     */
+    static void relocate(T *src, T *dst, uint32_t n) {
+      for (uint32_t i = 0; i < n; i++) {
+        ::new (static_cast<void *>(dst + i)) T(std::move(src[i]));
+        src[i].~T();
+      }
+    }
+
+    /**
+     * @brief 内联/数组形式的第一个元素，空桶返回 nullptr.
+     */
+    T *data() const noexcept {
+      switch (this->form) {
+        case form_t::INLINE: return const_cast<T *>(this->inline_value());
+        case form_t::ARRAY:  return this->array;
+        default:             return nullptr;
+      }
+    }
+
+    tree_type *make_tree() {
+      tree_allocator talloc(this->array_alloc());
+      tree_type *t = tree_traits::allocate(talloc, 1);
+      try {
+        // 直接构造：红黑树已经显式接收分配器，不需要 uses-allocator 构造
+        ::new (static_cast<void *>(t)) tree_type(this->comparer(), this->equaler(), Allocator(this->array_alloc()));
+      } catch (...) {
+        tree_traits::deallocate(talloc, t, 1);
+        throw;
+      }
+      return t;
+    }
+
+    void delete_tree(tree_type *t) {
+      tree_allocator talloc(this->array_alloc());
+      t->~tree_type();
+      tree_traits::deallocate(talloc, t, 1);
+    }
+
+    /**
+     * @brief 有序数组转为红黑树. 数组已经有序，直接线性构造，不逐个插入.
+     */
+    void treeify() {
+      tree_type *t = this->make_tree();
+      try {
+        t->assign_sorted(std::make_move_iterator(this->array), std::make_move_iterator(this->array + this->count));
+      } catch (...) {
+        this->delete_tree(t);
+        throw;
+      }
+      for (uint32_t i = 0; i < this->count; i++) this->array[i].~T();
+      this->deallocate_array(this->array, this->array_capacity);
+      this->tree = t;
+      this->form = form_t::TREE;
+    }
+
+    /**
+     * @brief 红黑树转回有序数组.
+     */
+    void untreeify() {
+      tree_type *t = this->tree;
+      uint32_t n = static_cast<uint32_t>(t->size());
+      T *arr = this->allocate_array(SMALL_CAPACITY);
+      uint32_t i = 0;
+      for (auto it = t->begin(); it != t->end(); ++it, ++i) {
+        ::new (static_cast<void *>(arr + i)) T(std::move(*it));
+      }
+      this->delete_tree(t);
+      this->array = arr;
+      this->count = n;
+      this->form = form_t::ARRAY;
+    }
+
+    template <typename U>
+    T *push_impl(U &&val) {
+      switch (this->form) {
+        case form_t::EMPTY:
+          ::new (static_cast<void *>(this->inline_storage)) T(std::forward<U>(val));
+          this->count = 1;
+          this->form = form_t::INLINE;
+          return this->inline_value();
+
+        case form_t::INLINE: {
+          T *cur = this->inline_value();
+          if (this->equaler()(*cur, val)) {
+            *cur = std::forward<U>(val);
+            return cur;
+          }
+          T *arr = this->allocate_array(2);
+          bool before = this->comparer()(val, *cur);
+          ::new (static_cast<void *>(arr + (before ? 1 : 0))) T(std::move(*cur));
+          ::new (static_cast<void *>(arr + (before ? 0 : 1))) T(std::forward<U>(val));
+          cur->~T();
+          this->array = arr;
+          this->count = 2;
+          this->form = form_t::ARRAY;
+          return arr + (before ? 0 : 1);
+        }
+
+        case form_t::ARRAY: {
+          uint32_t pos = this->lower_bound(val);
+          uint32_t found = this->find_pos(val, pos);
+          if (found < this->count) {
+            this->array[found] = std::forward<U>(val);
+            return this->array + found;
+          }
+          if (this->count == SMALL_CAPACITY) {
+            this->treeify();
+            return this->tree->push(std::forward<U>(val));
+          }
+          if (this->count == this->array_capacity) {
+            uint32_t old_capacity = this->array_capacity;
+            T *arr = this->allocate_array(std::min<uint32_t>(old_capacity * 2, SMALL_CAPACITY));
+            relocate(this->array, arr, this->count);
+            this->deallocate_array(this->array, old_capacity);
+            this->array = arr;
+          }
+          T *arr = this->array;
+          if (pos == this->count) {
+            ::new (static_cast<void *>(arr + pos)) T(std::forward<U>(val));
+          } else {
+            ::new (static_cast<void *>(arr + this->count)) T(std::move(arr[this->count - 1]));
+            std::move_backward(arr + pos, arr + this->count - 1, arr + this->count);
+            arr[pos] = std::forward<U>(val);
+          }
+          this->count++;
+          return arr + pos;
+        }
+
+        case form_t::TREE:
+        default:
+          return this->tree->push(std::forward<U>(val));
+      }
+    }
+
+    void copy_from(const adaptive_bucket &other) {
+      switch (other.form) {
+        case form_t::EMPTY:
+          break;
+        case form_t::INLINE:
+          ::new (static_cast<void *>(this->inline_storage)) T(*other.inline_value());
+          break;
+        case form_t::ARRAY:
+          this->array = this->allocate_array(other.array_capacity);
+          for (uint32_t i = 0; i < other.count; i++)
+            ::new (static_cast<void *>(this->array + i)) T(other.array[i]);
+          break;
+        case form_t::TREE:
+          this->tree = this->make_tree();
+          try {
+            this->tree->assign_sorted(other.tree->begin(), other.tree->end());
+          } catch (...) {
+            this->delete_tree(this->tree);
+            throw;
+          }
+          break;
+      }
+      this->count = other.count;
+      this->form = other.form;
+    }
+
+    void steal_from(adaptive_bucket &other) noexcept {
+      switch (other.form) {
+        case form_t::EMPTY:
+          break;
+        case form_t::INLINE:
+          ::new (static_cast<void *>(this->inline_storage)) T(std::move(*other.inline_value()));
+          other.inline_value()->~T();
+          break;
+        case form_t::ARRAY:
+          this->array = other.array;
+          this->array_capacity = other.array_capacity;
+          break;
+        case form_t::TREE:
+          this->tree = other.tree;
+          break;
+      }
+      this->count = other.count;
+      this->form = other.form;
+      other.count = 0;
+      other.form = form_t::EMPTY;
+    }
+
+    /**
+     * @brief 分配器不相等时逐个移动 other 的元素到本桶自己的存储中，然后清空 other.
+     * @details 只要求 T 可移动构造，元素只能移动的桶也能在不同分配器之间转移.
+     */
+    void move_from(adaptive_bucket &other) {
+      switch (other.form) {
+        case form_t::EMPTY:
+          break;
+        case form_t::INLINE:
+          ::new (static_cast<void *>(this->inline_storage)) T(std::move(*other.inline_value()));
+          break;
+        case form_t::ARRAY: {
+          this->array = this->allocate_array(other.array_capacity);
+          uint32_t i = 0;
+          try {
+            for (; i < other.count; i++)
+              ::new (static_cast<void *>(this->array + i)) T(std::move(other.array[i]));
+          } catch (...) {
+            for (uint32_t j = 0; j < i; j++) this->array[j].~T();
+            this->deallocate_array(this->array, this->array_capacity);
+            throw;
+          }
+          break;
+        }
+        case form_t::TREE:
+          this->tree = this->make_tree();
+          try {
+            this->tree->assign_sorted(std::make_move_iterator(other.tree->begin()),
+                                      std::make_move_iterator(other.tree->end()));
+          } catch (...) {
+            this->delete_tree(this->tree);
+            throw;
+          }
+          break;
+      }
+      this->count = other.count;
+      this->form = other.form;
+      other.clear();
+    }
+
+    /**
+     * @brief 移动 other 的内容: 分配器相等时直接接管存储，否则逐个移动元素.
+     *        分配器总是相等时不比较，也不实例化逐个移动的分支.
+     */
+    void take_from(adaptive_bucket &other) {
+      if constexpr (array_traits::is_always_equal::value) {
+        this->steal_from(other);
+      } else {
+        if (this->array_alloc() == other.array_alloc())
+          this->steal_from(other);
+        else
+          this->move_from(other);
+      }
+    }
+
+  public:
+    explicit adaptive_bucket(const Compare &compare = Compare(), const Equal &equal = Equal(),
+                             const Allocator &alloc = Allocator())
+      : comparer_base(compare), equaler_base(equal), alloc_base(array_allocator(alloc)) {}
+
+    adaptive_bucket(const adaptive_bucket &other)
+      : comparer_base(other.comparer()), equaler_base(other.equaler()),
+        alloc_base(array_traits::select_on_container_copy_construction(other.array_alloc())) {
+      this->copy_from(other);
+    }
+
+    adaptive_bucket(adaptive_bucket &&other) noexcept
+      : comparer_base(other.comparer()), equaler_base(other.equaler()), alloc_base(std::move(other.array_alloc())) {
+      this->steal_from(other);
+    }
+
+    // 扩展分配器的构造函数，供 uses-allocator 构造(例如 std::pmr 容器中的桶)使用
+    adaptive_bucket(const adaptive_bucket &other, const Allocator &alloc)
+      : comparer_base(other.comparer()), equaler_base(other.equaler()), alloc_base(array_allocator(alloc)) {
+      this->copy_from(other);
+    }
+
+    adaptive_bucket(adaptive_bucket &&other, const Allocator &alloc)
+      : comparer_base(other.comparer()), equaler_base(other.equaler()), alloc_base(array_allocator(alloc)) {
+      this->take_from(other);
+    }
+
+    adaptive_bucket &operator=(const adaptive_bucket &other) {
+      if (this != &other) {
+        this->clear();
+        comparer_base::get() = other.comparer();
+        equaler_base::get() = other.equaler();
+        if constexpr (array_traits::propagate_on_container_copy_assignment::value)
+          this->array_alloc() = other.array_alloc();
+        this->copy_from(other);
+      }
+      return *this;
+    }
+
+    adaptive_bucket &operator=(adaptive_bucket &&other) {
+      if (this != &other) {
+        this->clear();
+        comparer_base::get() = other.comparer();
+        equaler_base::get() = other.equaler();
+        if constexpr (array_traits::propagate_on_container_move_assignment::value)
+          this->array_alloc() = std::move(other.array_alloc());
+        this->take_from(other);
+      }
+      return *this;
+    }
+
+    allocator_type get_allocator() const { return allocator_type(this->array_alloc()); }
+
+    ~adaptive_bucket() { this->clear(); }
+
+    /**
+     * @brief 插入元素，已有相等元素时用 val 覆盖.
+     * @return 桶内元素的指针
+     */
+    T *push(const T &val) { return this->push_impl(val); }
+    T *push(T &&val) { return this->push_impl(std::move(val)); }
+
+    /**
+     * @brief 用 args 直接在桶的存储中构造新元素，不经过临时对象.
+     * @details 调用者须保证桶内没有与 key 相等的元素. key 只在构造之前用来确定位置，可以引用 args 中将被移动的对象.
+     *          构造抛出异常时桶保持不变.
+     * @param key 新元素的键，可以是任何能与 T 一起传给 Compare 的类型
+     * @return 新元素的指针
+     */
+    template <typename K, typename... Args>
+    T *emplace_unique(const K &key, Args &&...args) {
+      switch (this->form) {
+        case form_t::EMPTY:
+          ::new (static_cast<void *>(this->inline_storage)) T(std::forward<Args>(args)...);
+          this->count = 1;
+          this->form = form_t::INLINE;
+          return this->inline_value();
+
+        case form_t::INLINE: {
+          T *cur = this->inline_value();
+          bool before = this->comparer()(key, *cur);
+          T *arr = this->allocate_array(2);
+          try {
+            ::new (static_cast<void *>(arr + (before ? 0 : 1))) T(std::forward<Args>(args)...);
+          } catch (...) {
+            this->deallocate_array(arr, 2);
+            this->array_capacity = 0;
+            throw;
+          }
+          ::new (static_cast<void *>(arr + (before ? 1 : 0))) T(std::move(*cur));
+          cur->~T();
+          this->array = arr;
+          this->count = 2;
+          this->form = form_t::ARRAY;
+          return arr + (before ? 0 : 1);
+        }
+
+        case form_t::ARRAY: {
+          if (this->count == SMALL_CAPACITY) {
+            this->treeify();
+            return this->tree->emplace(std::forward<Args>(args)...);
+          }
+          uint32_t pos = this->lower_bound(key);
+          if (this->count == this->array_capacity) {
+            uint32_t old_capacity = this->array_capacity;
+            T *arr = this->allocate_array(std::min<uint32_t>(old_capacity * 2, SMALL_CAPACITY));
+            relocate(this->array, arr, this->count);
+            this->deallocate_array(this->array, old_capacity);
+            this->array = arr;
+          }
+          // 先在尾部构造，再轮转到有序位置
+          T *arr = this->array;
+          ::new (static_cast<void *>(arr + this->count)) T(std::forward<Args>(args)...);
+          std::rotate(arr + pos, arr + this->count, arr + this->count + 1);
+          this->count++;
+          return arr + pos;
+        }
+
+        case form_t::TREE:
+        default:
+          return this->tree->emplace(std::forward<Args>(args)...);
+      }
+    }
+
+    /**
+     * @brief 查找与 target 相等的元素，不存在时返回 nullptr.
+     * @details target 可以是任何能与 T 一起传给 Compare 和 Equal 的类型，例如只有键的异构查找.
+     */
+    template <typename U>
+    T *find(const U &target) {
+      switch (this->form) {
+        case form_t::INLINE:
+          return this->equaler()(*this->inline_value(), target) ? this->inline_value() : nullptr;
+        case form_t::ARRAY: {
+          uint32_t pos = this->find_pos(target, this->lower_bound(target));
+          return pos < this->count ? this->array + pos : nullptr;
+        }
+        case form_t::TREE:
+          return const_cast<T *>(this->tree->find(target));
+        default:
+          return nullptr;
+      }
+    }
+
+    /**
+     * @brief 删除与 val 相等的元素.
+     * @return true 表示找到并删除了元素
+     */
+    template <typename U>
+    bool remove(const U &val) {
+      switch (this->form) {
+        case form_t::INLINE:
+          if (!this->equaler()(*this->inline_value(), val)) return false;
+          this->clear();
+          return true;
+
+        case form_t::ARRAY: {
+          uint32_t pos = this->find_pos(val, this->lower_bound(val));
+          if (pos == this->count) return false;
+          std::move(this->array + pos + 1, this->array + this->count, this->array + pos);
+          this->array[--this->count].~T();
+          if (this->count == 1) {
+            T *arr = this->array;
+            uint32_t capacity = this->array_capacity;
+            ::new (static_cast<void *>(this->inline_storage)) T(std::move(arr[0]));
+            arr[0].~T();
+            this->deallocate_array(arr, capacity);
+            this->form = form_t::INLINE;
+          }
+          return true;
+        }
+
+        case form_t::TREE:
+          if (!this->tree->remove(val)) return false;
+          if (this->tree->size() <= UNTREEIFY_THRESHOLD) this->untreeify();
+          return true;
+
+        default:
+          return false;
+      }
+    }
+
+    /**
+     * @brief 删除所有使 pred(元素) 为真的元素，剩余元素保持有序.
+     * @details 有序数组原地压缩；红黑树把剩余元素移出后按元素个数重新选择形式，线性构造.
+     * @return 删除的元素个数
+     */
+    template <typename Pred>
+    unsigned long long remove_if(Pred pred) {
+      switch (this->form) {
+        case form_t::INLINE:
+          if (!pred(*this->inline_value())) return 0;
+          this->clear();
+          return 1;
+
+        case form_t::ARRAY: {
+          uint32_t kept = 0;
+          for (uint32_t i = 0; i < this->count; i++) {
+            if (pred(this->array[i])) continue;
+            if (kept != i) this->array[kept] = std::move(this->array[i]);
+            kept++;
+          }
+          uint32_t removed = this->count - kept;
+          for (uint32_t i = kept; i < this->count; i++) this->array[i].~T();
+          this->count = kept;
+          if (kept <= 1) {
+            T *arr = this->array;
+            uint32_t capacity = this->array_capacity;
+            if (kept == 1) {
+              ::new (static_cast<void *>(this->inline_storage)) T(std::move(arr[0]));
+              arr[0].~T();
+              this->form = form_t::INLINE;
+            } else {
+              this->form = form_t::EMPTY;
+            }
+            this->deallocate_array(arr, capacity);
+          }
+          return removed;
+        }
+
+        case form_t::TREE: {
+          std::vector<T, array_allocator> kept(this->array_alloc());
+          kept.reserve(this->tree->size());
+          unsigned long long removed = 0;
+          for (auto it = this->tree->begin(); it != this->tree->end(); ++it) {
+            if (pred(*it)) removed++;
+            else kept.push_back(std::move(*it));
+          }
+          if (removed == 0) return 0;
+          uint32_t n = static_cast<uint32_t>(kept.size());
+          if (n > UNTREEIFY_THRESHOLD) {
+            tree_type *t = this->make_tree();
+            try {
+              t->assign_sorted(std::make_move_iterator(kept.begin()), std::make_move_iterator(kept.end()));
+            } catch (...) {
+              this->delete_tree(t);
+              throw;
+            }
+            this->clear();
+            this->tree = t;
+            this->form = form_t::TREE;
+            return removed;
+          }
+          this->clear();
+          if (n > 1) {
+            this->array = this->allocate_array(SMALL_CAPACITY);
+            for (uint32_t i = 0; i < n; i++) ::new (static_cast<void *>(this->array + i)) T(std::move(kept[i]));
+            this->count = n;
+            this->form = form_t::ARRAY;
+          } else if (n == 1) {
+            ::new (static_cast<void *>(this->inline_storage)) T(std::move(kept[0]));
+            this->count = 1;
+            this->form = form_t::INLINE;
+          }
+          return removed;
+        }
+
+        default:
+          return 0;
+      }
+    }
+
+    /**
+     * @brief 析构所有元素，释放数组或红黑树，桶变为空.
+     */
+    void clear() {
+      switch (this->form) {
+        case form_t::INLINE:
+          this->inline_value()->~T();
+          break;
+        case form_t::ARRAY:
+          for (uint32_t i = 0; i < this->count; i++) this->array[i].~T();
+          this->deallocate_array(this->array, this->array_capacity);
+          break;
+        case form_t::TREE:
+          this->delete_tree(this->tree);
+          break;
+        default:
+          break;
+      }
+      this->count = 0;
+      this->form = form_t::EMPTY;
+    }
+
+    unsigned long long size() const {
+      return this->form == form_t::TREE ? this->tree->size() : this->count;
+    }
+
+    bool is_tree() const { return this->form == form_t::TREE; }
+
+    /**
+     * @brief 红黑树形式的树高，其他形式为 0.
+     */
+    unsigned long long tree_height() const {
+      return this->form == form_t::TREE ? this->tree->height() : 0;
+    }
+
+    /**
+     * @brief 在桶对象之外分配的字节数: ARRAY 形式的有序数组，TREE 形式的红黑树对象及其节点.
+     */
+    unsigned long long heap_bytes() const {
+      switch (this->form) {
+        case form_t::ARRAY:
+          return static_cast<unsigned long long>(this->array_capacity) * sizeof(T);
+        case form_t::TREE:
+          return sizeof(tree_type) + this->tree->size() * sizeof(rb_node<T>);
+        default:
+          return 0;
+      }
+    }
+
+    iterator begin() const {
+      iterator iter;
+      if (this->form == form_t::TREE) {
+        iter.in_tree = true;
+        iter.tree_iter = this->tree->begin();
+        iter.ptr = &*iter.tree_iter;
+      } else {
+        iter.first = this->data();
+        iter.last = iter.first + this->count;
+        iter.ptr = iter.first;
+      }
+      return iter;
+    }
+
+    iterator end() const {
+      iterator iter;
+      if (this->form == form_t::TREE) {
+        iter.in_tree = true;
+        iter.tree_iter = this->tree->end();
+        iter.ptr = &*iter.tree_iter;
+      } else {
+        iter.first = this->data();
+        iter.last = iter.first + this->count;
+        iter.ptr = iter.last;
+      }
+      return iter;
+    }
+};
+
+} // namespace utils
+
+#endif  // HASHMAP_UTILS_BUCKET_HPP
@@ -0,0 +1,886 @@
+/**
+ * @file flat_table.hpp
+ * @brief 开放寻址的平坦哈希表，HashMap 的可选存储引擎.
+ */
+#ifndef HASHMAP_UTILS_FLAT_TABLE_HPP
+#define HASHMAP_UTILS_FLAT_TABLE_HPP
+
+#include "__def.hpp"
+#include "__iterator.hpp"
+#include "hash.hpp"
+#include "memory_report.hpp"
+#include "thread_pool.hpp"
+#include "xxhash32.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HASHMAP_FLAT_TABLE_SSE2 1
+#include <emmintrin.h>
+#else
+#define HASHMAP_FLAT_TABLE_SSE2 0
+#endif
+
+namespace utils {
+
+namespace _flat_table {
+
+  using ctrl_t = int8_t;
+
+  static constexpr ctrl_t CTRL_EMPTY   = -128;  // 0b10000000, 空槽
+  static constexpr ctrl_t CTRL_DELETED = -2;    // 0b11111110, 墓碑
+  // 0b0xxxxxxx: 已占用，低7位为哈希值的低7位(h2)
+
+  static constexpr ulint GROUP_WIDTH = 16;
+
+  /**
+   * @brief 16个连续控制字节组成的组，一次比较整组.
+   * @details 每个方法返回16位掩码，第 i 位对应组内第 i 个槽.
+   */
+  struct group {
+#if HASHMAP_FLAT_TABLE_SSE2
+    __m128i ctrl;
+
+    explicit group(const ctrl_t *pos)
+      : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pos))) {}
+
+    uint32_t match(ctrl_t h2) const {
+      return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), this->ctrl)));
+    }
+
+    // 空槽和墓碑的最高位都是1
+    uint32_t match_free() const {
+      return static_cast<uint32_t>(_mm_movemask_epi8(this->ctrl));
+    }
+#else
+    ctrl_t ctrl[GROUP_WIDTH];
+
+    explicit group(const ctrl_t *pos) { std::memcpy(this->ctrl, pos, GROUP_WIDTH); }
+
+    uint32_t match(ctrl_t h2) const {
+      uint32_t mask = 0;
+      for (ulint i = 0; i < GROUP_WIDTH; i++)
+        mask |= uint32_t(this->ctrl[i] == h2) << i;
+      return mask;
+    }
+
+    uint32_t match_free() const {
+      uint32_t mask = 0;
+      for (ulint i = 0; i < GROUP_WIDTH; i++)
+        mask |= uint32_t(this->ctrl[i] < 0) << i;
+      return mask;
+    }
+#endif
+
+    uint32_t match_empty() const { return this->match(CTRL_EMPTY); }
+    uint32_t match_full() const { return ~this->match_free() & 0xFFFFu; }
+  };
+
+} // namespace _flat_table
+
+/**
+ * @brief 开放寻址的平坦哈希表.
+ * @details 元素直接存放在一块连续的槽数组里，每个槽另有1字节控制字节(空 / 墓碑 / 哈希值低7位).
+ *          哈希值的高位选择起始组，按三角数步长在组间探测，每次用 SSE2 同时比较一组16个控制字节，
+ *          只有低7位相同的槽才会比较键. 没有 SSE2 时退化为逐字节比较.
+ *          接口与 HashMap 相同，由 HashMap<..., hashmap_storage::flat> 使用.
+ * @tparam Key 键类型
+ * @tparam Value 值类型
+ * @tparam Hash 哈希函数对象类型
+ * @tparam KeyEqual 键相等比较函数对象类型
+ * @tparam Allocator 内存分配器类型
+ */
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+class flat_table {
+  public:
+    using key_type        = Key;
+    using mapped_type     = Value;
+    using value_type      = std::pair<const Key, Value>;
+    using pair_type       = std::pair<Key, Value>;
+    using const_pair_type = std::pair<const Key, Value>;
+    using size_type       = unsigned long long;
+    using allocator_type  = Allocator;
+    using hasher_type     = Hash;
+    using key_equal_type  = KeyEqual;
+    using hasher          = Hash;
+    using key_equal       = KeyEqual;
+
+  protected:
+    using ctrl_t = _flat_table::ctrl_t;
+    using group  = _flat_table::group;
+
+    // 哈希器和键相等比较器都声明了 is_transparent 时，查找接受任何可与 Key 比较的类型
+    template <typename K>
+    using key_arg = typename utils::key_arg_impl<utils::is_transparent<Hash>::value &&
+                                                 utils::is_transparent<KeyEqual>::value>::template type<K, Key>;
+
+    using slot_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<pair_type>;
+    using ctrl_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<ctrl_t>;
+    using slot_traits         = std::allocator_traits<slot_allocator_type>;
+    using ctrl_traits         = std::allocator_traits<ctrl_allocator_type>;
+
+    static constexpr size_type GROUP_WIDTH = _flat_table::GROUP_WIDTH;
+    static constexpr size_type npos = std::numeric_limits<size_type>::max();
+    static constexpr double MAX_LOAD_FACTOR = 0.875;  // 最大负载因子的默认值和上限，占用槽 + 墓碑 不超过 7/8
+    static constexpr size_type BATCH_CHUNK = 32;       // 批量操作每一轮先哈希并预取的键数
+    static constexpr size_type PARALLEL_GRAIN = 4096;  // 并行操作每个任务至少处理的槽数，GROUP_WIDTH 的倍数
+
+    ctrl_t *ctrl = nullptr;        // 控制字节
+    pair_type *slots = nullptr;    // 槽
+    size_type capacity = 0;        // 槽数，GROUP_WIDTH 的 2 的幂倍
+    size_type size_ = 0;           // 元素数
+    size_type deleted = 0;         // 墓碑数
+    double max_load_factor_ = MAX_LOAD_FACTOR;  // 占用槽 + 墓碑 的比例上限
+
+    hasher_type hash_function_;
+    key_equal_type key_eq_;
+    allocator_type allocator;
+    slot_allocator_type slot_allocator;
+    ctrl_allocator_type ctrl_allocator;
+
+  public:
+    class iterator : public utils::_iterator<const_pair_type*, iterator> {
+      friend class flat_table;
+
+      protected:
+        const flat_table *table = nullptr;
+        size_type index = 0;       // 当前槽下标，end() 为 capacity
+
+        void point(size_type idx) {
+          this->index = idx;
+          this->ptr = idx < this->table->capacity
+                    ? reinterpret_cast<const_pair_type*>(this->table->slots + idx) : nullptr;
+        }
+
+      public:
+        using utils::_iterator<const_pair_type*, iterator>::_iterator;
+        iterator() = default;
+        iterator(const flat_table *table, size_type idx) : table(table) { this->point(idx); }
+
+        void goback() {
+          if (this->table && this->index < this->table->capacity)
+            this->point(this->table->next_full(this->index + 1));
+        }
+
+        void goback(size_t n) {
+          for (size_t i = 0; i < n; ++i) this->goback();
+        }
+
+        void gofront() {
+          if (!this->table) return;
+          size_type prev = this->table->prev_full(this->index);
+          if (prev != npos) this->point(prev);
+        }
+
+        void gofront(size_t n) {
+          for (size_t i = 0; i < n; ++i) this->gofront();
+        }
+    };
+
+    using const_iterator = iterator;
+
+  protected:
+    /**
+     * @brief 计算键的32位哈希值，与 HashMap 相同.
+     */
+    template <typename K>
+    uint32_t hash_key(const K &key) const {
+      auto hash = this->hash_function_(key);
+      if constexpr (utils::is_avalanching<hasher_type>::value && sizeof(hash) <= sizeof(uint32_t)) {
+        return static_cast<uint32_t>(hash);
+      } else {
+        return utils::XXHash32::hash_raw(&hash, sizeof(hash));
+      }
+    }
+
+    static ctrl_t h2_of(uint32_t hash) { return static_cast<ctrl_t>(hash & 0x7F); }
+
+    /**
+     * @brief 探测序列的起始组.
+     */
+    static size_type first_group(uint32_t hash, size_type capacity) {
+      return utils::XXHash32::map_linear(hash, 0, static_cast<uint32_t>(capacity / GROUP_WIDTH - 1));
+    }
+
+    /**
+     * @brief 根据预估数据规模计算槽数.
+     */
+    size_type capacity_for(size_type estimated_size) const {
+      size_type needed = static_cast<size_type>(estimated_size / this->max_load_factor_) + 1;
+      size_type cap = GROUP_WIDTH;
+      while (cap < needed) cap <<= 1;
+      return cap;
+    }
+
+    size_type growth_limit() const {
+      return static_cast<size_type>(this->capacity * this->max_load_factor_);
+    }
+
+    void allocate(size_type cap) {
+      this->ctrl = ctrl_traits::allocate(this->ctrl_allocator, cap);
+      this->slots = slot_traits::allocate(this->slot_allocator, cap);
+      std::memset(this->ctrl, static_cast<unsigned char>(_flat_table::CTRL_EMPTY), cap);
+      this->capacity = cap;
+    }
+
+    /**
+     * @brief 析构所有元素并释放槽数组.
+     */
+    void release() {
+      if (!this->ctrl) return;
+      this->destroy_all();
+      ctrl_traits::deallocate(this->ctrl_allocator, this->ctrl, this->capacity);
+      slot_traits::deallocate(this->slot_allocator, this->slots, this->capacity);
+      this->ctrl = nullptr;
+      this->slots = nullptr;
+      this->capacity = 0;
+    }
+
+    void destroy_all() {
+      for (size_type g = 0; g < this->capacity; g += GROUP_WIDTH) {
+        for (uint32_t m = group(this->ctrl + g).match_full(); m; m &= m - 1)
+          slot_traits::destroy(this->slot_allocator, this->slots + g + utils::ctz64(m));
+      }
+    }
+
+    /**
+     * @brief 查找键所在的槽，不存在时返回 npos.
+     */
+    template <typename K>
+    size_type find_index(const K &key, uint32_t hash) const {
+      const ctrl_t h2 = h2_of(hash);
+      const size_type mask = this->capacity / GROUP_WIDTH - 1;
+      size_type g = first_group(hash, this->capacity);
+      for (size_type step = 0; step <= mask; ) {
+        group grp(this->ctrl + g * GROUP_WIDTH);
+        for (uint32_t m = grp.match(h2); m; m &= m - 1) {
+          size_type idx = g * GROUP_WIDTH + utils::ctz64(m);
+          if (this->key_eq_(this->slots[idx].first, key)) return idx;
+        }
+        if (grp.match_empty()) return npos;
+        g = (g + ++step) & mask;
+      }
+      return npos;
+    }
+
+    /**
+     * @brief 沿探测序列找到第一个空槽或墓碑.
+     */
+    size_type find_free(uint32_t hash) const {
+      const size_type mask = this->capacity / GROUP_WIDTH - 1;
+      size_type g = first_group(hash, this->capacity);
+      for (size_type step = 0; ; ) {
+        uint32_t m = group(this->ctrl + g * GROUP_WIDTH).match_free();
+        if (m) return g * GROUP_WIDTH + utils::ctz64(m);
+        g = (g + ++step) & mask;
+      }
+    }
+
+    /**
+     * @brief 把所有元素移动到槽数为 new_capacity 的新数组，同时清除墓碑.
+     */
+    void rehash_to(size_type new_capacity) {
+      ctrl_t *old_ctrl = this->ctrl;
+      pair_type *old_slots = this->slots;
+      size_type old_capacity = this->capacity;
+
+      this->allocate(new_capacity);
+      for (size_type g = 0; g < old_capacity; g += GROUP_WIDTH) {
+        for (uint32_t m = group(old_ctrl + g).match_full(); m; m &= m - 1) {
+          pair_type *src = old_slots + g + utils::ctz64(m);
+          uint32_t hash = this->hash_key(src->first);
+          size_type idx = this->find_free(hash);
+          this->ctrl[idx] = h2_of(hash);
+          slot_traits::construct(this->slot_allocator, this->slots + idx, std::move(*src));
+          slot_traits::destroy(this->slot_allocator, src);
+        }
+      }
+      this->deleted = 0;
+
+      ctrl_traits::deallocate(this->ctrl_allocator, old_ctrl, old_capacity);
+      slot_traits::deallocate(this->slot_allocator, old_slots, old_capacity);
+    }
+
+    /**
+     * @brief 为一个新元素腾出位置：占用槽加墓碑达到上限时，墓碑多则原大小重建，否则加倍.
+     */
+    void reserve_one() {
+      if (this->size_ + this->deleted < this->growth_limit()) return;
+      if (this->size_ + 1 <= this->growth_limit() / 2) this->rehash_to(this->capacity);
+      else this->rehash_to(this->capacity * 2);
+    }
+
+    /**
+     * @brief 用 args 在空槽中就地构造哈希值为 hash 的新元素. 调用者须保证键不存在.
+     * @return 新元素所在的槽
+     */
+    template <typename... Args>
+    size_type construct_new(uint32_t hash, Args &&...args) {
+      this->reserve_one();
+      size_type idx = this->find_free(hash);
+      slot_traits::construct(this->slot_allocator, this->slots + idx, std::forward<Args>(args)...);
+      if (this->ctrl[idx] == _flat_table::CTRL_DELETED) this->deleted--;
+      this->ctrl[idx] = h2_of(hash);
+      this->size_++;
+      return idx;
+    }
+
+    /**
+     * @brief 键存在时更新值，否则插入.
+     */
+    template <typename K, typename V>
+    std::pair<iterator, bool> insert_impl(K &&key, V &&value) {
+      return this->insert_hashed(this->hash_key(key), std::forward<K>(key), std::forward<V>(value));
+    }
+
+    /**
+     * @brief insert_impl，键的哈希值 hash 已经算好.
+     */
+    template <typename K, typename V>
+    std::pair<iterator, bool> insert_hashed(uint32_t hash, K &&key, V &&value) {
+      size_type idx = this->find_index(key, hash);
+      if (idx != npos) {
+        this->slots[idx].second = std::forward<V>(value);
+        return std::make_pair(iterator(this, idx), false);
+      }
+      idx = this->construct_new(hash, std::forward<K>(key), std::forward<V>(value));
+      return std::make_pair(iterator(this, idx), true);
+    }
+
+    /**
+     * @brief 键不存在时用 args 就地构造值并插入，否则什么也不做.
+     */
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> try_emplace_impl(K &&key, Args &&...args) {
+      uint32_t hash = this->hash_key(key);
+      size_type idx = this->find_index(key, hash);
+      if (idx != npos) return std::make_pair(iterator(this, idx), false);
+      idx = this->construct_new(hash, std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+                                std::forward_as_tuple(std::forward<Args>(args)...));
+      return std::make_pair(iterator(this, idx), true);
+    }
+
+    /**
+     * @brief 分批处理 keys: 每批先算出所有键的哈希值并预取各自首个探测组的控制字节和槽，
+     *        再依次调用 resolve(i, hash)，使各个键的缓存未命中互相重叠.
+     */
+    template <typename K, typename Resolve>
+    void run_batch(const K *keys, size_type count, Resolve &&resolve) {
+      uint32_t hashes[BATCH_CHUNK];
+      for (size_type base = 0; base < count; base += BATCH_CHUNK) {
+        size_type n = count - base < BATCH_CHUNK ? count - base : BATCH_CHUNK;
+        for (size_type i = 0; i < n; i++) {
+          hashes[i] = this->hash_key(keys[base + i]);
+          size_type g = first_group(hashes[i], this->capacity) * GROUP_WIDTH;
+          utils::prefetch(this->ctrl + g);
+          utils::prefetch(this->slots + g);
+        }
+        for (size_type i = 0; i < n; i++) resolve(base + i, hashes[i]);
+      }
+    }
+
+    /**
+     * @brief 删除槽 idx 中的元素. 所在组里还有空槽时探测不会越过该组，可以直接置为空槽，否则留下墓碑.
+     */
+    void erase_index(size_type idx) {
+      slot_traits::destroy(this->slot_allocator, this->slots + idx);
+      if (group(this->ctrl + (idx & ~(GROUP_WIDTH - 1))).match_empty()) {
+        this->ctrl[idx] = _flat_table::CTRL_EMPTY;
+      } else {
+        this->ctrl[idx] = _flat_table::CTRL_DELETED;
+        this->deleted++;
+      }
+      this->size_--;
+    }
+
+    /**
+     * @brief 把槽数组划分为以组对齐的区间，在线程池中并行地对每个已占用槽调用 f(槽下标).
+     * @details 删除只修改所在组的控制字节，任务之间不共享组.
+     */
+    template <typename F>
+    void parallel_slots(utils::work_stealing_pool &pool, F &&f) {
+      pool.parallel_for(0, this->capacity, PARALLEL_GRAIN, [&](size_type first, size_type last) {
+        for (size_type g = first; g < last; g += GROUP_WIDTH) {
+          for (uint32_t m = group(this->ctrl + g).match_full(); m; m &= m - 1) f(g + utils::ctz64(m));
+        }
+      });
+    }
+
+    /**
+     * @brief 下标不小于 from 的第一个已占用槽，不存在时返回 capacity.
+     */
+    size_type next_full(size_type from) const {
+      size_type g = from & ~(GROUP_WIDTH - 1);
+      if (g >= this->capacity) return this->capacity;
+      uint32_t m = group(this->ctrl + g).match_full() & (0xFFFFu << (from - g));
+      while (!m) {
+        g += GROUP_WIDTH;
+        if (g >= this->capacity) return this->capacity;
+        m = group(this->ctrl + g).match_full();
+      }
+      return g + utils::ctz64(m);
+    }
+
+    /**
+     * @brief 下标小于 before 的最后一个已占用槽，不存在时返回 npos.
+     */
+    size_type prev_full(size_type before) const {
+      if (before == 0) return npos;
+      size_type last = before - 1;
+      size_type g = last & ~(GROUP_WIDTH - 1);
+      uint32_t m = group(this->ctrl + g).match_full() & (0xFFFFu >> (GROUP_WIDTH - 1 - (last - g)));
+      while (!m) {
+        if (g == 0) return npos;
+        g -= GROUP_WIDTH;
+        m = group(this->ctrl + g).match_full();
+      }
+      return g + 63 - utils::clz64(m);
+    }
+
+  public:
+    explicit flat_table(size_type estimated_size = 0, const hasher_type &hash = hasher_type(),
+                        const key_equal_type &equal = key_equal_type(), const Allocator &alloc = Allocator())
+      : hash_function_(hash), key_eq_(equal), allocator(alloc),
+        slot_allocator(alloc), ctrl_allocator(alloc) {
+      this->allocate(this->capacity_for(estimated_size));
+    }
+
+    template <typename InputIt>
+    flat_table(InputIt first, InputIt last, size_type estimated_size = 0) : flat_table(estimated_size) {
+      this->insert(first, last);
+    }
+
+    flat_table(std::initializer_list<pair_type> init, size_type estimated_size = 0)
+      : flat_table(estimated_size > init.size() ? estimated_size : init.size()) {
+      for (const auto &pair : init) this->insert(pair.first, pair.second);
+    }
+
+    flat_table(const flat_table &other)
+      : size_(other.size_), deleted(other.deleted), max_load_factor_(other.max_load_factor_),
+        hash_function_(other.hash_function_), key_eq_(other.key_eq_),
+        allocator(std::allocator_traits<Allocator>::select_on_container_copy_construction(other.allocator)),
+        slot_allocator(this->allocator), ctrl_allocator(this->allocator) {
+      this->allocate(other.capacity);
+      std::memcpy(this->ctrl, other.ctrl, other.capacity);
+      for (size_type g = 0; g < other.capacity; g += GROUP_WIDTH) {
+        for (uint32_t m = group(other.ctrl + g).match_full(); m; m &= m - 1) {
+          size_type idx = g + utils::ctz64(m);
+          slot_traits::construct(this->slot_allocator, this->slots + idx, other.slots[idx]);
+        }
+      }
+    }
+
+    flat_table(flat_table &&other) noexcept
+      : ctrl(other.ctrl), slots(other.slots), capacity(other.capacity),
+        size_(other.size_), deleted(other.deleted), max_load_factor_(other.max_load_factor_),
+        hash_function_(other.hash_function_), key_eq_(other.key_eq_), allocator(std::move(other.allocator)),
+        slot_allocator(std::move(other.slot_allocator)), ctrl_allocator(std::move(other.ctrl_allocator)) {
+      other.ctrl = nullptr;
+      other.slots = nullptr;
+      other.capacity = 0;
+      other.size_ = 0;
+      other.deleted = 0;
+      other.allocate(GROUP_WIDTH);
+    }
+
+    flat_table &operator=(const flat_table &other) {
+      if (this != &other) {
+        flat_table tmp(other);
+        *this = std::move(tmp);
+      }
+      return *this;
+    }
+
+    flat_table &operator=(flat_table &&other) noexcept(slot_traits::propagate_on_container_move_assignment::value ||
+                                                       slot_traits::is_always_equal::value) {
+      if constexpr (!slot_traits::propagate_on_container_move_assignment::value) {
+        // 分配器不随移动传播且不相等时，保留当前分配器并逐个复制元素，分配失败时抛出异常
+        if (this != &other && this->slot_allocator != other.slot_allocator) {
+          this->clear();
+          this->hash_function_ = other.hash_function_;
+          this->key_eq_ = other.key_eq_;
+          this->max_load_factor_ = other.max_load_factor_;
+          for (auto it = other.begin(); it != other.end(); ++it) this->insert(it->first, it->second);
+          other.clear();
+          return *this;
+        }
+      }
+      if (this != &other) {
+        this->release();
+        this->ctrl = other.ctrl;
+        this->slots = other.slots;
+        this->capacity = other.capacity;
+        this->size_ = other.size_;
+        this->deleted = other.deleted;
+        this->max_load_factor_ = other.max_load_factor_;
+        this->hash_function_ = other.hash_function_;
+        this->key_eq_ = other.key_eq_;
+        if constexpr (slot_traits::propagate_on_container_move_assignment::value) {
+          this->allocator = other.allocator;
+          this->slot_allocator = other.slot_allocator;
+          this->ctrl_allocator = other.ctrl_allocator;
+        }
+        other.ctrl = nullptr;
+        other.slots = nullptr;
+        other.capacity = 0;
+        other.size_ = 0;
+        other.deleted = 0;
+        other.allocate(GROUP_WIDTH);
+      }
+      return *this;
+    }
+
+    ~flat_table() { this->release(); }
+
+    /**
+     * @brief 插入元素，键已存在时更新值.
+     * @return pair<iterator, bool> 其中iterator指向元素，bool表示是否发生了插入
+     */
+    std::pair<iterator, bool> insert(const Key &key, const Value &value) {
+      return this->insert_impl(key, value);
+    }
+
+    std::pair<iterator, bool> insert(Key &&key, Value &&value) {
+      return this->insert_impl(std::move(key), std::move(value));
+    }
+
+    /**
+     * @brief 键不存在时用 args 就地构造值并插入，键已存在时不移动 key 和 args.
+     */
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key &key, Args &&...args) {
+      return this->try_emplace_impl(key, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(Key &&key, Args &&...args) {
+      return this->try_emplace_impl(std::move(key), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief 键存在时把 value 赋给它的值，否则插入.
+     */
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(const Key &key, M &&value) {
+      return this->insert_impl(key, std::forward<M>(value));
+    }
+
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(Key &&key, M &&value) {
+      return this->insert_impl(std::move(key), std::forward<M>(value));
+    }
+
+    /**
+     * @brief 插入一个范围内的元素，前向迭代器范围先按 std::distance 预留槽位.
+     */
+    template <typename InputIt>
+    void insert(InputIt first, InputIt last) {
+      if constexpr (std::is_base_of<std::forward_iterator_tag,
+                                    typename std::iterator_traits<InputIt>::iterator_category>::value)
+        this->reserve(this->size_ + static_cast<size_type>(std::distance(first, last)));
+      for (auto it = first; it != last; ++it) this->insert(it->first, it->second);
+    }
+
+    void insert(std::initializer_list<value_type> ilist) {
+      this->reserve(this->size_ + ilist.size());
+      for (const auto &pair : ilist) this->insert(pair.first, pair.second);
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args &&...args) {
+      pair_type pair(std::forward<Args>(args)...);
+      return this->insert_impl(std::move(pair.first), std::move(pair.second));
+    }
+
+    template <typename K = key_type>
+    iterator find(const key_arg<K> &key) {
+      return iterator(this, this->find_index_or_end(key));
+    }
+
+    template <typename K = key_type>
+    const_iterator find(const key_arg<K> &key) const {
+      return iterator(this, this->find_index_or_end(key));
+    }
+
+    template <typename K = key_type>
+    bool contains(const key_arg<K> &key) const {
+      return this->find_index(key, this->hash_key(key)) != npos;
+    }
+
+    template <typename K = key_type>
+    bool erase(const key_arg<K> &key) {
+      size_type idx = this->find_index(key, this->hash_key(key));
+      if (idx == npos) return false;
+      this->erase_index(idx);
+      return true;
+    }
+
+    /**
+     * @brief 通过迭代器删除元素.
+     * @return 指向下一个元素的迭代器. 删除不会移动其他元素，其余迭代器保持有效.
+     */
+    iterator erase(iterator it) {
+      if (it.table != this || it.index >= this->capacity) return this->end();
+      this->erase_index(it.index);
+      return iterator(this, this->next_full(it.index + 1));
+    }
+
+    iterator erase(iterator first, iterator last) {
+      while (first != last) first = this->erase(first);
+      return last;
+    }
+
+    /**
+     * @brief 批量查找: results[i] 为 keys[i] 的迭代器，不存在时为 end().
+     */
+    template <typename K = key_type>
+    void find_batch(const key_arg<K> *keys, size_type count, iterator *results) {
+      this->run_batch(keys, count, [&](size_type i, uint32_t hash) {
+        size_type idx = this->find_index(keys[i], hash);
+        results[i] = iterator(this, idx == npos ? this->capacity : idx);
+      });
+    }
+
+    /**
+     * @brief 批量插入 keys[i] -> values[i]，键已存在时更新值. inserted 非空时 inserted[i] 表示是否新插入.
+     */
+    void insert_batch(const Key *keys, const Value *values, size_type count, bool *inserted = nullptr) {
+      this->run_batch(keys, count, [&](size_type i, uint32_t hash) {
+        bool fresh = this->insert_hashed(hash, keys[i], values[i]).second;
+        if (inserted) inserted[i] = fresh;
+      });
+    }
+
+    /**
+     * @brief 批量删除. erased 非空时 erased[i] 表示 keys[i] 是否被删除.
+     * @return 删除的元素个数
+     */
+    template <typename K = key_type>
+    size_type erase_batch(const key_arg<K> *keys, size_type count, bool *erased = nullptr) {
+      size_type total = 0;
+      this->run_batch(keys, count, [&](size_type i, uint32_t hash) {
+        size_type idx = this->find_index(keys[i], hash);
+        if (idx != npos) {
+          this->erase_index(idx);
+          total++;
+        }
+        if (erased) erased[i] = idx != npos;
+      });
+      return total;
+    }
+
+    /**
+     * @brief 并行地对每个元素调用 f(value_type&). f 会被多个线程同时调用，调用期间不能访问本表.
+     */
+    template <typename F>
+    void parallel_for_each(F f, utils::work_stealing_pool &pool = utils::work_stealing_pool::shared()) {
+      this->parallel_slots(pool, [&](size_type idx) {
+        f(*reinterpret_cast<const_pair_type *>(this->slots + idx));
+      });
+    }
+
+    /**
+     * @brief 并行地统计使 pred(const value_type&) 为真的元素个数.
+     */
+    template <typename Pred>
+    size_type parallel_count_if(Pred pred, utils::work_stealing_pool &pool = utils::work_stealing_pool::shared()) const {
+      std::atomic<size_type> total{0};
+      pool.parallel_for(0, this->capacity, PARALLEL_GRAIN, [&](size_type first, size_type last) {
+        size_type local = 0;
+        for (size_type g = first; g < last; g += GROUP_WIDTH) {
+          for (uint32_t m = group(this->ctrl + g).match_full(); m; m &= m - 1) {
+            local += pred(*reinterpret_cast<const const_pair_type *>(this->slots + g + utils::ctz64(m))) ? 1 : 0;
+          }
+        }
+        total.fetch_add(local, std::memory_order_relaxed);
+      });
+      return total.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 并行地把每个元素的值替换为 f(const value_type&) 的返回值.
+     */
+    template <typename F>
+    void parallel_transform_values(F f, utils::work_stealing_pool &pool = utils::work_stealing_pool::shared()) {
+      this->parallel_slots(pool, [&](size_type idx) {
+        this->slots[idx].second = f(*reinterpret_cast<const const_pair_type *>(this->slots + idx));
+      });
+    }
+
+    /**
+     * @brief 并行地删除所有使 pred(const value_type&) 为真的元素. 元素数和墓碑数在任务结束时合并.
+     * @return 删除的元素个数
+     */
+    template <typename Pred>
+    size_type parallel_erase_if(Pred pred, utils::work_stealing_pool &pool = utils::work_stealing_pool::shared()) {
+      std::atomic<size_type> total{0};
+      std::atomic<size_type> tombstones{0};
+      pool.parallel_for(0, this->capacity, PARALLEL_GRAIN, [&](size_type first, size_type last) {
+        size_type local = 0;
+        size_type local_tombstones = 0;
+        for (size_type g = first; g < last; g += GROUP_WIDTH) {
+          for (uint32_t m = group(this->ctrl + g).match_full(); m; m &= m - 1) {
+            size_type idx = g + utils::ctz64(m);
+            if (!pred(*reinterpret_cast<const const_pair_type *>(this->slots + idx))) continue;
+            // 与 erase_index 相同，但计数留到最后合并
+            slot_traits::destroy(this->slot_allocator, this->slots + idx);
+            if (group(this->ctrl + g).match_empty()) {
+              this->ctrl[idx] = _flat_table::CTRL_EMPTY;
+            } else {
+              this->ctrl[idx] = _flat_table::CTRL_DELETED;
+              local_tombstones++;
+            }
+            local++;
+          }
+        }
+        total.fetch_add(local, std::memory_order_relaxed);
+        tombstones.fetch_add(local_tombstones, std::memory_order_relaxed);
+      });
+      this->size_ -= total.load(std::memory_order_relaxed);
+      this->deleted += tombstones.load(std::memory_order_relaxed);
+      return total.load(std::memory_order_relaxed);
+    }
+
+    mapped_type &operator[](const Key &key) {
+      // 先插入再取 slots: 插入可能重建数组
+      size_type idx = this->try_emplace_impl(key).first.index;
+      return this->slots[idx].second;
+    }
+
+    mapped_type &operator[](Key &&key) {
+      size_type idx = this->try_emplace_impl(std::move(key)).first.index;
+      return this->slots[idx].second;
+    }
+
+    template <typename K = key_type>
+    mapped_type &at(const key_arg<K> &key) {
+      size_type idx = this->find_index(key, this->hash_key(key));
+      if (idx == npos) throw std::out_of_range("HashMap::at: key not found");
+      return this->slots[idx].second;
+    }
+
+    template <typename K = key_type>
+    const mapped_type &at(const key_arg<K> &key) const {
+      size_type idx = this->find_index(key, this->hash_key(key));
+      if (idx == npos) throw std::out_of_range("HashMap::at: key not found");
+      return this->slots[idx].second;
+    }
+
+    size_type size() const { return this->size_; }
+    bool empty() const { return this->size_ == 0; }
+    size_type bucket_count() const { return this->capacity; }
+
+    double load_factor() const {
+      return static_cast<double>(this->size_) / this->capacity;
+    }
+
+    double max_load_factor() const { return this->max_load_factor_; }
+
+    /**
+     * @brief 设置最大负载因子，占用槽加墓碑超过新的上限时立即扩容.
+     * @throws std::invalid_argument 如果 ml 不在 (0, MAX_LOAD_FACTOR] 内，探测需要留出空槽
+     */
+    void max_load_factor(double ml) {
+      if (!(ml > 0.0 && ml <= MAX_LOAD_FACTOR))
+        throw std::invalid_argument("HashMap::max_load_factor: value must be in (0, 0.875]");
+      this->max_load_factor_ = ml;
+      if (this->size_ + this->deleted >= this->growth_limit()) {
+        size_type cap = this->capacity_for(this->size_);
+        this->rehash_to(cap > this->capacity ? cap : this->capacity);
+      }
+    }
+
+    iterator begin() { return iterator(this, this->next_full(0)); }
+    iterator end() { return iterator(this, this->capacity); }
+    const_iterator begin() const { return iterator(this, this->next_full(0)); }
+    const_iterator end() const { return iterator(this, this->capacity); }
+
+    /**
+     * @brief 清空所有元素，保持槽数不变.
+     */
+    void clear() {
+      this->destroy_all();
+      std::memset(this->ctrl, static_cast<unsigned char>(_flat_table::CTRL_EMPTY), this->capacity);
+      this->size_ = 0;
+      this->deleted = 0;
+    }
+
+    /**
+     * @brief 预留槽位，使元素总数达到 n 之前不再扩容. 发生重建时所有迭代器失效.
+     */
+    void reserve(size_type n) {
+      size_type cap = this->capacity_for(n);
+      if (cap > this->capacity) this->rehash_to(cap);
+    }
+
+    /**
+     * @brief 重建为至少 buckets 个槽、且能容纳 size() 个元素的槽数（2的幂），同时清除墓碑. 所有迭代器失效.
+     */
+    void rehash(size_type buckets) {
+      size_type cap = this->capacity_for(this->size_);
+      while (cap < buckets) cap <<= 1;
+      if (cap != this->capacity || this->deleted) this->rehash_to(cap);
+    }
+
+    /**
+     * @brief 原大小重建，清除所有墓碑. 所有迭代器失效.
+     */
+    void compact() {
+      if (this->deleted) this->rehash_to(this->capacity);
+    }
+
+    /**
+     * @brief 重建为能容纳 size() 个元素的最小槽数，同时清除墓碑. 所有迭代器失效.
+     */
+    void shrink_to_fit() {
+      size_type cap = this->capacity_for(this->size_);
+      if (cap < this->capacity || this->deleted) this->rehash_to(cap < this->capacity ? cap : this->capacity);
+    }
+
+    hasher_type hash_function() const { return this->hash_function_; }
+    key_equal_type key_eq() const { return this->key_eq_; }
+    allocator_type get_allocator() const { return this->allocator; }
+    size_type max_size() const { return std::numeric_limits<size_type>::max(); }
+
+    /**
+     * @brief 统计内存占用: 槽数组计入 bucket_arrays，控制字节计入 bitmaps.
+     */
+    utils::memory_report memory_usage() const {
+      utils::memory_report report;
+      report.exact = std::is_same<Allocator, std::allocator<value_type>>::value;
+      report.object = sizeof(*this);
+      report.bucket_arrays = this->capacity * sizeof(pair_type);
+      report.bitmaps = this->capacity * sizeof(ctrl_t);
+      report.finish(this->size_);
+      return report;
+    }
+
+    void debug() const {
+      std::cout << "HashMap调试信息 (平坦表):\n";
+      std::cout << "  大小: " << this->size_ << "\n";
+      std::cout << "  槽数: " << this->capacity << "\n";
+      std::cout << "  墓碑数: " << this->deleted << "\n";
+      std::cout << "  负载因子: " << this->load_factor() << "\n";
+    }
+
+  private:
+    template <typename K>
+    size_type find_index_or_end(const K &key) const {
+      size_type idx = this->find_index(key, this->hash_key(key));
+      return idx == npos ? this->capacity : idx;
+    }
+};
+
+} // namespace utils
+
+#endif  // HASHMAP_UTILS_FLAT_TABLE_HPP
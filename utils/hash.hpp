@@ -0,0 +1,153 @@
+/**
+ * @file hash.hpp
+ * @brief 基于 XXHash32 的默认哈希函数对象.
+ */
+#ifndef HASHMAP_UTILS_HASH_HPP
+#define HASHMAP_UTILS_HASH_HPP
+
+#include "xxhash32.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace utils {
+
+/**
+ * @brief 判断哈希函数对象的输出是否已经充分混合.
+ * @details 哈希函数对象中声明了 is_avalanching 类型成员时为 true.
+ *          HashMap 会对不满足此条件的哈希函数(例如对整数是恒等映射的 std::hash)的结果再做一次 XXHash32 混合,
+ *          否则线性映射只使用哈希值高位，会把相近的键集中到少数几个桶里.
+ */
+template <typename Hash, typename = void>
+struct is_avalanching : std::false_type {};
+
+template <typename Hash>
+struct is_avalanching<Hash, std::void_t<typename Hash::is_avalanching> > : std::true_type {};
+
+/**
+ * @brief 判断函数对象是否支持异构查找.
+ * @details 函数对象中声明了 is_transparent 类型成员时为 true. 哈希器和键相等比较器都满足此条件时,
+ *          HashMap 的 find/contains/at/erase 接受任何可以与 Key 比较的类型，不再构造临时的 Key.
+ */
+template <typename T, typename = void>
+struct is_transparent : std::false_type {};
+
+template <typename T>
+struct is_transparent<T, std::void_t<typename T::is_transparent> > : std::true_type {};
+
+/**
+ * @brief 查找参数类型: 支持异构查找时为 K 本身，否则为 Key.
+ * @details 以 key_arg_impl<...>::type<K, Key> 的形式使用时 K 可以被推导.
+ */
+template <bool Transparent>
+struct key_arg_impl {
+  template <typename K, typename Key>
+  using type = Key;
+};
+
+template <>
+struct key_arg_impl<true> {
+  template <typename K, typename Key>
+  using type = K;
+};
+
+/**
+ * @brief 以 seed 为种子把哈希值 value 合并进去.
+ */
+inline uint32_t hash_combine(uint32_t seed, uint32_t value) noexcept {
+  return XXHash32::hash_raw(&value, sizeof(value), seed);
+}
+
+/**
+ * @brief 默认哈希函数对象，返回32位 XXHash32 哈希值.
+ * @details
+ *   - 没有填充位的类型(整数、枚举、指针等): 哈希对象本身的字节.
+ *   - float / double: 先把 -0.0 规整为 0.0，再哈希字节.
+ *   - 其他类型: 对 std::hash<T> 的结果再做一次 XXHash32 混合.
+ *   字符串、std::pair、std::tuple 见下方的特化.
+ * @tparam T 键类型
+ */
+template <typename T>
+struct hash {
+  using is_avalanching = void;
+
+  uint32_t operator()(const T &value) const {
+    if constexpr (std::has_unique_object_representations_v<T>) {
+      return XXHash32::hash_raw(&value, sizeof(T));
+    } else if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+      T normalized = value == T(0) ? T(0) : value;
+      return XXHash32::hash_raw(&normalized, sizeof(T));
+    } else {
+      std::size_t h = std::hash<T>{}(value);
+      return XXHash32::hash_raw(&h, sizeof(h));
+    }
+  }
+};
+
+/**
+ * @brief 字符串: 哈希字符内容而不是 std::basic_string 对象本身的字节.
+ * @details 接受任何能转换为 std::basic_string_view 的参数(字符串视图、C 字符串)，同内容时哈希值相同，支持异构查找.
+ */
+template <typename CharT, typename Traits, typename Alloc>
+struct hash<std::basic_string<CharT, Traits, Alloc> > {
+  using is_avalanching = void;
+  using is_transparent = void;
+
+  uint32_t operator()(std::basic_string_view<CharT, Traits> str) const {
+    return XXHash32::hash_raw(str.data(), str.size() * sizeof(CharT));
+  }
+};
+
+/**
+ * @brief 字符串视图: 与同内容的 std::basic_string 哈希值相同.
+ */
+template <typename CharT, typename Traits>
+struct hash<std::basic_string_view<CharT, Traits> > {
+  using is_avalanching = void;
+  using is_transparent = void;
+
+  uint32_t operator()(std::basic_string_view<CharT, Traits> str) const {
+    return XXHash32::hash_raw(str.data(), str.size() * sizeof(CharT));
+  }
+};
+
+/**
+ * @brief std::pair: 以 first 的哈希值为种子合并 second 的哈希值.
+ */
+template <typename T1, typename T2>
+struct hash<std::pair<T1, T2> > {
+  using is_avalanching = void;
+
+  uint32_t operator()(const std::pair<T1, T2> &pair) const {
+    return hash_combine(hash<T1>{}(pair.first), hash<T2>{}(pair.second));
+  }
+};
+
+/**
+ * @brief std::tuple: 依次以前面成员的合并结果为种子合并每个成员的哈希值.
+ */
+template <typename... Ts>
+struct hash<std::tuple<Ts...> > {
+  using is_avalanching = void;
+
+  uint32_t operator()(const std::tuple<Ts...> &tuple) const {
+    return this->combine(tuple, std::index_sequence_for<Ts...>{});
+  }
+
+  private:
+    template <std::size_t... I>
+    static uint32_t combine(const std::tuple<Ts...> &tuple, std::index_sequence<I...>) {
+      uint32_t seed = XXHash32::hash_raw(nullptr, 0);
+      ((seed = hash_combine(seed, hash<std::tuple_element_t<I, std::tuple<Ts...> > >{}(std::get<I>(tuple)))), ...);
+      return seed;
+    }
+};
+
+} // namespace utils
+
+#endif  // HASHMAP_UTILS_HASH_HPP
@@ -30,13 +30,13 @@ class list {
           this->self = self;
         }
 
-        void goback() override {
+        void goback() {
         }
-        void goback(size_t n) override {
+        void goback(size_t n) {
         }
-        void gofront() override {
+        void gofront() {
         }
-        void gofront(size_t n) override {
+        void gofront(size_t n) {
         }
     };
 
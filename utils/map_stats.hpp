@@ -0,0 +1,104 @@
+#ifndef HASHMAP_UTILS_MAP_STATS_HPP
+#define HASHMAP_UTILS_MAP_STATS_HPP
+
+
+#include "__def.hpp"
+
+#include <vector>
+
+
+namespace utils {
+
+/**
+ * @brief 哈希表的结构统计快照，由 HashMap::stats() 生成.
+ * @details 箱子一级的信息(boxes)总是精确的; 桶一级的信息(直方图、访问箱子数、热点桶)来自扫描到的桶下标，
+ *          抽样时只覆盖 scanned_positions / total_positions 的桶下标，各计数不按比例放大.
+ *          查找时按占用目录依次访问 box[keyhash] 非空的箱子: 命中时访问到元素所在的箱子为止，
+ *          未命中时访问该桶下标上所有非空的箱子(合并期间还包括尚未迁移的旧桶).
+ */
+struct map_stats {
+  struct box_info {
+    unsigned long long capacity = 0;        // 桶数
+    unsigned long long used_buckets = 0;    // 非空桶数
+    double occupancy = 0;                   // used_buckets / capacity
+    bool old = false;                       // 是否为渐进式合并中的旧箱
+  };
+
+  struct hot_bucket {
+    unsigned long long box = 0;             // 箱子在 boxes 中的下标
+    unsigned long long bucket = 0;          // 箱内的桶下标
+    unsigned long long size = 0;            // 元素数
+    unsigned long long height = 0;          // 红黑树形式的树高，其他形式为 0
+  };
+
+  unsigned long long size = 0;              // 元素数
+  unsigned long long bucket_count = 0;      // 每个主箱的桶数
+  double element_load = 0;                  // 元素数 / 所有主箱的桶数之和
+  bool migrating = false;                   // 是否正在渐进式合并
+  unsigned long long migrated_buckets = 0;  // 已迁移的旧桶下标数
+  std::vector<box_info> boxes;              // 主箱在前，旧箱在后
+
+  unsigned long long total_positions = 0;   // 主箱的桶下标数
+  unsigned long long scanned_positions = 0; // 扫描的主箱桶下标数
+  unsigned long long scanned_buckets = 0;   // 扫描到的非空桶数，含旧箱
+  unsigned long long scanned_elements = 0;  // 扫描到的元素数
+  std::vector<unsigned long long> size_histogram;    // [k]: 元素数在 [2^k, 2^(k+1)) 内的非空桶数
+  std::vector<unsigned long long> height_histogram;  // [h]: 树高为 h 的红黑树桶数
+  double avg_boxes_per_hit = 0;             // 命中时平均访问的箱子数，按元素平均
+  double avg_boxes_per_miss = 0;            // 未命中时平均访问的箱子数，按桶下标平均
+  unsigned long long max_boxes_per_lookup = 0;  // 单次查找最多访问的箱子数
+  std::vector<hot_bucket> hot_buckets;      // 元素最多的桶，按元素数降序
+  unsigned long long hot_limit = 8;         // hot_buckets 的最大长度
+
+  unsigned long long hit_boxes = 0;         // 扫描到的元素命中时访问的箱子数之和
+  unsigned long long miss_boxes = 0;        // 扫描的桶下标未命中时访问的箱子数之和
+
+  /**
+   * @brief 记录一个非空桶.
+   */
+  void add_bucket(unsigned long long box, unsigned long long bucket, unsigned long long size, unsigned long long height) {
+    this->scanned_buckets++;
+    this->scanned_elements += size;
+
+    unsigned long long bin = 0;
+    while ((size >> bin) > 1) bin++;
+    if (this->size_histogram.size() <= bin) this->size_histogram.resize(bin + 1, 0);
+    this->size_histogram[bin]++;
+    if (height) {
+      if (this->height_histogram.size() <= height) this->height_histogram.resize(height + 1, 0);
+      this->height_histogram[height]++;
+    }
+
+    // 按元素数降序插入，只保留前 hot_limit 个
+    if (this->hot_buckets.size() == this->hot_limit && (!this->hot_limit || this->hot_buckets.back().size >= size)) return;
+    auto pos = this->hot_buckets.begin();
+    while (pos != this->hot_buckets.end() && pos->size >= size) ++pos;
+    this->hot_buckets.insert(pos, hot_bucket{box, bucket, size, height});
+    if (this->hot_buckets.size() > this->hot_limit) this->hot_buckets.pop_back();
+  }
+
+  /**
+   * @brief 记录一个桶下标上未命中时访问的箱子数.
+   */
+  void add_position(unsigned long long miss_cost) {
+    this->scanned_positions++;
+    this->miss_boxes += miss_cost;
+    if (miss_cost > this->max_boxes_per_lookup) this->max_boxes_per_lookup = miss_cost;
+  }
+
+  /**
+   * @brief 由累加器计算平均值.
+   */
+  void finish() {
+    this->avg_boxes_per_hit = this->scanned_elements
+                            ? static_cast<double>(this->hit_boxes) / this->scanned_elements : 0.0;
+    this->avg_boxes_per_miss = this->scanned_positions
+                             ? static_cast<double>(this->miss_boxes) / this->scanned_positions : 0.0;
+  }
+};
+
+
+} // namespace utils
+
+
+#endif  // HASHMAP_UTILS_MAP_STATS_HPP
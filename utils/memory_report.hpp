@@ -0,0 +1,43 @@
+#ifndef HASHMAP_UTILS_MEMORY_REPORT_HPP
+#define HASHMAP_UTILS_MEMORY_REPORT_HPP
+
+
+#include "__def.hpp"
+
+
+namespace utils {
+
+/**
+ * @brief 哈希表的内存占用报告，由 HashMap::memory_usage() 生成.
+ * @details 各项为向分配器申请的字节数，不含 malloc 等底层分配器自身的簿记和对齐开销.
+ *          分配器为 std::allocator 时各项是精确值(exact 为 true); 其他分配器可能按块、按页取整，
+ *          此时各项为估计值. 平坦表只有 object、bucket_arrays(槽数组)和 bitmaps(控制字节)三项.
+ */
+struct memory_report {
+  unsigned long long total = 0;             // object 到 box_list 各项之和(comparators 已含在 bucket_arrays 中)
+  unsigned long long object = 0;            // 表对象本身
+  unsigned long long bucket_arrays = 0;     // 各箱的桶数组(std::vector<bucket_type> 的容量)，内联元素在其中
+  unsigned long long comparators = 0;       // 其中每个桶对象内嵌的比较器，已计入 bucket_arrays
+  unsigned long long bitmaps = 0;           // 各箱的非空桶位图
+  unsigned long long directory = 0;         // 主箱和旧箱的跨箱占用目录及箱子的随机访问索引
+  unsigned long long small_arrays = 0;      // 小有序数组形式的桶在桶外分配的数组
+  unsigned long long tree_nodes = 0;        // 红黑树对象及其节点
+  unsigned long long box_list = 0;          // 箱链表的节点
+  double bytes_per_element = 0;             // total / 元素数，空表为 0
+  bool exact = false;                       // 各项是否为精确值
+
+  /**
+   * @brief 汇总 total 和 bytes_per_element.
+   */
+  void finish(unsigned long long element_count) {
+    this->total = this->object + this->bucket_arrays + this->bitmaps + this->directory +
+                  this->small_arrays + this->tree_nodes + this->box_list;
+    this->bytes_per_element = element_count ? static_cast<double>(this->total) / element_count : 0.0;
+  }
+};
+
+
+} // namespace utils
+
+
+#endif  // HASHMAP_UTILS_MEMORY_REPORT_HPP
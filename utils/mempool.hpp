@@ -4,13 +4,21 @@
 
 #include "__errs.hpp"
 #include "__def.hpp"
-#include "bitmap.hpp"
-#include "queue.hpp"
 
-#include <thread>
-#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
 
 
+namespace _utils_constants {
+
+static const size_t MEMPOOL_BATCH_SIZE = 64;          // 线程缓存与共享池之间一次交换的块数
+static const size_t MEMPOOL_SLAB_BYTES = 64 * 1024;   // 每次向系统申请的内存块大小
+
+}
+
 namespace utils {
 
 template <typename T>
@@ -23,223 +31,203 @@ class _abs_allocator {
     virtual void deallocate(T *p, size_t n) = 0;
 };
 
-/*
-mempool_allocator:
-  初始时是一大块内存区域.
-  定义
-    内存状态图      memory_state_map
-    待分配指针队列  allocating_queue
-    待释放指针队列  deallocating_queue
-
-  分配
-    取待分配指针队列前端的指针分配给外部.
-    发送信号给守护线程，信号包括分配操作信号和被分配指针.
-
-    详细过程
-      检查
-
-  释放
-    将待释放指针放入待释放指针队列队尾.
-    发送信号给守护线程，信号包括释放操作信号.
-
-
-  守护线程
-    会根据若干信号工作.
-    信号
-      tran_signal_for_daemon (bool)
-        守护线程的超越信号，用于指示守护线程发出的新信号的出现.
-        静息状态为 false.
-        由守护线程触发为动作状态，主线程收到后重置为静息状态.
-    &
-      tran_signal_for_main (bool)
-        主线程的超越信号，用于指示主线程发出的新信号的出现.
-        静息状态为 false.
-        由主线程触发为动作状态，守护线程收到后重置为静息状态.
-      -----------------
-      type_signal_for_daemon (unsigned char)
-        信号类型信号，用于指示守护线程发出的信号的类型.
-    &
-      type_signal_for_main (unsigned char)
-        信号类型信号，用于指示主线程发出的信号的类型.
-
-        信号类型表
-          0x01 - 
-
-  发送信号的流程
-    (1) 脉冲信号 A --S(X)--> B
-      线程A
-        S <- X;
-        type_signal_for_A <- typeid(S);
-        tran_signal_for_A <- true;
-
-      线程B
-        if tran_signal_for_A:
-          signal_type <- type_signal_for_A;
-          rcp_S <- S;
-
-          tran_signal_for_A <- false;
-          type_signal_for_A <- 0;
-          S <- 0;
-    (2) 状态信号 A --X--> S
-*/
-
-template <typename T>
-class mempool_allocator : public _abs_allocator<T> {
-  protected:
-    bitmap<>          memory_state_map;
-    static_deque<T*>  allocating_queue;
-    static_deque<T*>  deallocating_queue;
-
-    std::atomic<bool> tran_signal_for_daemon {false};
-    std::atomic<bool> tran_signal_for_main {false};
-
-    std::atomic<unsigned char> type_signal_for_daemon {0};
-    std::atomic<unsigned char> type_signal_for_main {0};
-
-    std::atomic<bool> 
-
-    std::atomic<unsigned char> operation_signal;
-    std::atomic<T *> ptr_signal;
-
-  protected:
-    // 守护线程
-    static void daemon() {
-      
-    }
-
-  public:
-    mempool_allocator() {
-      std::thread(mempool_allocator::daemon).detach();
-    }
+namespace _mempool {
+
+  // 空闲块的前几个字节用来存放指向下一个空闲块的指针
+  struct free_block {
+    free_block *next;
+  };
+
+  /**
+   * @brief 一批空闲块组成的单链表.
+   */
+  struct batch {
+    free_block *head = nullptr;
+    size_t count = 0;
+  };
+
+  /**
+   * @brief 某一块大小的所有线程共享的池.
+   * @details 保存整批的空闲块，以及从系统申请的所有 slab. slab 在进程结束前不会归还给系统.
+   */
+  template <size_t BlockSize, size_t Align>
+  class shared_pool {
+    protected:
+      std::mutex mutex;
+      std::vector<batch> batches;   // 空闲批
+      std::vector<void *> slabs;    // 已申请的 slab
+
+      static constexpr size_t BATCH_BYTES  = BlockSize * _utils_constants::MEMPOOL_BATCH_SIZE;
+      static constexpr size_t SLAB_BATCHES = _utils_constants::MEMPOOL_SLAB_BYTES > BATCH_BYTES
+                                           ? _utils_constants::MEMPOOL_SLAB_BYTES / BATCH_BYTES : 1;
+      static constexpr size_t SLAB_BLOCKS  = SLAB_BATCHES * _utils_constants::MEMPOOL_BATCH_SIZE;
+
+      /**
+       * @brief 申请一个新的 slab，切成若干批，返回其中一批，其余放入 batches. 须持有锁.
+       */
+      batch carve_slab() {
+        char *slab = static_cast<char *>(::operator new(SLAB_BLOCKS * BlockSize, std::align_val_t(Align)));
+        this->slabs.push_back(slab);
+
+        batch first;
+        for (size_t b = 0; b < SLAB_BLOCKS; b += _utils_constants::MEMPOOL_BATCH_SIZE) {
+          batch cur;
+          for (size_t i = _utils_constants::MEMPOOL_BATCH_SIZE; i-- > 0; ) {
+            free_block *block = reinterpret_cast<free_block *>(slab + (b + i) * BlockSize);
+            block->next = cur.head;
+            cur.head = block;
+          }
+          cur.count = _utils_constants::MEMPOOL_BATCH_SIZE;
+          if (b == 0) first = cur;
+          else this->batches.push_back(cur);
+        }
+        return first;
+      }
 
-    T* allocate(size_t n) override {
-      if (this->allocating_queue.empty()) {
-        // 等待守护线程寻找空闲内存
-        for (;;) if (this->tran_signal_for_daemon) break;
-        switch (this->type_signal_for_daemon)
-      } else {
-        return this->allocating_queue.top();
-        // 给守护线程发信号
+    public:
+      /**
+       * @brief 取一批空闲块，没有时切分新的 slab.
+       */
+      batch acquire() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (this->batches.empty()) return this->carve_slab();
+        batch b = this->batches.back();
+        this->batches.pop_back();
+        return b;
       }
-    }
 
-    void deallocate(T *p, size_t n) {
-      // 给守护线程发信号
-    }
-};
+      /**
+       * @brief 归还一批空闲块.
+       */
+      void release(batch b) {
+        if (!b.head) return;
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->batches.push_back(b);
+      }
 
+      /**
+       * @brief 唯一实例. 有意不析构，保证其他线程退出时归还缓存仍然安全.
+       */
+      static shared_pool &instance() {
+        static shared_pool *pool = new shared_pool();
+        return *pool;
+      }
+  };
+
+  /**
+   * @brief 某一块大小的线程缓存.
+   * @details 分配和释放只操作本线程的空闲链表，不加锁.
+   *          链表为空时从共享池取一批；超过两批时把一批还给共享池；线程退出时全部归还.
+   */
+  template <size_t BlockSize, size_t Align>
+  class thread_cache {
+    protected:
+      free_block *head = nullptr;
+      size_t count = 0;
+
+      using pool_type = shared_pool<BlockSize, Align>;
+
+      void refill() {
+        batch b = pool_type::instance().acquire();
+        this->head = b.head;
+        this->count = b.count;
+      }
 
+      /**
+       * @brief 从链表头部摘下 n 个块还给共享池.
+       */
+      void flush(size_t n) {
+        batch b;
+        b.head = this->head;
+        free_block *tail = this->head;
+        for (size_t i = 1; i < n; i++) tail = tail->next;
+        this->head = tail->next;
+        tail->next = nullptr;
+        b.count = n;
+        this->count -= n;
+        pool_type::instance().release(b);
+      }
 
+    public:
+      ~thread_cache() {
+        if (this->count) this->flush(this->count);
+      }
 
-/*
+      void *allocate() {
+        if (!this->head) this->refill();
+        free_block *block = this->head;
+        this->head = block->next;
+        this->count--;
+        return block;
+      }
 
+      void deallocate(void *p) {
+        free_block *block = static_cast<free_block *>(p);
+        block->next = this->head;
+        this->head = block;
+        if (++this->count >= 2 * _utils_constants::MEMPOOL_BATCH_SIZE)
+          this->flush(_utils_constants::MEMPOOL_BATCH_SIZE);
+      }
 
+      static thread_cache &local() {
+        static thread_local thread_cache cache;
+        return cache;
+      }
+  };
+
+} // namespace _mempool
+
+/**
+ * @brief 按线程缓存的定长块内存池分配器.
+ * @details 单个对象(n == 1)的分配从固定大小的块中取得:
+ *   - 每个线程有自己的空闲链表，分配和释放不加锁;
+ *   - 线程的空闲链表为空时，从所有线程共享的池中整批(MEMPOOL_BATCH_SIZE 块)取得;
+ *     空闲块积累到两批时还给共享池一批，线程退出时全部归还;
+ *   - 共享池没有空闲批时向系统申请一个 slab 并切分，slab 不会归还给系统.
+ *   一个线程分配的块可以由另一个线程释放. n != 1 的分配直接使用 ::operator new.
+ *   分配器没有状态，所有实例都相等，适合作为 utils::rbtree 等节点式容器的分配器.
+ * @tparam T 元素类型
+ */
 template <typename T>
-class unique_pool {
-  protected:
-    T *membegin = nullptr;
-    T *memend = nullptr;
-    T *availptr = nullptr;
-    T *tailptr = nullptr;
-    T *last_availptr = nullptr;
+class mempool_allocator {
+  public:
+    using value_type                             = T;
+    using size_type                              = size_t;
+    using difference_type                        = std::ptrdiff_t;
+    using propagate_on_container_move_assignment = std::true_type;
+    using is_always_equal                        = std::true_type;
 
-    size_t blk_piece_count = 1024 * 4;   // 默认: 4096
-    size_t used_count = 0;
-    size_t avail_count = 0;
-    std::thread search_thread;
+  protected:
+    static constexpr size_t ALIGN = alignof(T) > alignof(_mempool::free_block)
+                                  ? alignof(T) : alignof(_mempool::free_block);
+    static constexpr size_t BLOCK_SIZE = ((sizeof(T) > sizeof(_mempool::free_block)
+                                        ? sizeof(T) : sizeof(_mempool::free_block)) + ALIGN - 1) & ~(ALIGN - 1);
 
-    bitmap<> blkmap {0b1111'1111};
+    using cache_type = _mempool::thread_cache<BLOCK_SIZE, ALIGN>;
 
   public:
-    unique_pool(bool is_init = true) {
-      if (is_init)
-        this->init();
-    }
+    mempool_allocator() noexcept = default;
 
-    unique_pool(size_t n, bool is_init = true) : blk_piece_count(n) {
-      if (is_init)
-        this->init();
-    }
+    template <typename U>
+    mempool_allocator(const mempool_allocator<U> &) noexcept {}
 
-    ~unique_pool() {
-      delete[] static_cast<T *>(this->membegin);
+    T* allocate(size_t n) {
+      if (n == 1) return static_cast<T *>(cache_type::local().allocate());
+      return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
     }
 
-    void init() {
-      this->blkmap.init(this->blk_piece_count);
-      try {
-        this->membegin = new T[this->blk_piece_count];
-        this->memend = this->membegin + this->blk_piece_count;
-        this->tailptr = this->membegin;
-        this->availptr = this->membegin;
-        this->last_availptr = this->availptr;
-      } catch (std::bad_alloc &e) {
-        throw utils_exception("unique_pool::init(): Too huge memory wanted!");
-      }
-
-      this->avail_count = this->blk_piece_count;
-
-      auto search_loop = [this]() -> void {
-        for (;;) {
-          if (!this->availptr) {
-            for (size_t byte_offset = this->last_availptr - this->membegin;
-                byte_offset < this->blk_piece_count; byte_offset++) {
-              if (this->blkmap.bits[byte_offset]) {
-                size_t bit_offset = 0;
-                for (size_t bit_offset = 0; bit_offset < 8; bit_offset++) {
-                  if (
-                      (static_cast<unsigned char>(0b0000'0001) << bit_offset)
-                      & this->blkmap.bits[byte_offset]) {
-                    this->availptr = this->membegin + (byte_offset * sizeof(unsigned char)) + bit_offset;
-                  }
-                }
-              }
-            }
-          }
-        }
-      };
-
-      this->search_thread = std::thread(search_loop);
-      search_thread.detach();
+    void deallocate(T *p, size_t n) {
+      if (!p) return;
+      if (n == 1) cache_type::local().deallocate(p);
+      else ::operator delete(p, std::align_val_t(alignof(T)));
     }
 
-    template <typename ...Args>
-    T* allocate(Args ...args) {
-      T* ptr = nullptr;
-      for (;;) {
-        if (this->availptr) {
-          this->last_availptr = this->availptr;
-          ptr = this->availptr;
-          this->availptr = nullptr;
-          break;
-        }
-      }
-
-      this->blkmap.set(static_cast<size_t>(ptr - this->membegin), false);
+    template <typename U>
+    bool operator==(const mempool_allocator<U> &) const noexcept { return true; }
 
-      if constexpr (std::is_fundamental_v<T>) {
-        *ptr = {args...};
-      } else {
-        if (!sizeof...(args))
-          ptr->T();
-        else 
-          ptr->T(std::forward(args...));
-      }
-
-      return ptr;
-    }
-
-    void deallocate(T *p) {
-      for (;;) {
-        if (this->availptr) {
-          this->blkmap.set(static_cast<size_t>(p - this->membegin), true);
-          if (p < this->availptr)
-            this->availptr = p;
-        }
-      }
-    }
+    template <typename U>
+    bool operator!=(const mempool_allocator<U> &) const noexcept { return false; }
 };
-*/
 
 } // namespace utils
 
@@ -0,0 +1,215 @@
+#ifndef HASHMAP_UTILS_QSBR_HPP
+#define HASHMAP_UTILS_QSBR_HPP
+
+
+#include "__def.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <vector>
+
+
+namespace _utils_constants {
+
+static const size_t QSBR_RECLAIM_BATCH = 64;          // 积累多少个待回收对象后尝试回收一次
+
+}
+
+namespace utils {
+
+/**
+ * @brief 基于静止状态的内存回收(QSBR).
+ * @details 读者不加锁、不写共享数据地读取写者发布的对象；写者替换对象后调用 retire，
+ *          旧对象要等到所有读者都经过一次静止状态(quiescent)后才被释放.
+ *
+ *   - 全局纪元 global_epoch 只由写者推进: 每次 retire 把对象标记为当前纪元 e 并把全局纪元加一;
+ *   - 每个读者有自己的槽(独占一条缓存行)，在两次读取之间调用 quiescent()，把槽更新为当前全局纪元，
+ *     表示它不再持有之前读到的任何指针; 长时间不读取的读者可以 offline()，不再阻塞回收;
+ *   - 所有在线读者的槽都大于 e 时，纪元 e 退休的对象不可能再被读到，可以释放.
+ *
+ *   读者不调用 quiescent() 时退休的对象会一直积累，因此读者应在每个请求、每轮循环之后调用它.
+ */
+class qsbr_domain {
+  public:
+    using deleter_type = void (*)(void *context, void *object);
+
+  protected:
+    static constexpr uint64_t OFFLINE = ~static_cast<uint64_t>(0);
+
+    struct alignas(64) reader_slot {
+      std::atomic<uint64_t> epoch;
+    };
+
+    struct retired {
+      uint64_t epoch;
+      void *object;
+      deleter_type deleter;
+      void *context;
+    };
+
+    std::atomic<uint64_t> global_epoch{1};
+    std::mutex mutex;                         // 保护 readers 和 retired_list
+    std::list<reader_slot> readers;           // 槽的地址在注销前保持不变
+    std::vector<retired> retired_list;
+
+    /**
+     * @brief 所有在线读者中最小的纪元. 须持有锁.
+     */
+    uint64_t min_reader_epoch() const {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      uint64_t min_epoch = OFFLINE;
+      for (const reader_slot &slot : this->readers) {
+        uint64_t epoch = slot.epoch.load(std::memory_order_acquire);
+        if (epoch < min_epoch) min_epoch = epoch;
+      }
+      return min_epoch;
+    }
+
+    /**
+     * @brief 释放所有读者都已越过其纪元的对象. 须持有锁.
+     */
+    void reclaim_locked() {
+      uint64_t safe = this->min_reader_epoch();
+      size_t kept = 0;
+      for (size_t i = 0; i < this->retired_list.size(); i++) {
+        retired &r = this->retired_list[i];
+        if (r.epoch < safe) r.deleter(r.context, r.object);
+        else this->retired_list[kept++] = r;
+      }
+      this->retired_list.resize(kept);
+    }
+
+  public:
+    /**
+     * @brief 读者句柄，只能由一个线程使用. 析构时注销.
+     */
+    class reader {
+      friend class qsbr_domain;
+
+      protected:
+        qsbr_domain *domain = nullptr;
+        reader_slot *slot = nullptr;
+
+        reader(qsbr_domain *domain, reader_slot *slot) : domain(domain), slot(slot) {}
+
+      public:
+        reader() = default;
+        reader(const reader &) = delete;
+        reader &operator=(const reader &) = delete;
+
+        reader(reader &&other) noexcept : domain(other.domain), slot(other.slot) {
+          other.domain = nullptr;
+          other.slot = nullptr;
+        }
+
+        reader &operator=(reader &&other) noexcept {
+          if (this != &other) {
+            this->release();
+            this->domain = other.domain;
+            this->slot = other.slot;
+            other.domain = nullptr;
+            other.slot = nullptr;
+          }
+          return *this;
+        }
+
+        ~reader() { this->release(); }
+
+        /**
+         * @brief 声明静止状态: 之前读到的指针都不再使用.
+         */
+        void quiescent() noexcept {
+          this->slot->epoch.store(this->domain->global_epoch.load(std::memory_order_acquire),
+                                  std::memory_order_release);
+        }
+
+        /**
+         * @brief 暂时不再读取，不阻塞回收. 再次读取前须调用 online().
+         */
+        void offline() noexcept {
+          this->slot->epoch.store(OFFLINE, std::memory_order_release);
+        }
+
+        void online() noexcept {
+          this->slot->epoch.store(this->domain->global_epoch.load(std::memory_order_acquire),
+                                  std::memory_order_relaxed);
+          // 与 reclaim_locked 中的栅栏配对: 写者要么看到本槽已在线，要么本线程之后读到的都是新发布的指针
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+
+        void release() {
+          if (!this->domain) return;
+          std::lock_guard<std::mutex> lock(this->domain->mutex);
+          for (auto it = this->domain->readers.begin(); it != this->domain->readers.end(); ++it) {
+            if (&*it == this->slot) {
+              this->domain->readers.erase(it);
+              break;
+            }
+          }
+          this->domain = nullptr;
+          this->slot = nullptr;
+        }
+    };
+
+    qsbr_domain() = default;
+    qsbr_domain(const qsbr_domain &) = delete;
+    qsbr_domain &operator=(const qsbr_domain &) = delete;
+
+    /**
+     * @brief 析构时释放所有待回收对象，此时不能再有读者.
+     */
+    ~qsbr_domain() { this->drain(); }
+
+    /**
+     * @brief 注册当前线程为读者，初始为在线.
+     */
+    reader register_reader() {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->readers.emplace_back();
+      reader_slot *slot = &this->readers.back();
+      slot->epoch.store(this->global_epoch.load(std::memory_order_acquire), std::memory_order_seq_cst);
+      return reader(this, slot);
+    }
+
+    /**
+     * @brief 退休一个已经不再可达(新读者读不到)的对象，所有读者经过静止状态后以 deleter(context, object) 释放.
+     */
+    void retire(void *object, deleter_type deleter, void *context) {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      uint64_t epoch = this->global_epoch.fetch_add(1, std::memory_order_acq_rel);
+      this->retired_list.push_back(retired{epoch, object, deleter, context});
+      if (this->retired_list.size() >= _utils_constants::QSBR_RECLAIM_BATCH) this->reclaim_locked();
+    }
+
+    /**
+     * @brief 立即尝试回收.
+     */
+    void reclaim() {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->reclaim_locked();
+    }
+
+    /**
+     * @brief 释放全部待回收对象，不检查读者. 只能在确定没有读者时调用.
+     */
+    void drain() {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      for (retired &r : this->retired_list) r.deleter(r.context, r.object);
+      this->retired_list.clear();
+    }
+
+    /**
+     * @brief 尚未释放的退休对象数量.
+     */
+    size_t pending() {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      return this->retired_list.size();
+    }
+};
+
+} // namespace utils
+
+
+#endif  // HASHMAP_UTILS_QSBR_HPP
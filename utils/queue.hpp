@@ -35,17 +35,17 @@ class static_deque {
           this->self = self;
         }
 
-        void goback() override {
+        void goback() {
           self->circle_backstep(this->ptr);
         }
-        void goback(size_t n) override {
+        void goback(size_t n) {
           for (size_t i = 0; i != n; i++)
             this->goback();
         }
-        void gofront() override {
+        void gofront() {
           self->circle_frontstep(this->ptr);
         }
-        void gofront(size_t n) override {
+        void gofront(size_t n) {
           for (size_t i = 0; i != n; i++)
             this->gofront();
         }
@@ -1,28 +1,56 @@
-
 #ifndef HASHMAP_UTILS_RBTREE_HPP
 #define HASHMAP_UTILS_RBTREE_HPP
 
 #include "__iterator.hpp"
 
+#include "__def.hpp"
+
 #include <functional>
 #include <iostream>
-#include <list>
-#include <deque>
+#include <iterator>
+#include <memory>
+#include <utility>
 
 #include <cstdint>
 #include <cassert>
 
-namespace _rbtree_hpp{
-#include "bintree/tree.hpp"
-}
-
 namespace utils {
 
+/**
+ * @brief 红黑树节点.
+ */
 template <typename T>
-using rb_node = _rbtree_hpp::RB_treenode_t<T>;
+struct rb_node {
+  enum color_t : unsigned char { COLOR_BLACK = 0, COLOR_RED };
 
-template <typename T>
-class rbtree : protected _rbtree_hpp::RB_tree_t<T, rb_node<T> > {
+  rb_node *_left   = nullptr;
+  rb_node *_right  = nullptr;
+  rb_node *_parent = nullptr;
+  color_t color    = COLOR_RED;
+  T value;
+
+  template <typename... Args>
+  explicit rb_node(Args&&... args) : value(std::forward<Args>(args)...) {}
+
+  rb_node*& left() noexcept { return this->_left; }
+  rb_node*& right() noexcept { return this->_right; }
+  rb_node*& parent() noexcept { return this->_parent; }
+};
+
+/**
+ * @brief 红黑树.
+ * @details 比较器和相等比较器是模板参数，比较可以内联; 它们和分配器都是空类时不占空间(见 ebo_storage).
+ *          节点通过 Allocator 重绑定到 rb_node<T> 后分配，可以使用 std::pmr::polymorphic_allocator.
+ * @tparam T 元素类型
+ * @tparam Compare 严格弱序比较函数对象类型，等价(互不小于)的元素可以有多个
+ * @tparam Equal 相等比较函数对象类型，相等的元素在 Compare 下必须等价，等价的元素不一定相等
+ * @tparam Allocator 分配器类型
+ */
+template <typename T, typename Compare = std::less<T>, typename Equal = std::equal_to<T>,
+          typename Allocator = std::allocator<T> >
+class rbtree : private ebo_storage<Compare, 0>,
+               private ebo_storage<Equal, 1>,
+               private ebo_storage<typename std::allocator_traits<Allocator>::template rebind_alloc<rb_node<T> >, 2> {
   public:
     class iterator : public utils::_iterator<T*, iterator> {
       friend class rbtree;
@@ -75,7 +103,7 @@ class rbtree : protected _rbtree_hpp::RB_tree_t<T, rb_node<T> > {
       public:
         using utils::_iterator<T*, iterator>::_iterator;
 
-        bool operator==(const iterator &iter) {
+        bool operator==(const iterator &iter) const {
           if (this->ptr == iter.ptr) {
             if (this->is_end != iter.is_end)
               return false;
@@ -85,18 +113,14 @@ class rbtree : protected _rbtree_hpp::RB_tree_t<T, rb_node<T> > {
           } else return false;
         }
 
-        bool operator!=(const iterator &iter) {
+        bool operator!=(const iterator &iter) const {
           if (this->is_end && iter.is_end) return false;
           if (this->is_begin_front && iter.is_begin_front) return false;
           else return !(*this == iter);
         }
 
 
-        void point_to(T* nptr) override {
-          this->ptr = nptr;
-        }
-
-        void goback() override {
+        void goback() {
           if (this->is_end) return;
 
           if (this->is_begin_front) {
@@ -134,11 +158,11 @@ class rbtree : protected _rbtree_hpp::RB_tree_t<T, rb_node<T> > {
           if (!is_end) this->ptr = &node->value;
         }
 
-        void goback(size_t n) override {
+        void goback(size_t n) {
           for (size_t i = 0; i != n; i++) this->goback();
         }
 
-        void gofront() override {
+        void gofront() {
           if (this->is_begin_front) return;
           if (this->is_end) {
             this->is_end = false;
@@ -175,42 +199,466 @@ class rbtree : protected _rbtree_hpp::RB_tree_t<T, rb_node<T> > {
           this->ptr = &node->value;
         }
 
-        void gofront(size_t n) override {
+        void gofront(size_t n) {
           for (size_t i = 0; i != n; i++) this->gofront();
         }
     };
 
+  public:
+    using comparer_type  = Compare;
+    using equaler_type   = Equal;
+    using allocator_type = Allocator;
+
   protected:
+    using node_type      = rb_node<T>;
+    using node_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<node_type>;
+    using node_traits    = std::allocator_traits<node_allocator>;
+    using comparer_base  = ebo_storage<Compare, 0>;
+    using equaler_base   = ebo_storage<Equal, 1>;
+    using alloc_base     = ebo_storage<node_allocator, 2>;
+
+    node_type *root = nullptr;
     unsigned long long _size = 0;
-    using node_type = rb_node<T>;
-    using base_type = _rbtree_hpp::RB_tree_t<T, rb_node<T>>;
+
+    const Compare &comparer() const noexcept { return comparer_base::get(); }
+    const Equal &equaler() const noexcept { return equaler_base::get(); }
+    node_allocator &node_alloc() noexcept { return alloc_base::get(); }
+    const node_allocator &node_alloc() const noexcept { return alloc_base::get(); }
+
+    static bool is_red(node_type *node) noexcept {
+      return node && node->color == node_type::COLOR_RED;
+    }
+
+    template <typename... Args>
+    node_type *create_node(Args &&...args) {
+      node_type *node = node_traits::allocate(this->node_alloc(), 1);
+      try {
+        node_traits::construct(this->node_alloc(), node, std::forward<Args>(args)...);
+      } catch (...) {
+        node_traits::deallocate(this->node_alloc(), node, 1);
+        throw;
+      }
+      return node;
+    }
+
+    void destroy_node(node_type *node) {
+      node_traits::destroy(this->node_alloc(), node);
+      node_traits::deallocate(this->node_alloc(), node, 1);
+    }
+
+    void destroy_subtree(node_type *node) {
+      while (node) {
+        this->destroy_subtree(node->right());
+        node_type *left = node->left();
+        this->destroy_node(node);
+        node = left;
+      }
+    }
+
+    static unsigned long long subtree_height(const node_type *node) {
+      if (!node) return 0;
+      unsigned long long left = subtree_height(node->_left);
+      unsigned long long right = subtree_height(node->_right);
+      return (left > right ? left : right) + 1;
+    }
+
+    node_type *copy_subtree(node_type *src, node_type *parent) {
+      if (!src) return nullptr;
+      node_type *node = this->create_node(src->value);
+      node->color = src->color;
+      node->parent() = parent;
+      node->left() = this->copy_subtree(src->left(), node);
+      node->right() = this->copy_subtree(src->right(), node);
+      return node;
+    }
+
+    /**
+     * @brief 按中序从 first 依次取 n 个元素构造一棵子树，不做比较和旋转.
+     * @details 左右子树大小至多相差 1，所有空链接的深度为 red_depth 或 red_depth + 1，
+     *          因此深度为 red_depth 的节点染红、其余染黑即满足红黑性质.
+     *          构造元素抛出异常时释放已构造的节点.
+     */
+    template <typename InputIt>
+    node_type *build_subtree(InputIt &first, size_t n, size_t depth, size_t red_depth) {
+      if (!n) return nullptr;
+      size_t left_n = (n - 1) / 2;
+      node_type *left = this->build_subtree(first, left_n, depth + 1, red_depth);
+      node_type *node;
+      try {
+        node = this->create_node(*first);
+      } catch (...) {
+        this->destroy_subtree(left);
+        throw;
+      }
+      ++first;
+      node->left() = left;
+      if (left) left->parent() = node;
+      node->color = depth == red_depth ? node_type::COLOR_RED : node_type::COLOR_BLACK;
+      try {
+        node->right() = this->build_subtree(first, n - 1 - left_n, depth + 1, red_depth);
+      } catch (...) {
+        this->destroy_subtree(node);
+        throw;
+      }
+      if (node->right()) node->right()->parent() = node;
+      return node;
+    }
+
+    static node_type *successor(node_type *node) noexcept {
+      if (node->right()) {
+        node = node->right();
+        while (node->left()) node = node->left();
+        return node;
+      }
+      while (node->parent() && node == node->parent()->right()) node = node->parent();
+      return node->parent();
+    }
+
+    /**
+     * @brief 查找与 val 相等的节点.
+     * @details 先找到第一个不小于 val 的节点，再在与 val 等价的一段中用 Equal 逐个比较.
+     */
+    template <typename U>
+    node_type *search_value(const U &val) const {
+      node_type *cur = this->root;
+      node_type *first = nullptr;
+      while (cur) {
+        if (this->comparer()(cur->value, val)) {
+          cur = cur->right();
+        } else {
+          first = cur;
+          cur = cur->left();
+        }
+      }
+      for (node_type *node = first; node && !this->comparer()(val, node->value); node = successor(node)) {
+        if (this->equaler()(node->value, val)) return node;
+      }
+      return nullptr;
+    }
+
+    void rotate_left(node_type *x) {
+      node_type *y = x->right();
+      x->right() = y->left();
+      if (y->left()) y->left()->parent() = x;
+      y->parent() = x->parent();
+      if (!x->parent()) this->root = y;
+      else if (x == x->parent()->left()) x->parent()->left() = y;
+      else x->parent()->right() = y;
+      y->left() = x;
+      x->parent() = y;
+    }
+
+    void rotate_right(node_type *x) {
+      node_type *y = x->left();
+      x->left() = y->right();
+      if (y->right()) y->right()->parent() = x;
+      y->parent() = x->parent();
+      if (!x->parent()) this->root = y;
+      else if (x == x->parent()->right()) x->parent()->right() = y;
+      else x->parent()->left() = y;
+      y->right() = x;
+      x->parent() = y;
+    }
+
+    // 用以 v 为根的子树替换以 u 为根的子树
+    void transplant(node_type *u, node_type *v) {
+      if (!u->parent()) this->root = v;
+      else if (u == u->parent()->left()) u->parent()->left() = v;
+      else u->parent()->right() = v;
+      if (v) v->parent() = u->parent();
+    }
+
+    void insert_fixup(node_type *node) {
+      while (is_red(node->parent())) {
+        node_type *parent = node->parent();
+        node_type *grand = parent->parent();
+        if (parent == grand->left()) {
+          node_type *uncle = grand->right();
+          if (is_red(uncle)) {
+            parent->color = node_type::COLOR_BLACK;
+            uncle->color = node_type::COLOR_BLACK;
+            grand->color = node_type::COLOR_RED;
+            node = grand;
+          } else {
+            if (node == parent->right()) {
+              node = parent;
+              this->rotate_left(node);
+            }
+            node->parent()->color = node_type::COLOR_BLACK;
+            grand->color = node_type::COLOR_RED;
+            this->rotate_right(grand);
+          }
+        } else {
+          node_type *uncle = grand->left();
+          if (is_red(uncle)) {
+            parent->color = node_type::COLOR_BLACK;
+            uncle->color = node_type::COLOR_BLACK;
+            grand->color = node_type::COLOR_RED;
+            node = grand;
+          } else {
+            if (node == parent->left()) {
+              node = parent;
+              this->rotate_right(node);
+            }
+            node->parent()->color = node_type::COLOR_BLACK;
+            grand->color = node_type::COLOR_RED;
+            this->rotate_left(grand);
+          }
+        }
+      }
+      this->root->color = node_type::COLOR_BLACK;
+    }
+
+    // x 可能为空，因此同时传入其父节点
+    void remove_fixup(node_type *x, node_type *parent) {
+      while (x != this->root && !is_red(x)) {
+        if (x == parent->left()) {
+          node_type *sibling = parent->right();
+          if (is_red(sibling)) {
+            sibling->color = node_type::COLOR_BLACK;
+            parent->color = node_type::COLOR_RED;
+            this->rotate_left(parent);
+            sibling = parent->right();
+          }
+          if (!is_red(sibling->left()) && !is_red(sibling->right())) {
+            sibling->color = node_type::COLOR_RED;
+            x = parent;
+            parent = x->parent();
+          } else {
+            if (!is_red(sibling->right())) {
+              sibling->left()->color = node_type::COLOR_BLACK;
+              sibling->color = node_type::COLOR_RED;
+              this->rotate_right(sibling);
+              sibling = parent->right();
+            }
+            sibling->color = parent->color;
+            parent->color = node_type::COLOR_BLACK;
+            if (sibling->right()) sibling->right()->color = node_type::COLOR_BLACK;
+            this->rotate_left(parent);
+            x = this->root;
+          }
+        } else {
+          node_type *sibling = parent->left();
+          if (is_red(sibling)) {
+            sibling->color = node_type::COLOR_BLACK;
+            parent->color = node_type::COLOR_RED;
+            this->rotate_right(parent);
+            sibling = parent->left();
+          }
+          if (!is_red(sibling->left()) && !is_red(sibling->right())) {
+            sibling->color = node_type::COLOR_RED;
+            x = parent;
+            parent = x->parent();
+          } else {
+            if (!is_red(sibling->left())) {
+              sibling->right()->color = node_type::COLOR_BLACK;
+              sibling->color = node_type::COLOR_RED;
+              this->rotate_left(sibling);
+              sibling = parent->left();
+            }
+            sibling->color = parent->color;
+            parent->color = node_type::COLOR_BLACK;
+            if (sibling->left()) sibling->left()->color = node_type::COLOR_BLACK;
+            this->rotate_right(parent);
+            x = this->root;
+          }
+        }
+      }
+      if (x) x->color = node_type::COLOR_BLACK;
+    }
+
+    template <typename U>
+    T* push_impl(U &&val) {
+      if (node_type *found = this->search_value(val)) {
+        found->value = std::forward<U>(val);
+        return &found->value;
+      }
+
+      node_type *node = this->create_node(std::forward<U>(val));
+      this->link_node(node);
+      return &node->value;
+    }
+
+    /**
+     * @brief 把新节点挂到与它等价的一段之后并重新平衡.
+     */
+    void link_node(node_type *node) {
+      node_type *parent = nullptr;
+      bool as_left = false;
+      for (node_type *cur = this->root; cur; cur = as_left ? cur->left() : cur->right()) {
+        parent = cur;
+        as_left = this->comparer()(node->value, cur->value);
+      }
+      node->parent() = parent;
+      if (!parent) this->root = node;
+      else if (as_left) parent->left() = node;
+      else parent->right() = node;
+      this->insert_fixup(node);
+      this->_size++;
+    }
+
+    void print_subtree(node_type *node, int depth) const {
+      if (!node) return;
+      this->print_subtree(node->right(), depth + 1);
+      for (int i = 0; i < depth; i++) std::cout << "    ";
+      std::cout << (node->color == node_type::COLOR_RED ? "R " : "B ") << node->value << std::endl;
+      this->print_subtree(node->left(), depth + 1);
+    }
 
   public:
-    using _rbtree_hpp::RB_tree_t<T, rb_node<T>>::RB_tree_t;
+    rbtree() = default;
+
+    explicit rbtree(const Allocator &alloc) : alloc_base(node_allocator(alloc)) {}
+
+    explicit rbtree(const Compare &comparer, const Equal &equaler = Equal(), const Allocator &alloc = Allocator())
+      : comparer_base(comparer), equaler_base(equaler), alloc_base(node_allocator(alloc)) {}
 
-    void print_tree() {
-      dynamic_cast<base_type *>(this)->print_tree();
+    rbtree(const rbtree &other)
+      : comparer_base(other.comparer()), equaler_base(other.equaler()),
+        alloc_base(node_traits::select_on_container_copy_construction(other.node_alloc())),
+        _size(other._size) {
+      this->root = this->copy_subtree(other.root, nullptr);
     }
 
-    void push(const T &val) {
-      node_type *node = dynamic_cast<base_type*>(this)->push(val);
-      if (node) this->_size++; 
+    rbtree(rbtree &&other) noexcept
+      : comparer_base(other.comparer()), equaler_base(other.equaler()),
+        alloc_base(std::move(other.node_alloc())), root(other.root), _size(other._size) {
+      other.root = nullptr;
+      other._size = 0;
     }
 
-    void push(T &&val) {
-      node_type *node = dynamic_cast<base_type*>(this)->push(val);
-      if (node) this->_size++; 
+    rbtree &operator=(const rbtree &other) {
+      if (this != &other) {
+        this->clear();
+        if constexpr (node_traits::propagate_on_container_copy_assignment::value)
+          this->node_alloc() = other.node_alloc();
+        comparer_base::get() = other.comparer();
+        equaler_base::get() = other.equaler();
+        this->root = this->copy_subtree(other.root, nullptr);
+        this->_size = other._size;
+      }
+      return *this;
     }
 
-    void remove(const T &val) {
-      if (dynamic_cast<base_type *>(this)->remove(val)) this->_size--;
+    rbtree &operator=(rbtree &&other) {
+      if (this != &other) {
+        this->clear();
+        comparer_base::get() = other.comparer();
+        equaler_base::get() = other.equaler();
+        if constexpr (node_traits::propagate_on_container_move_assignment::value)
+          this->node_alloc() = std::move(other.node_alloc());
+        if (this->node_alloc() == other.node_alloc()) {
+          this->root = other.root;
+          this->_size = other._size;
+          other.root = nullptr;
+          other._size = 0;
+        } else {
+          this->root = this->copy_subtree(other.root, nullptr);
+          this->_size = other._size;
+          other.clear();
+        }
+      }
+      return *this;
+    }
+
+    ~rbtree() { this->clear(); }
+
+    allocator_type get_allocator() const { return allocator_type(this->node_alloc()); }
+
+    void print_tree() const {
+      this->print_subtree(this->root, 0);
+    }
+
+    T* push(const T &val) {
+      return this->push_impl(val);
+    }
+
+    T* push(T &&val) {
+      return this->push_impl(std::move(val));
+    }
+
+    /**
+     * @brief 用 args 在新节点中就地构造元素后插入，已有相等元素时用新元素覆盖.
+     */
+    template <typename... Args>
+    T* emplace(Args &&...args) {
+      node_type *node = this->create_node(std::forward<Args>(args)...);
+      if (node_type *found = this->search_value(node->value)) {
+        found->value = std::move(node->value);
+        this->destroy_node(node);
+        return &found->value;
+      }
+      this->link_node(node);
+      return &node->value;
     }
 
-    void remove(T &&val) {
-      if (dynamic_cast<base_type *>(this)->remove(val)) this->_size--;
+    /**
+     * @brief 用 [first, last) 中的元素替换树的全部内容，O(n).
+     * @details 元素须已按 Compare 非递减排列且互不相等，不做任何比较和旋转，
+     *          直接构造平衡的红黑树. 传入 std::move_iterator 时移动元素.
+     *          构造元素抛出异常时树为空.
+     */
+    template <typename ForwardIt>
+    void assign_sorted(ForwardIt first, ForwardIt last) {
+      this->clear();
+      size_t n = static_cast<size_t>(std::distance(first, last));
+      // 满的层数 floor(log2(n + 1))，其下不满的一层染红
+      size_t red_depth = 0;
+      while ((static_cast<size_t>(2) << red_depth) <= n + 1) red_depth++;
+      this->root = this->build_subtree(first, n, 0, red_depth);
+      if (this->root) this->root->parent() = nullptr;
+      this->_size = n;
     }
 
-    const T* find(const T& target) {
+    /**
+     * @brief 删除与 val 相等的元素.
+     * @details val 可以是任何能与 T 一起传给 Compare 和 Equal 的类型.
+     * @return true 表示找到并删除了元素
+     */
+    template <typename U>
+    bool remove(const U &val) {
+      node_type *z = this->search_value(val);
+      if (!z) return false;
+
+      node_type *y = z;
+      node_type *x = nullptr;
+      node_type *x_parent = nullptr;
+      auto y_color = y->color;
+      if (!z->left()) {
+        x = z->right();
+        x_parent = z->parent();
+        this->transplant(z, z->right());
+      } else if (!z->right()) {
+        x = z->left();
+        x_parent = z->parent();
+        this->transplant(z, z->left());
+      } else {
+        y = z->right();
+        while (y->left()) y = y->left();
+        y_color = y->color;
+        x = y->right();
+        if (y->parent() == z) {
+          x_parent = y;
+        } else {
+          x_parent = y->parent();
+          this->transplant(y, y->right());
+          y->right() = z->right();
+          y->right()->parent() = y;
+        }
+        this->transplant(z, y);
+        y->left() = z->left();
+        y->left()->parent() = y;
+        y->color = z->color;
+      }
+      this->destroy_node(z);
+      this->_size--;
+
+      if (y_color == node_type::COLOR_BLACK) this->remove_fixup(x, x_parent);
+      return true;
+    }
+
+    template <typename U>
+    const T* find(const U& target) const {
       rb_node<T> *node = this->search_value(target);
       if (node) return &node->value;
       else return nullptr;
@@ -220,8 +668,25 @@ class rbtree : protected _rbtree_hpp::RB_tree_t<T, rb_node<T> > {
       return this->_size;
     }
 
+    /**
+     * @brief 树高: 根到最深叶子的节点数，空树为 0. 需要遍历所有节点.
+     */
+    unsigned long long height() const {
+      return subtree_height(this->root);
+    }
+
+    void clear() {
+      this->destroy_subtree(this->root);
+      this->root = nullptr;
+      this->_size = 0;
+    }
+
     iterator begin() const {
       iterator iter;
+      if (!this->root) {
+        iter.is_end = true;
+        return iter;
+      }
       iter.ptr = &this->root->value;
       node_type *node = iter.get_front();
       iter.ptr = &node->value;
@@ -230,10 +695,11 @@ class rbtree : protected _rbtree_hpp::RB_tree_t<T, rb_node<T> > {
 
     iterator end() const {
       iterator iter;
+      iter.is_end = true;
+      if (!this->root) return iter;
       iter.ptr = &this->root->value;
       node_type *node = iter.get_back();
       iter.ptr = &node->value;
-      iter.is_end = true;
       return iter;
     }
 };
@@ -0,0 +1,68 @@
+#ifndef HASHMAP_UTILS_SPINLOCK_HPP
+#define HASHMAP_UTILS_SPINLOCK_HPP
+
+
+#include "__def.hpp"
+
+#include <atomic>
+#include <thread>
+
+
+namespace _utils_constants {
+
+static const unsigned SPINLOCK_SPIN_LIMIT = 64;       // 自旋多少次仍未取得锁后改为让出 CPU
+
+}
+
+namespace utils {
+
+/**
+ * @brief 自旋等待时提示 CPU 降低功耗、让出流水线给同核的其他超线程.
+ */
+inline void cpu_relax() noexcept {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+  __builtin_ia32_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+/**
+ * @brief 自旋锁.
+ * @details 只有一个字节的状态，适合条带化的大量小锁. 先只读地自旋，锁释放后再尝试获取，
+ *          自旋 SPINLOCK_SPIN_LIMIT 次仍未取得时让出 CPU. 满足 Lockable，可配合 std::lock_guard 使用.
+ */
+class spinlock {
+  protected:
+    std::atomic<bool> locked{false};
+
+  public:
+    spinlock() = default;
+    spinlock(const spinlock &) = delete;
+    spinlock &operator=(const spinlock &) = delete;
+
+    void lock() noexcept {
+      for (;;) {
+        if (!this->locked.exchange(true, std::memory_order_acquire)) return;
+        unsigned spins = 0;
+        while (this->locked.load(std::memory_order_relaxed)) {
+          if (++spins < _utils_constants::SPINLOCK_SPIN_LIMIT) cpu_relax();
+          else std::this_thread::yield();
+        }
+      }
+    }
+
+    bool try_lock() noexcept {
+      return !this->locked.load(std::memory_order_relaxed) &&
+             !this->locked.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock() noexcept {
+      this->locked.store(false, std::memory_order_release);
+    }
+};
+
+} // namespace utils
+
+
+#endif  // HASHMAP_UTILS_SPINLOCK_HPP
@@ -0,0 +1,203 @@
+#ifndef HASHMAP_UTILS_THREAD_POOL_HPP
+#define HASHMAP_UTILS_THREAD_POOL_HPP
+
+
+#include "__def.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace utils {
+
+/**
+ * @brief 工作窃取线程池.
+ * @details 每个工作线程有自己的任务双端队列: 自己从尾部取(后进先出，保持局部性)，
+ *          空闲时从其他线程队列的头部窃取(先进先出，窃取到的通常是最大的剩余区间).
+ *          parallel_for 先提交整个区间，执行者不断把区间对半拆分、把后一半压回自己的队列，
+ *          空闲线程窃取这些后一半，因此负载不均的区间也能自动分摊.
+ *
+ *   调用 parallel_for 的线程在等待期间也执行任务，可以在任务中再次调用 parallel_for.
+ */
+class work_stealing_pool {
+  protected:
+    using task_type = std::function<void()>;
+
+    struct alignas(64) worker_queue {
+      std::mutex mutex;
+      std::deque<task_type> tasks;
+    };
+
+    std::vector<std::unique_ptr<worker_queue>> queues;  // 每个工作线程一个，最后一个供外部线程提交
+    std::vector<std::thread> threads;
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    std::atomic<size_t> queued{0};                      // 所有队列中的任务总数
+    bool stopping = false;                              // 受 sleep_mutex 保护
+
+    /**
+     * @brief 当前线程在本线程池中的队列下标，外部线程为最后一个队列
+     */
+    size_t local_queue() const {
+      const work_stealing_pool *pool = current_pool();
+      return pool == this ? current_index() : this->queues.size() - 1;
+    }
+
+    static const work_stealing_pool *&current_pool() {
+      static thread_local const work_stealing_pool *pool = nullptr;
+      return pool;
+    }
+
+    static size_t &current_index() {
+      static thread_local size_t index = 0;
+      return index;
+    }
+
+    void push(task_type task) {
+      worker_queue &queue = *this->queues[this->local_queue()];
+      {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+      }
+      this->queued.fetch_add(1, std::memory_order_release);
+      // 先取得 sleep_mutex 再通知，正在检查条件的工作线程不会错过
+      { std::lock_guard<std::mutex> lock(this->sleep_mutex); }
+      this->wake.notify_one();
+    }
+
+    /**
+     * @brief 取出一个任务: 先从自己队列的尾部取，再依次从其他队列的头部窃取
+     */
+    bool try_pop(size_t self, task_type &task) {
+      if (this->queued.load(std::memory_order_acquire) == 0) return false;
+      size_t n = this->queues.size();
+      for (size_t k = 0; k < n; k++) {
+        worker_queue &queue = *this->queues[(self + k) % n];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+        if (k == 0) {
+          task = std::move(queue.tasks.back());
+          queue.tasks.pop_back();
+        } else {
+          task = std::move(queue.tasks.front());
+          queue.tasks.pop_front();
+        }
+        this->queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+      return false;
+    }
+
+    bool run_one(size_t self) {
+      task_type task;
+      if (!this->try_pop(self, task)) return false;
+      task();
+      return true;
+    }
+
+    void worker_loop(size_t index) {
+      current_pool() = this;
+      current_index() = index;
+      for (;;) {
+        if (this->run_one(index)) continue;
+        std::unique_lock<std::mutex> lock(this->sleep_mutex);
+        this->wake.wait(lock, [this] { return this->stopping || this->queued.load(std::memory_order_acquire) > 0; });
+        if (this->stopping && this->queued.load(std::memory_order_acquire) == 0) return;
+      }
+    }
+
+  public:
+    /**
+     * @param thread_count 工作线程数，默认为硬件线程数减一(调用者也参与执行)
+     */
+    explicit work_stealing_pool(size_t thread_count = default_thread_count()) {
+      this->queues.reserve(thread_count + 1);
+      for (size_t i = 0; i <= thread_count; i++) this->queues.emplace_back(new worker_queue());
+      this->threads.reserve(thread_count);
+      for (size_t i = 0; i < thread_count; i++) this->threads.emplace_back(&work_stealing_pool::worker_loop, this, i);
+    }
+
+    work_stealing_pool(const work_stealing_pool &) = delete;
+    work_stealing_pool &operator=(const work_stealing_pool &) = delete;
+
+    ~work_stealing_pool() {
+      {
+        std::lock_guard<std::mutex> lock(this->sleep_mutex);
+        this->stopping = true;
+      }
+      this->wake.notify_all();
+      for (std::thread &thread : this->threads) thread.join();
+    }
+
+    static size_t default_thread_count() {
+      unsigned hardware = std::thread::hardware_concurrency();
+      return hardware > 1 ? hardware - 1 : 0;
+    }
+
+    /**
+     * @brief 进程内共享的线程池，首次使用时创建
+     */
+    static work_stealing_pool &shared() {
+      static work_stealing_pool pool;
+      return pool;
+    }
+
+    /**
+     * @brief 参与执行的线程数(工作线程加调用者)
+     */
+    size_t concurrency() const { return this->threads.size() + 1; }
+
+    /**
+     * @brief 把 [begin, end) 拆成若干子区间并行调用 f(sub_begin, sub_end)，全部完成后返回.
+     * @details 子区间的边界都是 begin + k * grain(最后一个子区间的终点为 end)，长度不超过 grain 的区间不再拆分.
+     *          f 抛出的第一个异常在所有子区间结束后重新抛出.
+     */
+    template <typename F>
+    void parallel_for(size_t begin, size_t end, size_t grain, F &&f) {
+      if (end <= begin) return;
+      if (grain == 0) grain = 1;
+      if (end - begin <= grain || this->threads.empty()) {
+        for (size_t b = begin; b < end; b += grain) f(b, end - b > grain ? b + grain : end);
+        return;
+      }
+
+      std::atomic<size_t> pending{1};
+      std::exception_ptr error;
+      std::mutex error_mutex;
+      std::function<void(size_t, size_t)> run = [&](size_t b, size_t e) {
+        while (e - b > grain) {
+          size_t chunks = (e - b + grain - 1) / grain;
+          size_t mid = b + chunks / 2 * grain;
+          pending.fetch_add(1, std::memory_order_relaxed);
+          this->push([&run, mid, e] { run(mid, e); });
+          e = mid;
+        }
+        try {
+          f(b, e);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(error_mutex);
+          if (!error) error = std::current_exception();
+        }
+        pending.fetch_sub(1, std::memory_order_acq_rel);
+      };
+
+      run(begin, end);
+      size_t self = this->local_queue();
+      while (pending.load(std::memory_order_acquire) != 0) {
+        if (!this->run_one(self)) std::this_thread::yield();
+      }
+      if (error) std::rethrow_exception(error);
+    }
+};
+
+} // namespace utils
+
+
+#endif  // HASHMAP_UTILS_THREAD_POOL_HPP
@@ -19,16 +19,16 @@ class vector {
       public:
         using utils::_iterator<T*, iterator>::_iterator;
 
-        void goback() override {
+        void goback() {
           this->ptr++;
         }
-        void goback(size_t n) override {
+        void goback(size_t n) {
           this->ptr += n;
         }
-        void gofront() override {
+        void gofront() {
           this->ptr--;
         }
-        void gofront(size_t n) override {
+        void gofront(size_t n) {
           this->ptr -= n;
         }
     };
@@ -3,6 +3,7 @@
 
 #include "__def.hpp"
 #include <cstdint>
+#include <cstring>
 #include <stdexcept>
 
 namespace utils {
@@ -32,6 +33,15 @@ private:
         return (x << r) | (x >> (32 - r));
     }
 
+    /**
+     * @brief 读取4字节，不要求地址对齐（例如字符串视图的任意子串）
+     */
+    static inline uint32_t read32(const uint8_t* p) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
     /**
      * @brief 核心哈希计算函数
      * @param input 输入数据指针
@@ -54,10 +64,10 @@ private:
 
             // 每次处理16字节数据
             while (index + 16 <= length) {
-                v1 = rotl32(v1 + (*reinterpret_cast<const uint32_t*>(data + index)) * PRIME32_2, 13) * PRIME32_1;
-                v2 = rotl32(v2 + (*reinterpret_cast<const uint32_t*>(data + index + 4)) * PRIME32_2, 13) * PRIME32_1;
-                v3 = rotl32(v3 + (*reinterpret_cast<const uint32_t*>(data + index + 8)) * PRIME32_2, 13) * PRIME32_1;
-                v4 = rotl32(v4 + (*reinterpret_cast<const uint32_t*>(data + index + 12)) * PRIME32_2, 13) * PRIME32_1;
+                v1 = rotl32(v1 + read32(data + index) * PRIME32_2, 13) * PRIME32_1;
+                v2 = rotl32(v2 + read32(data + index + 4) * PRIME32_2, 13) * PRIME32_1;
+                v3 = rotl32(v3 + read32(data + index + 8) * PRIME32_2, 13) * PRIME32_1;
+                v4 = rotl32(v4 + read32(data + index + 12) * PRIME32_2, 13) * PRIME32_1;
                 index += 16;
             }
 
@@ -73,7 +83,7 @@ private:
 
         // 处理剩余的4字节块
         while (index + 4 <= length) {
-            h32 += (*reinterpret_cast<const uint32_t*>(data + index)) * PRIME32_3;
+            h32 += read32(data + index) * PRIME32_3;
             h32 = rotl32(h32, 17) * PRIME32_4;
             index += 4;
         }
@@ -116,7 +126,21 @@ public:
             throw std::invalid_argument("min_val must be less than or equal to max_val");
         }
         
-        uint32_t hash = compute_hash(input, length, seed);
+        return map_linear(compute_hash(input, length, seed), min_val, max_val);
+    }
+
+    /**
+     * @brief 将已经计算好的32位哈希值线性映射到[min_val, max_val]范围
+     * 
+     * 与 hash_linear 使用相同的映射，便于只计算一次哈希值后映射到多个不同大小的范围。
+     * 当范围大小都是2的幂时，较小范围中的下标等于较大范围中下标右移两者的位数差。
+     * 
+     * @param hash 原始哈希值
+     * @param min_val 范围最小值
+     * @param max_val 范围最大值
+     * @return 映射到指定范围内的哈希值
+     */
+    static inline uint32_t map_linear(uint32_t hash, uint32_t min_val, uint32_t max_val) {
         uint64_t range = static_cast<uint64_t>(max_val - min_val) + 1;
         
         // 线性缩放公式: (hash * range) / 2^32 + min_val